@@ -1,6 +1,7 @@
 #ifndef ESVM_LIBSVM_H
 #define ESVM_LIBSVM_H
 
+#include "esvmConfig.h"
 #include "esvmTypes.h"
 
 #include "datafile.h"
@@ -12,6 +13,7 @@
 #include "opencv2/highgui/highgui.hpp"
 
 #include <algorithm>
+#include <cmath>
 #include <memory>
 #include <string>
 #include <utility>
@@ -26,56 +28,144 @@ public:
     ~ESVM();
     ESVM();
     ESVM(const ESVM& esvm);
-    ESVM(std::vector<FeatureVector> positives, std::vector<FeatureVector> negatives, std::string id = "");
-    ESVM(std::vector<FeatureVector> samples, std::vector<int> targetOutputs, std::string id = "");
-    ESVM(std::string trainingSamplesFilePath, std::string id = "");
-    ESVM(svmModel* trainedModel, std::string id = "");
+    ESVM(std::vector<FeatureVector> positives, std::vector<FeatureVector> negatives, std::string id = "",
+         const esvmConfig& config = esvmConfig());
+    ESVM(std::vector<FeatureVector> samples, std::vector<int> targetOutputs, std::string id = "", const esvmConfig& config = esvmConfig());
+    ESVM(std::string trainingSamplesFilePath, std::string id = "", const esvmConfig& config = esvmConfig());
+    ESVM(svmModel* trainedModel, std::string id = "", const esvmConfig& config = esvmConfig());
+    ESVM(const double* weights, size_t featureCount, double bias, const int labels[2],
+         const double probability[2] = nullptr, std::string id = "", const esvmConfig& config = esvmConfig());
+    ESVM(const cv::Mat& weights, double bias, const int labels[2], const double probability[2],
+         const std::shared_ptr<const void>& weightsOwner = nullptr, std::string id = "", const esvmConfig& config = esvmConfig());
+    ESVM(const std::vector<svmFeature*>& positiveNodes, const std::vector<svmFeature*>& negativeNodes, std::string id = "",
+         const esvmConfig& config = esvmConfig(), const FeatureVector& initialSolution = FeatureVector());
+    ESVM(const std::vector<svmFeature*>& positiveNodes, const std::vector<svmFeature*>& negativeNodes, svmFeature** poolNodes,
+         size_t poolCount, std::string id = "", const esvmConfig& config = esvmConfig(),
+         const FeatureVector& initialSolution = FeatureVector());
+    ESVM(const cv::Mat& kernelNegatives, svmFeature** kernelRows, size_t kernelColumn,
+         const std::vector<FeatureVector>& positiveSamples, const std::vector<FeatureVector>& negativeSamples,
+         std::string id = "", const esvmConfig& config = esvmConfig());
     ESVM& operator=(ESVM esvm); // copy ctor
     ESVM(ESVM&& esvm);          // move ctor
     void swap(ESVM& esvm1, ESVM& esvm2);
     // instance methods
     bool isModelSet() const;
     bool isModelTrained() const;
+    bool isModelCompiled() const;
+    inline const cv::Mat& getWeights() const { return weights; }
+    inline double getBias() const { return bias; }
+    FeatureVector getSolution() const;
+    inline const esvmConfig& getConfig() const { return config; }
+    void getOutputParameters(int labels[2], double probability[2]) const;
+    double predictOutput(double decision) const;
+    template<int PredictMode>
+    inline double predictOutput(double decision) const;
     void logModelParameters(bool displaySV = false) const;
     bool loadModelFile(std::string modelFilePath, FileFormat format = LIBSVM, std::string id = "");
     bool saveModelFile(std::string modelFilePath, FileFormat format = LIBSVM) const;
-    double predict(FeatureVector probeSample) const;
-    std::vector<double> predict(std::vector<FeatureVector> probeSamples) const;
+    double predict(const FeatureVector& probeSample) const;
+    double predict(const double* probeSample, size_t featureCount) const;
+    double predict(const float* probeSample, size_t featureCount) const;
+    std::vector<double> predict(const std::vector<FeatureVector>& probeSamples) const;
     std::vector<double> predict(std::string probeSamplesFilePath, std::vector<int>* probeGroundTruths = nullptr) const;
+    void predictBatch(const cv::Mat& probeSamples, double* scores) const;
     // static methods
-    static svmModel* makeEmptyModel();
+    static svmModel* makeEmptyModel(const esvmConfig& config = esvmConfig());
     static void destroyModel(svmModel** model);
-    static bool checkModelParameters(svmModel* model);
+    static svmFeature** makePrecomputedKernel(const cv::Mat& kernelNegatives, size_t exemplarColumns);
+    static svmFeature** makeFeatureNodes(const std::vector<FeatureVector>& samples);
+    static svmFeature** makeFeatureNodes(const cv::Mat& samples);
+    static void destroyFeatureNodes(svmFeature*** rows);
+    static bool checkModelParameters(svmModel* model, const esvmConfig& config = esvmConfig());
     static void readSampleDataFile(std::string filePath, std::vector<FeatureVector>& sampleFeatureVectors,
                                    std::vector<int>& targetOutputs, FileFormat format = LIBSVM);
     static void readSampleDataFile(std::string filePath, std::vector<FeatureVector>& sampleFeatureVectors, FileFormat format = LIBSVM);
     static void writeSampleDataFile(std::string filePath, std::vector<FeatureVector>& sampleFeatureVectors,
-                                    std::vector<int>& targetOutputs, FileFormat format = LIBSVM);
+                                    std::vector<int>& targetOutputs, FileFormat format = LIBSVM, bool float32 = ESVM_USE_FLOAT32);
     // properties
     std::string ID;
 
 private:
     // instance methods
     void trainModel(std::vector<FeatureVector> samples, std::vector<int> targetOutputs, std::vector<double> classWeights);
+    void trainModelNodes(std::vector<svmFeature*> sampleNodes, std::vector<int> targetOutputs, std::vector<double> classWeights,
+                         const FeatureVector& initialSolution = FeatureVector());
+    void trainExemplarNodes(const std::vector<svmFeature*>& positiveNodes, const std::vector<svmFeature*>& negativeNodes,
+                            const FeatureVector& initialSolution);
+    void trainModelPrecomputed(const cv::Mat& kernelNegatives, svmFeature** kernelRows, size_t kernelColumn,
+                               const std::vector<FeatureVector>& exemplarSamples, std::vector<int> targetOutputs,
+                               std::vector<double> classWeights);
     void loadModelFile_libsvm(std::string filePath);
     void loadModelFile_binary(std::string filePath);
+    void loadModelFile_binaryWeights(std::string filePath);
+    void loadModelFile_binarySupportVectors(std::string filePath);
     void saveModelFile_binary(std::string filePath) const;
+    static void writeSampleDataFile_binary(std::string filePath, const std::vector<FeatureVector>& sampleFeatureVectors,
+                                           const std::vector<int>& targetOutputs, bool float32);
     void resetModel(svmModel* model = nullptr, bool copy = true);
+    void compileModel();
+    void checkPredictMode_assert() const;
     // static methods
     static void logModelParameters(svmModel* model, std::string id = "", bool displaySV = false);
-    static void checkModelParameters_assert(svmModel* model);
-    static std::vector<double> calcClassWeightsFromMode(int positivesCount, int negativesCount);
+    static void checkModelParameters_assert(svmModel* model, const esvmConfig& config);
+    static std::vector<double> calcClassWeightsFromMode(int positivesCount, int negativesCount, int weightsMode);
+    static svmParam getTrainingParameters(std::vector<double> classWeights, const esvmConfig& config);
     static FeatureVector getFeatureVector(svmFeature* features);
-    static svmFeature* getFeatureNodes(FeatureVector features);
-    static svmFeature* getFeatureNodes(double* features, int featureCount);
+    static svmFeature* getFeatureNodes(const FeatureVector& features);
+    static svmFeature* getFeatureNodes(const double* features, int featureCount);
+    static int setBiasNode(svmFeature* nodes, int featureCount);
+    static svmFeature* copyFeatureNodes(const svmFeature* features);
     static svmModel* deepCopyModel(svmModel* model = nullptr);
+    static svmModel* makeCompiledModel(const double* weights, size_t featureCount, double bias, const int labels[2],
+                                       const double probability[2], const esvmConfig& config);
+    svmModel* makeCompiledModel() const;
+    static bool hasContiguousSV(const svmModel* model);
+    static bool collapseModel(const svmModel* model, FeatureVector& weights, double& bias);
     static void removeTrainedModelUnusedData(svmModel* model, svmProblem* problem);
+    static void removeTrainedModelSharedData(svmModel* model, svmProblem* problem);
     static FreeModelState getFreeSV(svmModel* model);
+    #if ESVM_USE_LIBLINEAR
+    static int getWeightsCount(const svmModel* model);
+    #endif/*ESVM_USE_LIBLINEAR*/
     // object
     svmModel *esvmModel = nullptr;
     /*unique_ptr<svmModel> esvmModel = nullptr;*/
+    // compiled linear decision function (decision = <weights, x> + bias) as a single 'ESVM_CV_SCALAR' row, empty if not compiled
+    // weights can be viewed over external memory kept valid by their owner (compiled-only ESVM without SVM model)
+    cv::Mat weights;
+    std::shared_ptr<const void> weightsOwner;
+    double bias = 0;
+    // output parameters of the decision function (class labels, probability probA/probB or zeros if unavailable)
+    int outputLabels[2] = { 0, 0 };
+    double outputProbability[2] = { 0, 0 };
+    // processing modes (prediction output, training class weights)
+    esvmConfig config;
 };
 
+/*
+    Converts a decision value of the compiled linear model to the output of the specified prediction mode, matching the values
+    that the SVM library would return for the same probe. Specialized for scoring loops, see 'predictOutput' for runtime mode.
+*/
+template<int PredictMode>
+inline double ESVM::predictOutput(double decision) const
+{
+    static_assert(PredictMode >= 0 && PredictMode <= 2, "Unsupported prediction mode");
+    if (PredictMode == 0)           // predict values
+        return decision;
+    else if (PredictMode == 1)      // predict
+        return (decision > 0) ? outputLabels[0] : outputLabels[1];
+
+    // predict probability (sigmoid fitted on decision values, as 'svm_predict_probability')
+    #if ESVM_USE_LIBSVM
+    const double minProbability = 1e-7;
+    double fApB = decision * outputProbability[0] + outputProbability[1];
+    double probability = (fApB >= 0) ? std::exp(-fApB) / (1.0 + std::exp(-fApB)) : 1.0 / (1 + std::exp(fApB));
+    return std::min(std::max(probability, minProbability), 1 - minProbability);
+    #else
+    THROW("Probability prediction mode is only supported by LIBSVM");
+    #endif/*ESVM_USE_LIBSVM*/
+}
+
 //} // namespace esvm
 
 #endif/*ESVM_LIBSVM_H*/
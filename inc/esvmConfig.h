@@ -0,0 +1,54 @@
+#ifndef ESVM_CONFIG_H
+#define ESVM_CONFIG_H
+
+#include "esvmOptions.h"
+
+#include <cstddef>
+
+//namespace esvm {
+
+/*
+    Runtime configuration of the processing modes of ESVM and Ensemble of ESVM
+    Default values are the corresponding compile-time options of 'esvmOptions.h' (see them for the meaning of each mode),
+    so that distinct configurations can be employed by distinct instances within a single process (ie: A/B testing).
+    Configuration is fixed for the lifetime of an instance, performance critical scoring kernels are specialized at compile
+    time for each mode and the specialization matching the configuration is selected once.
+*/
+struct esvmConfig
+{
+    int predictMode = ESVM_PREDICT_MODE;                            // 0: raw values, 1: class, 2: probability
+    int weightsMode = ESVM_WEIGHTS_MODE;                            // class weights (Wp, Wn) employed for training
+    int solverMode = ESVM_SOLVER_MODE;                              // 0: dual, 1: primal (LIBLINEAR only) training solver
+    bool warmStart = ESVM_WARM_START != 0;                          // ensemble ESVM training starts from a shared patch solution
+    size_t miningNegatives = ESVM_HARD_NEGATIVE_MINING;             // initial random negatives of hard negative mining (0: disabled)
+    size_t miningIterations = ESVM_HARD_NEGATIVE_MINING_ITERATIONS; // maximum retraining iterations of hard negative mining
+    size_t miningBatch = ESVM_HARD_NEGATIVE_MINING_BATCH;           // maximum hard negatives added at each mining iteration
+    int roiPreprocessMode = ESVM_ROI_PREPROCESS_MODE;               // ROI pre-processing before feature extraction
+    double roiCropRatio = ESVM_ROI_CROP_RATIO;                      // ratio of ROI pre-cropping when 'roiPreprocessMode == 2'
+    int featureNormMode = ESVM_FEATURE_NORM_MODE;                   // [0-8]: none, min-max/z-score, overall/per feature, across/for each patch
+    bool featureNormClip = ESVM_FEATURE_NORM_CLIP != 0;             // clip normalized features to [0,1]
+    int scoreNormMode = ESVM_SCORE_NORM_MODE;                       // [0-6]: none, min-max/z-score, post/pre/both fusion
+    bool scoreNormClip = ESVM_SCORE_NORM_CLIP != 0;                 // clip normalized scores to [0,1]
+    size_t rsmCount = ESVM_RANDOM_SUBSPACE_METHOD;                  // number of random subspaces (0: RSM disabled)
+    size_t rsmFeatures = ESVM_RANDOM_SUBSPACE_FEATURES;             // number of features of each random subspace
+
+    void validate() const;
+    inline bool usePredictProbability() const { return predictMode == 2; }
+    inline bool useRandomSubspaces() const { return rsmCount > 0; }
+    inline bool useHardNegativeMining() const { return miningNegatives > 0; }
+    // feature normalization employs min-max (odd modes) or z-score (even modes), values are per patch for modes above 4
+    inline bool isFeatureNormMinMax() const { return featureNormMode % 2 == 1; }
+    inline bool isFeatureNormPerPatch() const { return featureNormMode > 4; }
+    inline bool isFeatureNormPerFeature() const { return featureNormMode == 3 || featureNormMode == 4 || featureNormMode > 6; }
+    // score normalization applied before (on patches/subspaces) and/or after fusion, as min-max (odd modes) or z-score (even modes)
+    inline bool isScoreNormMinMax() const { return scoreNormMode % 2 == 1; }
+    inline bool isScoreNormPreFusion() const { return scoreNormMode >= 3; }
+    inline bool isScoreNormPostFusion() const { return scoreNormMode == 1 || scoreNormMode == 2 || scoreNormMode >= 5; }
+    bool isFoldedRSM() const;
+    // features are within [0,1] without normalization (HOG) or with clipped normalization
+    inline bool isFeatureBounded() const { return featureNormMode == 0 || featureNormClip; }
+};
+
+//} // namespace esvm
+
+#endif/*ESVM_CONFIG_H*/
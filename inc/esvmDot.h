@@ -0,0 +1,32 @@
+#ifndef ESVM_DOT_H
+#define ESVM_DOT_H
+
+#include "esvmOptions.h"
+
+#include <string>
+
+//namespace esvm {
+
+/*
+    Dense dot product kernels employed for linear scoring (compiled weights against probe features)
+    The best kernel supported by the running CPU is selected once at runtime, the scalar kernel is always available.
+*/
+enum DotKernel {
+    DOT_SCALAR = 0,
+    DOT_SSE2 = 1,
+    DOT_AVX2 = 2,       // AVX2 + FMA
+    DOT_AVX512 = 3      // AVX-512F
+};
+
+DotKernel getDotKernel();
+bool isDotKernelSupported(DotKernel kernel);
+std::string getDotKernelName(DotKernel kernel);
+
+double dotProduct(const double* a, const double* b, size_t n);
+float dotProduct(const float* a, const float* b, size_t n);
+double dotProduct(const double* a, const double* b, size_t n, DotKernel kernel);
+float dotProduct(const float* a, const float* b, size_t n, DotKernel kernel);
+
+//} // namespace esvm
+
+#endif/*ESVM_DOT_H*/
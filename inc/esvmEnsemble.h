@@ -2,6 +2,7 @@
 #define ESVM_ENSEMBLE_H
 
 #include "esvm.h"
+#include "esvmConfig.h"
 #include "esvmTypes.h"
 #include "mvector.hpp"
 #include "feHOG.h"
@@ -11,6 +12,13 @@
 #include "opencv2/imgproc/imgproc.hpp"
 #include "opencv2/highgui/highgui.hpp"
 
+#include "boost/interprocess/file_mapping.hpp"
+#include "boost/interprocess/mapped_region.hpp"
+
+#include <cfloat>
+#include <memory>
+#include <mutex>
+
 //namespace esvm {
 
 class esvmEnsemble
@@ -18,16 +26,86 @@ class esvmEnsemble
 public:
     esvmEnsemble() {};
     esvmEnsemble(const std::vector<std::vector<cv::Mat> >& positiveROIs, const std::string negativesDir,
-                 const std::vector<std::string>& positiveIDs = {}, const std::vector<std::vector<cv::Mat> >& additionalNegativeROIs = {});
-    std::vector<double> predict(const cv::Mat& roi);
-    bool saveModels(const std::string& saveDirectory);
-    inline size_t getPositiveCount() { return enrolledPositiveIDs.size(); }
-    inline size_t getPatchCount() { return patchCounts.area(); }
-    inline std::string getPositiveID(int positiveIndex);
+                 const std::vector<std::string>& positiveIDs = {}, const std::vector<std::vector<cv::Mat> >& additionalNegativeROIs = {},
+                 const esvmConfig& config = esvmConfig());
+    std::vector<double> predict(const cv::Mat& roi) const;
+    std::vector<double> predictTrack(const std::vector<cv::Mat>& rois, TrackFusion fusion = TRACK_FUSION_MEAN,
+                                     std::vector<std::vector<double> >* frameScores = nullptr) const;
+    std::vector<double> predictCascade(const cv::Mat& roi, double threshold, std::vector<bool>* rejected = nullptr) const;
+    std::vector<std::pair<std::string, double> > predictTopK(const cv::Mat& roi, size_t k, double threshold = -DBL_MAX,
+                                                             bool useCascade = false) const;
+    void enroll(const std::string& positiveID, const std::vector<cv::Mat>& positiveROIs, const std::vector<cv::Mat>& additionalNegativeROIs = {});
+    bool remove(const std::string& positiveID);
+    bool saveModels(const std::string& saveDirectory) const;
+    bool save(const std::string& filePath) const;
+    static esvmEnsemble load(const std::string& filePath);
+    inline size_t getPositiveCount() const { return getModels()->enrolledPositiveIDs.size(); }
+    inline size_t getPatchCount() const { return patchCounts.area(); }
+    inline const esvmConfig& getConfig() const { return config; }
+    std::string getPositiveID(int positiveIndex) const;
+    inline void setNegativesDirectory(const std::string& negativesDir) { negativesDirectory = negativesDir; }
 
 private:
+    friend class esvmPipeline;     // pipeline stages run pre-processing, feature extraction and scoring separately
+    #ifdef ESVM_HAS_TESTS
+    friend int test_ESVM_EnsemblePackedScoring(size_t nPositives, size_t nFrames);    // packed against per-ESVM scoring
+    #endif/*ESVM_HAS_TESTS*/
+
+    /*
+        Models of enrolled positives employed for prediction, never modified once published (snapshot).
+        Predictions hold the snapshot loaded when they start, enrollment changes build an updated copy (ESVM are shared, not
+        copied) and publish it atomically, so that concurrent predictions never block nor observe a partial update.
+    */
+    struct Models {
+        std::vector<std::string> enrolledPositiveIDs;
+        xstd::mvector<2, std::shared_ptr<const ESVM> > EoESVM;     // [patch|random-subspace][positive](ESVM)
+
+        // compiled weights of all ESVM packed contiguously as rows [svm * nPositives + pos], and biases as [svm][pos]
+        // (subspace ESVM scattered in their patch feature space, or folded as rows [patch * nPositives + pos] if 'isFoldedRSM')
+        cv::Mat packedWeights;
+        cv::Mat packedBias;
+        // upper bounds [row][pos] of the score term of each packed row over any probe, for cascaded prediction early rejection
+        // (empty when any term is unbounded, see 'boundPackedModels')
+        cv::Mat packedBound;
+
+        // mapped ensemble archive file when loaded, packed weights and biases are viewed over it
+        std::shared_ptr<boost::interprocess::file_mapping> archiveMapping;
+        std::shared_ptr<boost::interprocess::mapped_region> archiveRegion;
+    };
+    inline std::shared_ptr<const Models> getModels() const { return std::atomic_load(&modelsSnapshot); }
+    void publishModels(const std::shared_ptr<const Models>& models);
+
+    // accumulates ESVM outputs of decisions [svm][frame * nPositives + pos] into fusion sums [frame][pos], specialized by modes
+    typedef void (*ScoreTermsKernel)(const cv::Mat& decisions, const xstd::mvector<2, std::shared_ptr<const ESVM> >& EoESVM,
+                                     const std::vector<double>& refMinMean, const std::vector<double>& refMaxStdDev,
+                                     std::vector<std::vector<double> >& scoreSums);
+    static ScoreTermsKernel selectScoreTermsKernel(const esvmConfig& config);
+
+    void setConfig(const esvmConfig& config);
     void setConstants(std::string negativesDir);
-    std::vector<std::string> enrolledPositiveIDs;
+    inline size_t getSubspaceCount() const { return config.useRandomSubspaces() ? config.rsmCount : 1; }
+    std::vector<FeatureVector> computeFeatures(const cv::Mat& roi) const;
+    std::vector<cv::Mat> preprocessPatches(const cv::Mat& roi) const;
+    std::vector<FeatureVector> computePatchFeatures(const std::vector<cv::Mat>& patches, bool parallel = true) const;
+    const FeatureExtractorHOG& getThreadHOG() const;
+    std::vector<std::vector<double> > predictFrames(const std::vector<cv::Mat>& rois) const;
+    std::vector<double> predictCascade(const Models& models, const cv::Mat& roi, double threshold, std::vector<bool>* rejected) const;
+    std::vector<std::vector<double> > scoreFeatures(const std::vector<std::vector<FeatureVector> >& probeSamples) const;
+    std::vector<std::vector<double> > scoreFeatures(const Models& models, const std::vector<std::vector<FeatureVector> >& probeSamples) const;
+    void trainModels(Models& models, xstd::mvector<3, FeatureVector>& posSamples, xstd::mvector<3, FeatureVector>& negSamples,
+                     size_t positiveOffset) const;
+    FeatureVector getWarmStartSolution(const Models& models, size_t slot, size_t positiveOffset, size_t nPositives) const;
+    std::string getNegativesFileName(size_t patch) const;
+    size_t estimateNegativesMemory(size_t nSamples, size_t nFeatures, bool mappedFloat32) const;
+    std::vector<FeatureVector> getSubspaceSamples(const std::vector<FeatureVector>& samples, size_t rs) const;
+    cv::Mat getSubspaceSamples(const cv::Mat& samples, size_t rs) const;
+    static cv::Mat getSamplesMatrix(const std::vector<FeatureVector>& samples);
+    void packModels(Models& models) const;
+    void boundPackedModels(Models& models) const;
+    cv::Mat getProbeFeatures(const Models& models, const std::vector<std::vector<FeatureVector> >& probeSamples) const;
+    cv::Mat scorePackedModels(const Models& models, const cv::Mat& probeFeatures, int nProbes, int svmPerProbeRow = 1) const;
+    double normalizeScoreSVM(double score, size_t svm) const;
+    double normalizeScoreFusion(double score) const;
 
     // Constants
     cv::Size imageSize;
@@ -37,72 +115,38 @@ private:
     cv::Size blockStride;
     cv::Size cellSize;
     int nBins;
-    FeatureExtractorHOG hog;
 
-    xstd::mvector<2, ESVM> EoESVM;
+    // processing modes, and scoring kernel specialized for them
+    esvmConfig config;
+    ScoreTermsKernel scoreTermsKernel = nullptr;
 
+    // published models snapshot (accessed atomically), updates are serialized by the mutex (shared by ensemble copies)
+    std::shared_ptr<const Models> modelsSnapshot = std::make_shared<const Models>();
+    std::shared_ptr<std::mutex> updateMutex = std::make_shared<std::mutex>();
+
+    std::string negativesDirectory;
     std::string sampleFileExt;
     FileFormat sampleFileFormat;
 
-    /* --- Reference 'hardcoded' feature normalization values --- */
-
-    #if   ESVM_FEATURE_NORM_MODE == 1  // Min-Max features - overall normalization - across patches
-    double hogMin;
-    double hogMax;
-    #elif ESVM_FEATURE_NORM_MODE == 2  // Z-Score features - overall normalization - across patches
-    double hogMean;
-    double hogStdDev;
-    #elif ESVM_FEATURE_NORM_MODE == 3  // Min-Max features - per feature normalization - across patches
-    FeatureVector hogMin;
-    FeatureVector hogMax;
-    #elif ESVM_FEATURE_NORM_MODE == 4  // Z-Score features - per feature normalization - across patches
-    FeatureVector hogMean;
-    FeatureVector hogStdDev;
-    #elif ESVM_FEATURE_NORM_MODE == 5  // Min-Max features - overall normalization - for each patch
-    std::vector<double> hogMin;
-    std::vector<double> hogMax;
-    #elif ESVM_FEATURE_NORM_MODE == 6  // Z-Score features - overall normalization - for each patch
-    std::vector<double> hogMean;
-    std::vector<double> hogStdDev;
-    #elif ESVM_FEATURE_NORM_MODE == 7  // Min-Max features - per feature normalization - for each patch
-    std::vector<FeatureVector> hogMin;
-    std::vector<FeatureVector> hogMax;
-    #elif ESVM_FEATURE_NORM_MODE == 8  // Z-Score features - per feature normalization - for each patch
-    std::vector<FeatureVector> hogMean;
-    std::vector<FeatureVector> hogStdDev;
-    #endif/*ESVM_FEATURE_NORM_MODE*/
+    /* --- Reference 'hardcoded' feature normalization values ---
+        (min, max) for min-max modes or (mean, std-dev) for z-score modes, as [1|patch][1|feature] according to the mode:
+        single value (overall - across patches), per feature values (per feature - across patches), per patch values as a
+        single row (overall - for each patch) or per feature values of each patch (per feature - for each patch)
+    */
+    std::vector<FeatureVector> hogRefMinMean;
+    std::vector<FeatureVector> hogRefMaxStdDev;
 
     /* --- Feature indexes to generate ramdom subspaces --- */
 
-    #if ESVM_RANDOM_SUBSPACE_METHOD > 0
     xstd::mvector<2, int> rsmFeatureIndexes;
-    #endif/*ESVM_RANDOM_SUBSPACE_METHOD*/
-
-    /* --- Reference 'hardcoded' score normalization values --- */
-
-    #if   ESVM_SCORE_NORM_MODE == 1    // Min-Max scores normalization only post-fusion
-    double scoreMinFusion;
-    double scoreMaxFusion;
-    #elif ESVM_SCORE_NORM_MODE == 2    // Z-Score scores normalization only post-fusion
-    double scoreMean;
-    double scoreStdDev;
-    #elif ESVM_SCORE_NORM_MODE == 3    // Min-Max scores normalization only pre-fusion
-    std::vector<double> scoreMinSVM;
-    std::vector<double> scoreMaxSVM;
-    #elif ESVM_SCORE_NORM_MODE == 4    // Z-Score scores normalization only pre-fusion
-    std::vector<double> scoreMeanSVM;
-    std::vector<double> scoreStdDevSVM;
-    #elif ESVM_SCORE_NORM_MODE == 5    // Min-Max scores normalization both pre/post-fusion
-    std::vector<double> scoreMinSVM;
-    std::vector<double> scoreMaxSVM;
-    double scoreMinFusion;
-    double scoreMaxFusion;
-    #elif ESVM_SCORE_NORM_MODE == 6    // Z-Score scores normalization both pre/post-fusion
-    std::vector<double> scoreMeanSVM;
-    std::vector<double> scoreStdDevSVM;
-    double scoreMeanFusion;
-    double scoreStdDevFusion;
-    #endif/*ESVM_SCORE_NORM_MODE*/
+
+    /* --- Reference 'hardcoded' score normalization values ---
+        (min, max) for min-max modes or (mean, std-dev) for z-score modes, of each ESVM pre-fusion and of fused scores post-fusion
+    */
+    std::vector<double> scoreRefMinMeanSVM;
+    std::vector<double> scoreRefMaxStdDevSVM;
+    double scoreRefMinMeanFusion = 0;
+    double scoreRefMaxStdDevFusion = 0;
 };
 
 //} // namespace esvm
@@ -0,0 +1,51 @@
+#ifndef ESVM_MAPPED_SAMPLES_H
+#define ESVM_MAPPED_SAMPLES_H
+
+#include "esvmOptions.h"
+
+#include "opencv2/opencv.hpp"
+
+#include "boost/interprocess/file_mapping.hpp"
+#include "boost/interprocess/mapped_region.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+//namespace esvm {
+
+/*
+    Memory-mapped reader of ESVM BINARY samples files
+    Samples are exposed as a contiguous 'CV_64F' matrix [sample][feature] directly over the mapped file (zero-copy) whenever
+    the feature block is properly aligned, otherwise they are copied once into a single contiguous matrix.
+    Files written with an aligned header ('ESVM_BINARY_HEADER_SAMPLES_ALIGNED[_FLOAT32]') are padded to always be mapped.
+    Files written with float32 features ('*_FLOAT32' headers) are exposed as a 'CV_32F' matrix instead.
+*/
+class esvmMappedSamples
+{
+public:
+    esvmMappedSamples() {};
+    esvmMappedSamples(const std::string& filePath, const std::string& header = ESVM_BINARY_HEADER_SAMPLES);
+    inline size_t getSampleCount() const { return (size_t)samples.rows; }
+    inline size_t getFeatureCount() const { return (size_t)samples.cols; }
+    inline int getSampleType() const { return samples.type(); }
+    inline const cv::Mat& getSamples() const { return samples; }
+    inline const std::vector<int>& getTargetOutputs() const { return targetOutputs; }
+    inline const double* getSample(size_t sample) const { return samples.ptr<double>((int)sample); }    // 'CV_64F' only
+    inline bool isMapped() const { return mappedRegion != nullptr; }
+    static bool hasHeader(const std::string& filePath, const std::string& header);
+    static void readDimensions(const std::string& filePath, const std::string& header, size_t& nSamples, size_t& nFeatures,
+                               size_t& featureSize);
+
+private:
+    static size_t matchHeader(const char* data, size_t size, const std::string& header, bool& isFloat32, bool& isAligned);
+    static size_t getFeaturesOffset(size_t headerSize, size_t nSamples, bool isAligned);
+    std::shared_ptr<boost::interprocess::file_mapping> fileMapping;
+    std::shared_ptr<boost::interprocess::mapped_region> mappedRegion;
+    cv::Mat samples;
+    std::vector<int> targetOutputs;
+};
+
+//} // namespace esvm
+
+#endif/*ESVM_MAPPED_SAMPLES_H*/
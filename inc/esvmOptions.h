@@ -3,6 +3,9 @@
 
 /* ------------------------------------------------------------
    ESVM options
+
+   Prediction, weights, ROI pre-processing, feature/score normalization and random subspace options are the default values of
+   the runtime configuration ('esvmConfig') of ESVM and Ensemble of ESVM instances, which can override them without recompiling
 ------------------------------------------------------------ */
 
 #define ESVM_USE_HOG 1
@@ -10,9 +13,22 @@
 #define ESVM_USE_HIST_EQUAL 1
 #define ESVM_POSITIVE_CLASS +1
 #define ESVM_NEGATIVE_CLASS -1
+#define ESVM_BINARY_HEADER_MODEL "ESVM binary model v2"
 #define ESVM_BINARY_HEADER_MODEL_LIBSVM "ESVM binary model libsvm"
 #define ESVM_BINARY_HEADER_MODEL_LIBLINEAR "ESVM binary model liblinear"
 #define ESVM_BINARY_HEADER_SAMPLES "ESVM binary samples"
+#define ESVM_BINARY_HEADER_SAMPLES_FLOAT32 "ESVM binary float32 samples"
+#define ESVM_BINARY_HEADER_SAMPLES_ALIGNED "ESVM binary aligned samples"
+#define ESVM_BINARY_HEADER_SAMPLES_ALIGNED_FLOAT32 "ESVM binary aligned float32 samples"
+// Byte alignment of the features block in BINARY samples files written with an 'aligned' header (allows zero-copy mapping)
+#define ESVM_SAMPLES_FILE_ALIGNMENT 8
+#define ESVM_BINARY_HEADER_ENSEMBLE "ESVM binary ensemble"
+// Version of the ensemble archive file format and byte alignment of its packed weights
+#define ESVM_ARCHIVE_VERSION 3
+#define ESVM_ARCHIVE_ALIGNMENT 64
+// Version of the BINARY model file format and byte alignment of its weights
+#define ESVM_MODEL_FILE_VERSION 2
+#define ESVM_MODEL_FILE_ALIGNMENT 64
 /*
     ESVM_PREDICT_MODE:
         0: predict using raw values  => function `predictValues`
@@ -21,6 +37,34 @@
 */
 #define ESVM_PREDICT_MODE 1
 #define ESVM_USE_PREDICT_PROBABILITY ESVM_PREDICT_MODE == 2
+/*
+    ESVM_USE_COMPILED_MODEL:
+        0: predict using the SVM library decision function over all support vectors (O(nSV x nFeatures) per probe)
+        1: collapse trained/loaded LINEAR models to a single weight vector and bias (w = sum(coef_i * SV_i), b = -rho)
+           and predict with one dot product (O(nFeatures) per probe)
+*/
+#define ESVM_USE_COMPILED_MODEL 1
+/*
+    ESVM_USE_FLOAT32:
+        0: store compiled weights, packed ensemble weights, probe features for scoring and written BINARY samples files as double
+        1: store them as float32, halving their memory bandwidth and file sizes, and score with single precision dot products
+
+    * Note: feature extraction, normalization and SVM library training remain in double precision ('FeatureVector', 'svm_node'),
+            values are narrowed once when compiled, packed or written to file
+*/
+#define ESVM_USE_FLOAT32 0
+/*
+    ESVM_USE_SIMD_DOT:
+        0: score compiled models with the scalar dot product only
+        1: score compiled models with the best SIMD dot product kernel (SSE2, AVX2+FMA, AVX-512F) detected at runtime (x86 only)
+*/
+#define ESVM_USE_SIMD_DOT 1
+// Minimum number of probes in a batch prediction to split it across OpenMP threads (smaller batches are predicted sequentially)
+#define ESVM_PREDICT_BATCH_PARALLEL_MIN 256
+// Capacity of each bounded queue between asynchronous pipeline stages (rounded up to a power of 2), submissions wait when full
+#define ESVM_PIPELINE_QUEUE_CAPACITY 64
+// Maximum number of probes available in queue that a pipeline scoring worker scores together as a single batch
+#define ESVM_PIPELINE_SCORING_BATCH 16
 /*
     ESVM_DISPLAY_TRAIN_PARAMS:
         0: do not display obtained parameters after training
@@ -49,6 +93,21 @@
         4: (Wp = 1, Wn = Np/Nn)     ratio of sample counts normalized for positives (Np/Nn = [N/Nn]/[N/Np])
 */
 #define ESVM_WEIGHTS_MODE 2
+/*
+    ESVM_SOLVER_MODE:
+        0: dual solver              LIBSVM: C_SVC (hinge loss, kernel cache) | LIBLINEAR: L2R_L2LOSS_SVC_DUAL (coordinate descent)
+        1: primal solver            LIBLINEAR only: L2R_L2LOSS_SVC (trust region Newton), faster for many samples of few features
+*/
+#define ESVM_SOLVER_MODE 0
+// Value of the additional constant feature appended to samples by LIBLINEAR to learn the bias term of the decision function
+#define ESVM_LIBLINEAR_BIAS 1.0
+/*
+    ESVM_WARM_START:
+        0: every ESVM training starts from a zero solution
+        1: ESVM of an ensemble patch/subspace start from the average solution of those already enrolled, or from the solution
+           of the first trained positive when none are (requires LIBLINEAR with 'ESVM_SOLVER_MODE == 1')
+*/
+#define ESVM_WARM_START 0
 /* Specify if random subspace method (RSM) for feature selection must be employed to generate the ensemble of eSVM
         0: RSM is not employed (directly using the basic feature extraction methods)
         #: other numeric int value, the specified value is the amount of RS operations applied
@@ -56,6 +115,33 @@
 #define ESVM_RANDOM_SUBSPACE_METHOD 20
 // Specifies the amount of features to be randomly selected when applying RSM
 #define ESVM_RANDOM_SUBSPACE_FEATURES 128
+// Proportion of packed models (spread over patches) scored for all positives by the first stage of cascaded prediction
+#define ESVM_CASCADE_STAGE_RATIO 0.25
+/*
+    ESVM_USE_PRECOMPUTED_KERNEL:
+        0: train every ESVM of the ensemble directly from feature vectors (negative kernel values recomputed by each ESVM)
+        1: precompute the LINEAR kernel (Gram matrix) of the file negatives of a patch/subspace once and share it across all
+           ESVM trained for that patch/subspace, each exemplar only appends the rows/columns of its own samples (LIBSVM only)
+*/
+#define ESVM_USE_PRECOMPUTED_KERNEL 0
+// Maximum number of columns of a shared precomputed kernel as negatives N + threads x exemplar samples M (memory grows as 16 x N x (N+M) bytes),
+// ESVM of patches above it are trained normally (logged)
+#define ESVM_PRECOMPUTED_KERNEL_MAX_SAMPLES 8192
+// Memory budget (in MB) of pre-generated negative samples loaded simultaneously during ensemble training, estimated from their sample/feature
+// counts as samples matrix, subspace slices and feature nodes (at least one patch is always loaded)
+#define ESVM_TRAINING_NEGATIVES_MEMORY_BUDGET 2048
+/*
+    ESVM_HARD_NEGATIVE_MINING:
+        0: every ESVM of the ensemble is trained once against all negatives of pre-generated files
+        #: every ESVM is first trained against the specified amount of random negatives of pre-generated files, then all
+           these negatives are scored and the violators of the margin (hard negatives scoring above -1) are added before
+           retraining, until none remain or the iterations budget is reached (additional negatives are always employed)
+*/
+#define ESVM_HARD_NEGATIVE_MINING 0
+// Maximum number of retraining iterations of hard negative mining
+#define ESVM_HARD_NEGATIVE_MINING_ITERATIONS 5
+// Maximum number of hard negatives added at each iteration of hard negative mining (highest scored violators first)
+#define ESVM_HARD_NEGATIVE_MINING_BATCH 4096
 /*
     ESVM_FEATURE_NORM_MODE:
         0: no normalization
@@ -155,6 +241,46 @@
 #define TEST_ESVM_MODEL_MEMORY_OPERATIONS 0
 // Test expected functionalities of model with reset/changed parameters (model properly updated)
 #define TEST_ESVM_MODEL_MEMORY_PARAM_CHECK 0
+// Test equivalence of compiled linear model predictions against the SVM library decision function
+#define TEST_ESVM_COMPILED_MODEL_PREDICT 1
+// Test equivalence of batch predictions (matrix or vector of probes, parallelized when large) against single probe predictions
+#define TEST_ESVM_PREDICT_BATCH 1
+// Test equivalence of ESVM trained with a shared precomputed kernel against direct training from feature vectors
+#define TEST_ESVM_PRECOMPUTED_KERNEL_TRAINING 1
+// Test equivalence of ESVM trained over shared negative feature nodes against training from feature vectors
+#define TEST_ESVM_SHARED_FEATURE_NODES_TRAINING 1
+// Test equivalence of memory-mapped BINARY samples against the standard BINARY parser
+#define TEST_ESVM_READ_SAMPLES_FILE_MAPPED 1
+// Test accuracy of float32 samples files and scoring against the double precision path
+#define TEST_ESVM_FLOAT32_PRECISION 1
+// Test equivalence of SIMD dot product kernels supported by the running CPU against the scalar kernel
+#define TEST_ESVM_DOT_PRODUCT_KERNELS 1
+// Test concurrent push/pop of every item exactly once through the bounded lock-free pipeline queue
+#define TEST_ESVM_PIPELINE_QUEUE 1
+// Test ESVM with distinct runtime configurations in a single process and validation of unsupported modes
+#define TEST_ESVM_RUNTIME_CONFIG 1
+// Benchmark training time and scores of available training solvers (dual/primal) for exemplars against shared negatives
+#define TEST_ESVM_SOLVER_BENCHMARK 0
+// Test equivalence of warm started training from a prior exemplar solution against cold started training
+#define TEST_ESVM_WARM_START_TRAINING 1
+// Test ESVM trained with hard negative mining over a negatives pool against training with all negatives at once
+#define TEST_ESVM_HARD_NEGATIVE_MINING 1
+// Test equivalence of ensemble predictions after saving/loading its archive (mapped or converted precision) and rejection of corrupted archives
+#define TEST_ESVM_ENSEMBLE_ARCHIVE 1
+// Test cascaded ensemble predictions (early rejection below threshold) against full ensemble predictions
+#define TEST_ESVM_ENSEMBLE_CASCADE 1
+// Test best candidates retrieval of the ensemble (with or without cascaded prediction) against sorted ensemble predictions
+#define TEST_ESVM_ENSEMBLE_TOP_K 1
+// Test enrollment/removal of positives in the ensemble against predictions of the other positives and alignment of IDs
+#define TEST_ESVM_ENSEMBLE_ENROLLMENT 1
+// Test concurrent ensemble predictions while positives are enrolled/removed (no failure nor partially updated scores)
+#define TEST_ESVM_ENSEMBLE_CONCURRENT_UPDATES 1
+// Test equivalence of ensemble scoring with packed models (GEMV/GEMM, scattered/folded subspaces) against per-ESVM predictions
+#define TEST_ESVM_ENSEMBLE_PACKED_SCORING 1
+// Test track predictions of the ensemble (batched frames, mean/max/accumulated fusion) against predictions of each frame
+#define TEST_ESVM_ENSEMBLE_TRACK_PREDICT 1
+// Test ensemble prediction pipeline end-to-end (scores, submission ordering, error delivery, draining on stop)
+#define TEST_ESVM_ENSEMBLE_PIPELINE 1
 
 /* -------------------------------------------------------------------
     Process options - Enable/Disable a specific procedure execution
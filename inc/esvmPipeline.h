@@ -0,0 +1,76 @@
+#ifndef ESVM_PIPELINE_H
+#define ESVM_PIPELINE_H
+
+#include "esvmEnsemble.h"
+#include "esvmQueue.h"
+#include "esvmOptions.h"
+
+#include "opencv2/opencv.hpp"
+
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+
+//namespace esvm {
+
+/*
+    Asynchronous prediction pipeline of an Ensemble of ESVM for live streams (ie: multiple cameras)
+    Pre-processing (crop, patch split), feature extraction (HOG, normalization) and scoring stages run on separate worker
+    pools connected by bounded lock-free queues so that stages of consecutive ROIs overlap. Scoring workers batch all
+    available probes (up to 'ESVM_PIPELINE_SCORING_BATCH') as a single probe matrix.
+    Submissions wait while the input queue is full (backpressure), or fail immediately with 'trySubmit'.
+    The ensemble must outlive the pipeline, enrollment changes apply to ROIs scored after they are published.
+*/
+class esvmPipeline
+{
+public:
+    // Receives the stream of the submitted ROI and its scores against all positives, or the exception raised by its processing
+    typedef std::function<void(int streamID, const std::vector<double>& scores, std::exception_ptr error)> ResultCallback;
+
+    esvmPipeline(const esvmEnsemble& ensemble, size_t nPreprocessWorkers = 1, size_t nFeatureWorkers = 0, size_t nScoringWorkers = 1,
+                 size_t queueCapacity = ESVM_PIPELINE_QUEUE_CAPACITY);
+    ~esvmPipeline();
+    esvmPipeline(const esvmPipeline&) = delete;
+    esvmPipeline& operator=(const esvmPipeline&) = delete;
+    std::future<std::vector<double> > submit(const cv::Mat& roi, int streamID = 0);
+    void submit(const cv::Mat& roi, int streamID, const ResultCallback& callback);
+    bool trySubmit(const cv::Mat& roi, int streamID, const ResultCallback& callback);
+    void stop();
+    inline size_t getPendingCount() const { return pending.load(); }
+
+private:
+    struct Job {
+        cv::Mat roi;
+        int streamID;
+        std::vector<cv::Mat> patches;
+        std::vector<FeatureVector> features;
+        std::exception_ptr error;
+        ResultCallback callback;
+        std::promise<std::vector<double> > result;
+    };
+    typedef std::unique_ptr<Job> JobPtr;
+
+    bool enqueue(JobPtr& job, bool wait);
+    void push(esvmQueue<JobPtr>& queue, JobPtr& job);
+    void deliver(Job& job, const std::vector<double>& scores);
+    void runPreprocess();
+    void runFeatures();
+    void runScoring();
+
+    const esvmEnsemble& ensemble;
+    esvmQueue<JobPtr> preprocessQueue;
+    esvmQueue<JobPtr> featureQueue;
+    esvmQueue<JobPtr> scoringQueue;
+    std::vector<std::thread> workers;
+    std::atomic<bool> accepting;
+    std::atomic<bool> running;
+    std::atomic<size_t> pending;
+};
+
+//} // namespace esvm
+
+#endif/*ESVM_PIPELINE_H*/
@@ -0,0 +1,119 @@
+#ifndef ESVM_QUEUE_H
+#define ESVM_QUEUE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+//namespace esvm {
+
+/*
+    Bounded lock-free multi-producer/multi-consumer queue (array ring of sequenced cells)
+    Each cell sequence indicates if it is ready to be written or read for the current ring lap, producers and consumers only
+    contend on their respective position with a compare-and-swap. Capacity is rounded up to a power of 2.
+*/
+template<typename T>
+class esvmQueue
+{
+public:
+    explicit esvmQueue(size_t capacity);
+    esvmQueue(const esvmQueue&) = delete;
+    esvmQueue& operator=(const esvmQueue&) = delete;
+    bool tryPush(T& item);
+    bool tryPop(T& item);
+    inline size_t getCapacity() const { return mask + 1; }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+    static const size_t cacheLine = 64;
+
+    std::unique_ptr<Cell[]> cells;
+    size_t mask;
+    char padding0[cacheLine];                   // avoid false sharing of producers and consumers positions
+    std::atomic<size_t> enqueuePosition;
+    char padding1[cacheLine];
+    std::atomic<size_t> dequeuePosition;
+    char padding2[cacheLine];
+};
+
+template<typename T>
+esvmQueue<T>::esvmQueue(size_t capacity)
+{
+    size_t size = 2;
+    while (size < capacity)
+        size <<= 1;
+    cells.reset(new Cell[size]);
+    mask = size - 1;
+    for (size_t i = 0; i < size; ++i)
+        cells[i].sequence.store(i, std::memory_order_relaxed);
+    enqueuePosition.store(0, std::memory_order_relaxed);
+    dequeuePosition.store(0, std::memory_order_relaxed);
+}
+
+// Moves the item into the queue if a cell is available, otherwise returns false and leaves the item untouched
+template<typename T>
+bool esvmQueue<T>::tryPush(T& item)
+{
+    size_t position = enqueuePosition.load(std::memory_order_relaxed);
+    for (;;) {
+        Cell& cell = cells[position & mask];
+        size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t)sequence - (intptr_t)position;
+        if (diff == 0) {
+            if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                cell.data = std::move(item);
+                cell.sequence.store(position + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (diff < 0)
+            return false;   // full
+        else
+            position = enqueuePosition.load(std::memory_order_relaxed);
+    }
+}
+
+// Moves the oldest item out of the queue if any, otherwise returns false
+template<typename T>
+bool esvmQueue<T>::tryPop(T& item)
+{
+    size_t position = dequeuePosition.load(std::memory_order_relaxed);
+    for (;;) {
+        Cell& cell = cells[position & mask];
+        size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t)sequence - (intptr_t)(position + 1);
+        if (diff == 0) {
+            if (dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                item = std::move(cell.data);
+                cell.sequence.store(position + mask + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (diff < 0)
+            return false;   // empty
+        else
+            position = dequeuePosition.load(std::memory_order_relaxed);
+    }
+}
+
+/*
+    Progressive backoff of a thread waiting on a queue: yield first, then sleep for increasing durations
+    Returns the incremented attempt count, reset it to zero after a successful queue operation.
+*/
+inline int esvmQueueBackoff(int attempts)
+{
+    if (attempts < 64)
+        std::this_thread::yield();
+    else
+        std::this_thread::sleep_for(std::chrono::microseconds(attempts < 256 ? 10 : 100));
+    return attempts + 1;
+}
+
+//} // namespace esvm
+
+#endif/*ESVM_QUEUE_H*/
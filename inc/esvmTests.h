@@ -4,6 +4,7 @@
 #ifdef ESVM_HAS_TESTS
 
 #include "esvm.h"
+#include "esvmEnsemble.h"
 #include "esvmTypes.h"
 
 #include "opencv2/opencv.hpp"
@@ -19,6 +20,10 @@ void destroyDummyExemplarSvmModelContent(svm_model *model, FreeModelState free_s
 void generateDummySamples(std::vector<FeatureVector>& samples, std::vector<int>& targetOutputs, size_t nSamples, size_t nFeatures);
 bool generateDummySampleFile_libsvm(std::string filePath, size_t nSamples, size_t nFeatures);
 bool generateDummySampleFile_binary(std::string filePath, size_t nSamples, size_t nFeatures);
+esvmConfig buildDummyEnsembleConfig(size_t rsmCount = 0, int predictMode = 0);
+bool generateDummyEnsembleFiles(std::string directory, const esvmConfig& config, size_t nNegatives);
+std::vector<cv::Mat> generateDummyROIs(size_t nROIs);
+esvmEnsemble buildDummyEnsemble(std::string directory, size_t nPositives, const esvmConfig& config);
 void displayHeader();
 void displayOptions();
 
@@ -42,6 +47,26 @@ int test_ESVM_SaveLoadModelFile_compare();
 int test_ESVM_ModelFromStructSVM();
 int test_ESVM_ModelMemoryOperations();
 int test_ESVM_ModelMemoryParamCheck();
+int test_ESVM_CompiledModelPredict();
+int test_ESVM_PredictBatch(size_t nSamples);
+int test_ESVM_PrecomputedKernelTraining();
+int test_ESVM_SharedFeatureNodesTraining();
+int test_ESVM_ReadSampleFile_mapped(size_t nSamples, size_t nFeatures);
+int test_ESVM_Float32Precision(size_t nSamples, size_t nFeatures);
+int test_ESVM_DotProductKernels();
+int test_ESVM_PipelineQueue(size_t nProducers, size_t nConsumers, size_t nItems);
+int test_ESVM_RuntimeConfig();
+int test_ESVM_SolverBenchmark(size_t nPositives, size_t nNegatives, size_t nFeatures);
+int test_ESVM_WarmStartTraining(size_t nNegatives, size_t nFeatures);
+int test_ESVM_HardNegativeMining(size_t nNegatives, size_t nFeatures);
+int test_ESVM_EnsembleArchive(size_t nPositives, size_t nProbes);
+int test_ESVM_EnsembleCascade(size_t nPositives, size_t nProbes);
+int test_ESVM_EnsembleTopK(size_t nPositives, size_t nProbes);
+int test_ESVM_EnsembleEnrollment(size_t nPositives, size_t nProbes);
+int test_ESVM_EnsembleConcurrentUpdates(size_t nPositives, size_t nThreads, size_t nUpdates);
+int test_ESVM_EnsemblePackedScoring(size_t nPositives, size_t nFrames);
+int test_ESVM_EnsembleTrackPredict(size_t nPositives, size_t nFrames);
+int test_ESVM_EnsemblePipeline(size_t nPositives, size_t nROIs);
 
 /* Procedures */
 int proc_readDataFiles();
@@ -1,6 +1,8 @@
 #ifndef ESVM_TYPES_H
 #define ESVM_TYPES_H
 
+#include "esvmOptions.h"
+
 //namespace esvm {
 
 // SVM implementation library include, types and functions
@@ -28,7 +30,7 @@
     typedef struct problem          svmProblem;
     typedef struct feature_node     svmFeature;
     #define svmTrain                train
-    #define svmPredict              predict
+    #define svmPredict              ::predict       // global scope, not hidden by member functions named 'predict'
     #define svmPredictProbability   predict_probability
     #define svmPredictValues        predict_values
     #define svmCheckParam           check_parameter
@@ -40,13 +42,37 @@
     #error "Invalid SVM implementation library"
 #endif/*Base SVM Library*/
 
+// Number of feature nodes appended to samples for the bias term of the decision function (LIBLINEAR constant bias feature)
+#if ESVM_USE_LIBLINEAR
+    #define ESVM_BIAS_NODES 1
+#else
+    #define ESVM_BIAS_NODES 0
+#endif/*ESVM_USE_LIBLINEAR*/
+
 // Status to free model memory, matches libsvm for '0'/'1'
 enum FreeModelState {
     PARAM = 0,
     MODEL = 1,
-    MULTI = 2   // only for testing purposes, model shouldn't have both in 'live' operation
+    MULTI = 2,      // only for testing purposes, model shouldn't have both in 'live' operation
+    CONTIGUOUS = 3  // as 'MODEL' with all support vector nodes in a single allocation starting at 'SV[0]' (LIBSVM only)
 };
 
+// Fusion method of frame scores into track-level scores for each positive
+enum TrackFusion {
+    TRACK_FUSION_MEAN = 0,
+    TRACK_FUSION_MAX = 1,
+    TRACK_FUSION_ACCUMULATE = 2     // sum of frame scores
+};
+
+// Floating point type of compiled/packed weights and probe features employed for scoring, and its OpenCV matrix type
+#if ESVM_USE_FLOAT32
+    typedef float esvmScalar;
+    #define ESVM_CV_SCALAR CV_32F
+#else
+    typedef double esvmScalar;
+    #define ESVM_CV_SCALAR CV_64F
+#endif/*ESVM_USE_FLOAT32*/
+
 //} // namespace esvm
 
 #endif/*ESVM_TYPES_H*/
@@ -1,12 +1,19 @@
 #include "esvm.h"
 #include "esvmOptions.h"
 #include "esvmUtils.h"
+#include "esvmMappedSamples.h"
+#include "esvmDot.h"
 
 #include "datafile.h"
 #include "testing.h"
 
 #include <sys/stat.h>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <random>
 
+#include "boost/crc.hpp"
 #include "boost/filesystem.hpp"
 namespace bfs = boost::filesystem;
 
@@ -15,8 +22,8 @@ namespace bfs = boost::filesystem;
 /*
     Initializes and trains an ESVM using list of positive and negative feature vectors
 */
-ESVM::ESVM(std::vector<FeatureVector> positives, std::vector<FeatureVector> negatives, std::string id)
-    : ID(id), esvmModel(nullptr)
+ESVM::ESVM(std::vector<FeatureVector> positives, std::vector<FeatureVector> negatives, std::string id, const esvmConfig& config)
+    : ID(id), esvmModel(nullptr), config(config)
 {
     ASSERT_THROW(positives.size() > 0 && negatives.size() > 0, "Exemplar-SVM cannot train without both positive and negative feature vectors");
 
@@ -33,22 +40,22 @@ ESVM::ESVM(std::vector<FeatureVector> positives, std::vector<FeatureVector> nega
 
     // train with penalty weights according to specified mode
     // greater penalty attributed to incorrectly classifying a positive vs the many negatives
-    std::vector<double> weights = calcClassWeightsFromMode(posSamples, negSamples);
+    std::vector<double> weights = calcClassWeightsFromMode(posSamples, negSamples, config.weightsMode);
     trainModel(samples, targets, weights);
 }
 
 /*
     Initializes and trains an ESVM using a combined list of positive and negative feature vectors with corresponding labels
 */
-ESVM::ESVM(std::vector<FeatureVector> samples, std::vector<int> targetOutputs, std::string id)
-    : ID(id), esvmModel(nullptr)
+ESVM::ESVM(std::vector<FeatureVector> samples, std::vector<int> targetOutputs, std::string id, const esvmConfig& config)
+    : ID(id), esvmModel(nullptr), config(config)
 {
     int Np = (int)count(targetOutputs.begin(), targetOutputs.end(), ESVM_POSITIVE_CLASS);
     int Nn = (int)count(targetOutputs.begin(), targetOutputs.end(), ESVM_NEGATIVE_CLASS);
 
     // train with penalty weights according to specified mode
     // greater penalty attributed to incorrectly classifying a positive vs the many negatives
-    std::vector<double> weights = calcClassWeightsFromMode(Np, Nn);
+    std::vector<double> weights = calcClassWeightsFromMode(Np, Nn, config.weightsMode);
     trainModel(samples, targetOutputs, weights);
 }
 
@@ -56,8 +63,8 @@ ESVM::ESVM(std::vector<FeatureVector> samples, std::vector<int> targetOutputs, s
     Initializes and trains an ESVM using a pre-generated file of feature vectors and corresponding labels
     The file must be saved in the LIBSVM sample data format
 */
-ESVM::ESVM(std::string trainingSamplesFilePath, std::string id)
-    : ID(id), esvmModel(nullptr)
+ESVM::ESVM(std::string trainingSamplesFilePath, std::string id, const esvmConfig& config)
+    : ID(id), esvmModel(nullptr), config(config)
 {
     // get samples
     std::vector<FeatureVector> samples;
@@ -68,21 +75,258 @@ ESVM::ESVM(std::string trainingSamplesFilePath, std::string id)
     int Nn = (int)count(targets.begin(), targets.end(), ESVM_NEGATIVE_CLASS);
 
     // train using loaded samples
-    std::vector<double> weights = calcClassWeightsFromMode(Np, Nn);
+    std::vector<double> weights = calcClassWeightsFromMode(Np, Nn, config.weightsMode);
     trainModel(samples, targets, weights);
 }
 
+/*
+    Initializes and trains an ESVM using lists of positive and negative feature nodes
+    Nodes are only referenced by the training problem (not copied nor deallocated), allowing the same negative feature
+    nodes (see 'makeFeatureNodes') to be shared simultaneously by multiple ESVM trained against them.
+    Training starts from the initial solution (weights followed by bias, see 'getSolution') when specified (warm start).
+*/
+ESVM::ESVM(const std::vector<svmFeature*>& positiveNodes, const std::vector<svmFeature*>& negativeNodes, std::string id,
+           const esvmConfig& config, const FeatureVector& initialSolution)
+    : ID(id), esvmModel(nullptr), config(config)
+{
+    trainExemplarNodes(positiveNodes, negativeNodes, initialSolution);
+}
+
+/*
+    Initializes and trains an ESVM with hard negative mining over a pool of 'poolCount' negative feature nodes ('poolNodes',
+    shared like 'negativeNodes'), scored directly from their nodes without any other copy of the pool features.
+    The ESVM is first trained against all 'negativeNodes' and 'config.miningNegatives' random negatives of the pool, then all
+    pool negatives are scored with the LINEAR decision function and unused violators of the margin (scores above -1) are
+    added, highest scores first (up to 'config.miningBatch'), before retraining. Mining stops when no violator remains or
+    after 'config.miningIterations' retraining iterations. Retraining starts from the previous solution with warm start.
+    The whole pool is employed directly when mining is disabled or when it is not larger than the initial negatives count.
+*/
+ESVM::ESVM(const std::vector<svmFeature*>& positiveNodes, const std::vector<svmFeature*>& negativeNodes, svmFeature** poolNodes,
+           size_t poolCount, std::string id, const esvmConfig& config, const FeatureVector& initialSolution)
+    : ID(id), esvmModel(nullptr), config(config)
+{
+    ASSERT_THROW(poolNodes != nullptr || poolCount == 0, "Pool feature nodes must be specified");
+
+    // random initial pool negatives (partial shuffle), sequence is reproducible for a given ESVM ID
+    size_t nPool = poolCount;
+    size_t nInitial = config.useHardNegativeMining() ? std::min(config.miningNegatives, nPool) : nPool;
+    std::vector<size_t> poolOrder(nPool);
+    for (size_t n = 0; n < nPool; ++n)
+        poolOrder[n] = n;
+    std::mt19937 generator((unsigned int)std::hash<std::string>()(id));
+    for (size_t n = 0; n < nInitial && nInitial < nPool; ++n)
+        std::swap(poolOrder[n], poolOrder[std::uniform_int_distribution<size_t>(n, nPool - 1)(generator)]);
+
+    std::vector<bool> isMined(nPool, false);
+    std::vector<svmFeature*> trainNegatives(negativeNodes);
+    trainNegatives.reserve(negativeNodes.size() + nInitial + config.miningIterations * config.miningBatch);
+    for (size_t n = 0; n < nInitial; ++n) {
+        isMined[poolOrder[n]] = true;
+        trainNegatives.push_back(poolNodes[poolOrder[n]]);
+    }
+    trainExemplarNodes(positiveNodes, trainNegatives, initialSolution);
+
+    std::vector<std::pair<double, size_t> > violators;
+    for (size_t it = 0; it < config.miningIterations && nInitial < nPool; ++it)
+    {
+        // score unused pool negatives with the current decision function from their nodes (features without weights are
+        // ignored, such as the LIBLINEAR bias node whose weight is the solution bias)
+        FeatureVector solution = getSolution();
+        double solutionBias = solution.back();
+        size_t nWeights = solution.size() - 1;
+
+        violators.clear();
+        for (size_t n = 0; n < nPool; ++n) {
+            if (isMined[n])
+                continue;
+            double score = solutionBias;
+            for (const svmFeature* node = poolNodes[n]; node->index != -1; ++node)
+                if ((size_t)node->index <= nWeights)
+                    score += solution[node->index - 1] * node->value;
+            if (score > -1)
+                violators.push_back(std::make_pair(score, n));
+        }
+        if (violators.empty())
+            break;
+
+        size_t nAdded = std::min(violators.size(), config.miningBatch);
+        std::partial_sort(violators.begin(), violators.begin() + nAdded, violators.end(), std::greater<std::pair<double, size_t> >());
+        for (size_t v = 0; v < nAdded; ++v) {
+            isMined[violators[v].second] = true;
+            trainNegatives.push_back(poolNodes[violators[v].second]);
+        }
+        trainExemplarNodes(positiveNodes, trainNegatives, config.warmStart ? solution : initialSolution);
+    }
+}
+
+/*
+    Trains the ESVM against positive and negative feature nodes with class weights according to the configured mode
+*/
+void ESVM::trainExemplarNodes(const std::vector<svmFeature*>& positiveNodes, const std::vector<svmFeature*>& negativeNodes,
+                              const FeatureVector& initialSolution)
+{
+    ASSERT_THROW(positiveNodes.size() > 0 && negativeNodes.size() > 0, "Exemplar-SVM cannot train without both positive and negative feature vectors");
+
+    int posSamples = (int)positiveNodes.size();
+    int negSamples = (int)negativeNodes.size();
+
+    std::vector<int> targets(posSamples + negSamples, ESVM_NEGATIVE_CLASS);
+    for (int s = 0; s < posSamples; ++s)
+        targets[s] = ESVM_POSITIVE_CLASS;
+
+    std::vector<svmFeature*> sampleNodes;
+    sampleNodes.reserve(posSamples + negSamples);
+    sampleNodes.insert(sampleNodes.end(), positiveNodes.begin(), positiveNodes.end());
+    sampleNodes.insert(sampleNodes.end(), negativeNodes.begin(), negativeNodes.end());
+
+    std::vector<double> weights = calcClassWeightsFromMode(posSamples, negSamples, config.weightsMode);
+    trainModelNodes(sampleNodes, targets, weights, initialSolution);
+}
+
+/*
+    Initializes and trains an ESVM using the shared precomputed kernel rows of the negatives of a patch/subspace
+    Rows of 'kernelRows' must have been generated by 'makePrecomputedKernel' for 'kernelNegatives', the kernel values of
+    the positive and additional negative samples of this exemplar are written to the exemplar columns starting at
+    'kernelColumn', which must not be employed simultaneously by another ESVM sharing the same kernel rows.
+*/
+ESVM::ESVM(const cv::Mat& kernelNegatives, svmFeature** kernelRows, size_t kernelColumn,
+           const std::vector<FeatureVector>& positiveSamples, const std::vector<FeatureVector>& negativeSamples,
+           std::string id, const esvmConfig& config)
+    : ID(id), esvmModel(nullptr), config(config)
+{
+    ASSERT_THROW(positiveSamples.size() > 0 && kernelNegatives.rows + negativeSamples.size() > 0,
+                 "Exemplar-SVM cannot train without both positive and negative feature vectors");
+
+    int posSamples = (int)positiveSamples.size();
+    int negSamples = kernelNegatives.rows + (int)negativeSamples.size();
+
+    std::vector<FeatureVector> exemplarSamples(positiveSamples);
+    exemplarSamples.insert(exemplarSamples.end(), negativeSamples.begin(), negativeSamples.end());
+    std::vector<int> targets(exemplarSamples.size(), ESVM_NEGATIVE_CLASS);
+    for (int s = 0; s < posSamples; ++s)
+        targets[s] = ESVM_POSITIVE_CLASS;
+
+    std::vector<double> weights = calcClassWeightsFromMode(posSamples, negSamples, config.weightsMode);
+    trainModelPrecomputed(kernelNegatives, kernelRows, kernelColumn, exemplarSamples, targets, weights);
+}
+
 /*
     Initializes and trains an ESVM using a pre-loaded and pre-trained SVM model
     Model can be saved with 'saveModelFile' method in LIBSVM format and retrieved with 'svm_load_model'
 */
-ESVM::ESVM(svmModel* trainedModel, std::string id)
-    : ID(id), esvmModel(nullptr)
+ESVM::ESVM(svmModel* trainedModel, std::string id, const esvmConfig& config)
+    : ID(id), esvmModel(nullptr), config(config)
 {
-    checkModelParameters_assert(trainedModel);
+    checkModelParameters_assert(trainedModel, config);
     resetModel(trainedModel);
 }
 
+/*
+    Initializes an ESVM from a compiled LINEAR decision function ('decision = <weights, x> + bias') and its output parameters
+    The equivalent SVM model is rebuilt with the weights as unique positive support vector (coefficient of 1, 'rho = -bias')
+    and an empty negative support vector (coefficient of 0), such that library predictions and saved files remain identical.
+*/
+ESVM::ESVM(const double* weights, size_t featureCount, double bias, const int labels[2], const double probability[2], std::string id,
+           const esvmConfig& config)
+    : ID(id), esvmModel(nullptr), config(config)
+{
+    resetModel(makeCompiledModel(weights, featureCount, bias, labels, probability, config), false);
+}
+
+/*
+    Initializes a compiled-only ESVM from a row of compiled weights ('ESVM_CV_SCALAR') and the output parameters of its
+    decision function, without any SVM model. Weights are referred to without copy, their memory being kept valid by the
+    matrix or otherwise by 'weightsOwner' (e.g.: mapped ensemble archive). Scoring only requires the compiled decision
+    function, the equivalent SVM model is built on demand for the few operations that need it (see 'makeCompiledModel').
+*/
+ESVM::ESVM(const cv::Mat& weights, double bias, const int labels[2], const double probability[2],
+           const std::shared_ptr<const void>& weightsOwner, std::string id, const esvmConfig& config)
+    : ID(id), esvmModel(nullptr), weights(weights), weightsOwner(weightsOwner), bias(bias), config(config)
+{
+    ASSERT_THROW(weights.rows == 1 && weights.cols > 0 && weights.type() == ESVM_CV_SCALAR,
+                 "Compiled ESVM requires a non-empty row of weights of the scoring precision");
+    ASSERT_THROW(labels != nullptr, "Compiled ESVM requires the output class labels");
+    ASSERT_THROW(probability != nullptr || !config.usePredictProbability(),
+                 "Compiled ESVM requires the probability parameters when using probability prediction");
+    outputLabels[0] = labels[0];
+    outputLabels[1] = labels[1];
+    if (probability != nullptr) {
+        outputProbability[0] = probability[0];
+        outputProbability[1] = probability[1];
+    }
+}
+
+/*
+    Builds the SVM model equivalent to a compiled LINEAR decision function (see the corresponding constructor)
+*/
+svmModel* ESVM::makeCompiledModel(const double* weights, size_t featureCount, double bias, const int labels[2],
+                                  const double probability[2], const esvmConfig& config)
+{
+    ASSERT_THROW(weights != nullptr && featureCount > 0, "Compiled ESVM requires a non-empty weight vector");
+    ASSERT_THROW(labels != nullptr, "Compiled ESVM requires the output class labels");
+
+    svmModel* model = makeEmptyModel(config);
+    model->nr_class = 2;
+    model->label = Malloc(int, 2);
+    model->label[0] = labels[0];
+    model->label[1] = labels[1];
+
+    #if ESVM_USE_LIBSVM
+
+    model->param.svm_type = C_SVC;
+    model->param.kernel_type = LINEAR;
+    model->l = 2;
+    model->nSV = Malloc(int, 2);
+    model->nSV[0] = 1;
+    model->nSV[1] = 1;
+    model->sv_coef = Malloc(double*, 1);
+    model->sv_coef[0] = Malloc(double, 2);
+    model->sv_coef[0][0] = 1;
+    model->sv_coef[0][1] = 0;
+    model->SV = Malloc(svmFeature*, 2);
+    model->SV[0] = getFeatureNodes(weights, (int)featureCount);
+    model->SV[1] = Malloc(svmFeature, 1);
+    model->SV[1][0].index = -1;
+    model->rho = Malloc(double, 1);
+    model->rho[0] = -bias;
+    model->param.probability = 0;
+    if (config.usePredictProbability()) {
+        ASSERT_THROW(probability != nullptr, "Compiled ESVM requires the probability parameters when using probability prediction");
+        model->param.probability = 1;
+        model->probA = Malloc(double, 1);
+        model->probB = Malloc(double, 1);
+        model->probA[0] = probability[0];
+        model->probB[0] = probability[1];
+    }
+    model->free_sv = FreeModelState::MODEL;
+
+    #elif ESVM_USE_LIBLINEAR
+
+    // bias of the decision function as additional feature of value 1
+    model->param.solver_type = L2R_L2LOSS_SVC;
+    model->nr_feature = (int)featureCount;
+    model->bias = 1;
+    model->w = Malloc(double, featureCount + 1);
+    std::copy(weights, weights + featureCount, model->w);
+    model->w[featureCount] = bias;
+
+    #endif/*ESVM_USE_LIBSVM*/
+
+    return model;
+}
+
+/*
+    Builds the SVM model equivalent to the compiled decision function of the ESVM (owned by the caller)
+*/
+svmModel* ESVM::makeCompiledModel() const
+{
+    ASSERT_THROW(isModelCompiled(), "Cannot build the SVM model of a non compiled ESVM");
+    FeatureVector compiledWeights(weights.ptr<esvmScalar>(), weights.ptr<esvmScalar>() + weights.cols);
+    bool hasProbability = outputProbability[0] != 0 || outputProbability[1] != 0;
+    return makeCompiledModel(compiledWeights.data(), compiledWeights.size(), bias, outputLabels,
+                             hasProbability ? outputProbability : nullptr, config);
+}
+
 // Default constructor
 ESVM::ESVM()
     : ID(""), esvmModel(nullptr)
@@ -93,6 +337,12 @@ ESVM::ESVM(const ESVM& esvm)
 {
     ID = esvm.ID;
     esvmModel = deepCopyModel(esvm.esvmModel);
+    weights = esvm.weights;     // compiled weights are never modified once set, they are shared
+    weightsOwner = esvm.weightsOwner;
+    bias = esvm.bias;
+    std::copy(esvm.outputLabels, esvm.outputLabels + 2, outputLabels);
+    std::copy(esvm.outputProbability, esvm.outputProbability + 2, outputProbability);
+    config = esvm.config;
 }
 
 // Move constructor
@@ -113,10 +363,16 @@ void ESVM::swap(ESVM& esvm1, ESVM& esvm2)
 {
     std::swap(esvm1.esvmModel, esvm2.esvmModel);
     std::swap(esvm1.ID, esvm2.ID);
+    std::swap(esvm1.weights, esvm2.weights);
+    std::swap(esvm1.weightsOwner, esvm2.weightsOwner);
+    std::swap(esvm1.bias, esvm2.bias);
+    std::swap(esvm1.outputLabels, esvm2.outputLabels);
+    std::swap(esvm1.outputProbability, esvm2.outputProbability);
+    std::swap(esvm1.config, esvm2.config);
 }
 
 // Builds an 'empty' model ensuring all 'null' references
-svmModel* ESVM::makeEmptyModel()
+svmModel* ESVM::makeEmptyModel(const esvmConfig& config)
 {
     svmModel* model = Malloc(svmModel, 1);
 
@@ -127,7 +383,7 @@ svmModel* ESVM::makeEmptyModel()
 
     model->free_sv = 0;
     model->l = 0;
-    model->param.probability = ESVM_USE_PREDICT_PROBABILITY;
+    model->param.probability = config.usePredictProbability();
     model->nSV = nullptr;
     model->probA = nullptr;
     model->probB = nullptr;
@@ -181,7 +437,7 @@ svmModel* ESVM::deepCopyModel(svmModel* model)
 
     #if ESVM_USE_LIBSVM
 
-    newModel->free_sv = model->free_sv;
+    newModel->free_sv = getFreeSV(model);     // support vectors are copied individually, never contiguous
     newModel->l = model->l;
 
     if (getFreeSV(model) != FreeModelState::PARAM) {
@@ -196,17 +452,13 @@ svmModel* ESVM::deepCopyModel(svmModel* model)
                 newModel->sv_coef[c_1][cn] = model->sv_coef[c_1][cn];
         }
 
-        int nFeatures = 0;                              // contains +1 for (-1,?)
-        while (model->SV[0][nFeatures++].index != -1);  // count 'svm_nodes'
-
+        // support vectors can have distinct node counts (sparse or compiled models), each one is copied up to its own (-1,?)
         newModel->sv_indices = (model->sv_indices) ? Malloc(int, newModel->l) : nullptr;
         newModel->SV = Malloc(svm_node*, newModel->l);
         for (int sv = 0; sv < newModel->l; ++sv) {
             if (model->sv_indices)
                 newModel->sv_indices[sv] = model->sv_indices[sv];
-            newModel->SV[sv] = Malloc(svm_node, nFeatures);
-            for (int f = 0; f < nFeatures; ++f)
-                newModel->SV[sv][f] = model->SV[sv][f];
+            newModel->SV[sv] = copyFeatureNodes(model->SV[sv]);
         }
 
         int nClassPairWise = newModel->nr_class*(newModel->nr_class - 1) / 2;
@@ -214,7 +466,7 @@ svmModel* ESVM::deepCopyModel(svmModel* model)
         for (int cPW = 0; cPW < nClassPairWise; ++cPW)
             newModel->rho[cPW] = model->rho[cPW];
 
-        if (ESVM_USE_PREDICT_PROBABILITY && newModel->param.probability && model->probA && model->probB) {
+        if (newModel->param.probability && model->probA && model->probB) {
             newModel->param.probability = 1;
             newModel->probA = Malloc(double, nClassPairWise);
             newModel->probB = Malloc(double, nClassPairWise);
@@ -236,7 +488,7 @@ svmModel* ESVM::deepCopyModel(svmModel* model)
     newModel->nr_feature = model->nr_feature;
 
     if (getFreeSV(model) != FreeModelState::PARAM) {
-        int nw = (model->nr_feature + model->bias) * model->nr_class;
+        int nw = getWeightsCount(model);
         newModel->w = Malloc(double, nw);
         std::memcpy(newModel->w, model->w, nw * sizeof(double));
     }
@@ -272,13 +524,15 @@ void ESVM::destroyModel(svmModel** model)
                 for (int c = 0; c < pModel->nr_class - 1; ++c)
                     free(pModel->sv_coef[c]);
             FreeNull(pModel->sv_coef);
-            if (pModel->SV)
+            if (pModel->SV && hasContiguousSV(pModel))
+                free(pModel->SV[0]);
+            else if (pModel->SV)
                 for (int sv = 0; sv < pModel->l; ++sv)
                     free(pModel->SV[sv]);
             FreeNull(pModel->SV);
         }
 
-        if (ESVM_USE_PREDICT_PROBABILITY && pModel->param.probability) {
+        if (pModel->param.probability) {
             free(pModel->probA);
             free(pModel->probB);
         }
@@ -299,6 +553,19 @@ void ESVM::destroyModel(svmModel** model)
     }
 }
 
+/*
+    Verifies if all support vector nodes of the model are laid out in a single allocation starting at 'SV[0]', as recorded
+    with 'FreeModelState::CONTIGUOUS' by the loading function that allocated them (see 'loadModelFile_binarySupportVectors').
+*/
+bool ESVM::hasContiguousSV(const svmModel* model)
+{
+    #if ESVM_USE_LIBSVM
+    return model->free_sv == FreeModelState::CONTIGUOUS;
+    #else
+    return false;
+    #endif/*ESVM_USE_LIBSVM*/
+}
+
 // Deallocation of unused support vectors and training parameters, updates parameters accordingly for new model state
 //      free only sample vectors not used as support vectors and update model state
 //      cannot directly free inner 'svm_node' 2d-array 'problem->x[]' as they are shared with 'model->SV'
@@ -337,27 +604,183 @@ void ESVM::removeTrainedModelUnusedData(svmModel* model, svmProblem* problem)
     // update mode
     model->free_sv = FreeModelState::MODEL;
 
+    #elif ESVM_USE_LIBLINEAR
+
+    ASSERT_THROW(model != nullptr, "Missing model reference to remove sample vectors and training parameters");
+    ASSERT_THROW(model->w != nullptr, "Missing model weights, sample vectors are required until training is completed");
+    ASSERT_THROW(problem != nullptr, "Missing problem reference to remove sample vectors");
+    ASSERT_THROW(problem->x != nullptr, "Missing problem contained sample references to remove sample vectors");
+
+    // weights are independent of the samples, all sample vectors are removed
+    for (int s = 0; s < problem->l; ++s)
+        free(problem->x[s]);
+
+    // remove training parameters (shallow copy of the parameters employed for training)
+    FreeNull(model->param.weight);
+    FreeNull(model->param.weight_label);
+
+    // destroy problem contained data
+    FreeNull(problem->x);
+    FreeNull(problem->y);
+
+    #endif/*ESVM_USE_LIBSVM*/
+}
+
+// Deallocation of training parameters and problem of a model trained over shared sample nodes, updates model state
+//      problem contained 'svm_node' 2d-array 'problem->x[]' are shared (not deallocated), 'model->SV' must not reference them
+void ESVM::removeTrainedModelSharedData(svmModel* model, svmProblem* problem)
+{
+    ASSERT_THROW(model != nullptr, "Missing model reference to remove training parameters");
+    ASSERT_THROW(problem != nullptr, "Missing problem reference to remove shared sample references");
+
+    FreeNull(model->param.weight);
+    FreeNull(model->param.weight_label);
+    FreeNull(problem->x);
+    FreeNull(problem->y);
+
+    #if ESVM_USE_LIBSVM
+    model->free_sv = FreeModelState::MODEL;
     #endif/*ESVM_USE_LIBSVM*/
 }
 
 // Deallocation of model subparts
 void ESVM::resetModel(svmModel* model, bool copy)
 {
-    if (isModelSet())
+    if (esvmModel != nullptr)
         destroyModel(&esvmModel);
     esvmModel = copy ? deepCopyModel(model) : model;    // set requested model or 'null'
+    compileModel();
+}
+
+/*
+    Collapses the trained LINEAR model into a single weight vector and bias such that the decision function becomes
+    'decision = <w, x> + b', with 'w = sum(coef_i * SV_i)' and 'b = -rho' (LIBSVM) or directly 'w' (LIBLINEAR).
+    Prediction then requires a single dot product instead of one per support vector.
+*/
+void ESVM::compileModel()
+{
+    weights.release();
+    weightsOwner.reset();
+    bias = 0;
+    std::fill(outputLabels, outputLabels + 2, 0);
+    std::fill(outputProbability, outputProbability + 2, 0.0);
+    if (!isModelTrained())
+        return;
+
+    // output parameters converting decision values are kept for scoring without accessing the model
+    outputLabels[0] = esvmModel->label[0];
+    outputLabels[1] = esvmModel->label[1];
+    #if ESVM_USE_LIBSVM
+    if (esvmModel->probA && esvmModel->probB) {
+        outputProbability[0] = esvmModel->probA[0];
+        outputProbability[1] = esvmModel->probB[0];
+    }
+    #endif/*ESVM_USE_LIBSVM*/
+
+    #if ESVM_USE_COMPILED_MODEL
+    // weights are accumulated in double precision and narrowed once to the scoring precision
+    FeatureVector compiledWeights;
+    if (collapseModel(esvmModel, compiledWeights, bias) && !compiledWeights.empty())
+        cv::Mat(1, (int)compiledWeights.size(), CV_64F, compiledWeights.data()).convertTo(weights, ESVM_CV_SCALAR);
+    #endif/*ESVM_USE_COMPILED_MODEL*/
+}
+
+/*
+    Obtains the dense weight vector and bias of the LINEAR decision function of a trained model (see 'compileModel').
+    Returns false if the model cannot be collapsed (non-LINEAR kernel or not a two-class model).
+*/
+bool ESVM::collapseModel(const svmModel* model, FeatureVector& weights, double& bias)
+{
+    weights.clear();
+    bias = 0;
+
+    #if ESVM_USE_LIBSVM
+
+    if (model->param.kernel_type != LINEAR || model->nr_class != 2)
+        return false;
+
+    // feature count from highest index since 'svm_node' arrays are sparse (indexes are one-based)
+    int nFeatures = 0;
+    for (int sv = 0; sv < model->l; ++sv)
+        for (svmFeature* node = model->SV[sv]; node->index != -1; ++node)
+            nFeatures = std::max(nFeatures, node->index);
+
+    // indexes lower than one never match a probe feature in the library's dot product, they are ignored for equivalence
+    weights = FeatureVector(nFeatures, 0.0);
+    for (int sv = 0; sv < model->l; ++sv) {
+        double coef = model->sv_coef[0][sv];
+        for (svmFeature* node = model->SV[sv]; node->index != -1; ++node)
+            if (node->index > 0)
+                weights[node->index - 1] += coef * node->value;
+    }
+    bias = -model->rho[0];
+
+    #elif ESVM_USE_LIBLINEAR
+
+    if (model->nr_class != 2)
+        return false;
+
+    // bias term is an additional feature of value 'model->bias' when enabled (>= 0)
+    weights.assign(model->w, model->w + model->nr_feature);
+    bias = (model->bias >= 0) ? model->w[model->nr_feature] * model->bias : 0;
+
+    #endif/*ESVM_USE_LIBSVM | ESVM_USE_LIBLINEAR*/
+    return true;
+}
+
+/*
+    Obtains the solution of the trained LINEAR decision function as its weights followed by its bias ('nFeatures + 1' values)
+    Solutions of ESVM trained over the same features can be employed to warm start the training of another ESVM.
+*/
+FeatureVector ESVM::getSolution() const
+{
+    ASSERT_THROW(isModelTrained(), "Cannot obtain the solution of untrained ESVM model");
+    FeatureVector solution;
+    double solutionBias = bias;
+    if (esvmModel == nullptr)   // compiled-only
+        solution.assign(weights.ptr<esvmScalar>(), weights.ptr<esvmScalar>() + weights.cols);
+    else
+        ASSERT_THROW(collapseModel(esvmModel, solution, solutionBias), "Only LINEAR two-class models have a solution of weights and bias");
+    solution.push_back(solutionBias);
+    return solution;
+}
+
+bool ESVM::isModelCompiled() const
+{
+    return !weights.empty();
+}
+
+/*
+    Obtains the output parameters of the model employed to convert decision values according to the prediction mode
+    Probability parameters (probA, probB) are set to zero when not available.
+*/
+void ESVM::getOutputParameters(int labels[2], double probability[2]) const
+{
+    ASSERT_THROW(isModelTrained(), "Cannot obtain output parameters of untrained ESVM model");
+    std::copy(outputLabels, outputLabels + 2, labels);
+    std::copy(outputProbability, outputProbability + 2, probability);
 }
 
 // Free SV status according to employed SVM implementation library
 FreeModelState ESVM::getFreeSV(svmModel* model)
 {
     #if ESVM_USE_LIBSVM
-    return (model->free_sv == 0 ? FreeModelState::PARAM : model->free_sv == 1 ? FreeModelState::MODEL : FreeModelState::MULTI);
+    // contiguous support vectors only differ by their deallocation (see 'hasContiguousSV'), the model is owned as usual
+    return (model->free_sv == 0 ? FreeModelState::PARAM
+          : model->free_sv == 1 || model->free_sv == FreeModelState::CONTIGUOUS ? FreeModelState::MODEL : FreeModelState::MULTI);
     #elif ESVM_USE_LIBLINEAR
-    return (model->w != nullptr ? FreeModelState::PARAM : FreeModelState::MODEL);
+    return (model->w != nullptr ? FreeModelState::MODEL : FreeModelState::PARAM);   // no 'free_sv', trained weights are owned
     #endif
 }
 
+#if ESVM_USE_LIBLINEAR
+// Number of LIBLINEAR weights, including the bias feature weight when enabled, two-class models have a single weight vector
+int ESVM::getWeightsCount(const svmModel* model)
+{
+    return (model->nr_feature + (model->bias >= 0 ? 1 : 0)) * (model->nr_class == 2 ? 1 : model->nr_class);
+}
+#endif/*ESVM_USE_LIBLINEAR*/
+
 // Destructor
 ESVM::~ESVM()
 {
@@ -367,7 +790,13 @@ ESVM::~ESVM()
 
 void ESVM::logModelParameters(bool displaySV) const
 {
-    logModelParameters(esvmModel, ID, displaySV);
+    if (esvmModel != nullptr || !isModelCompiled()) {
+        logModelParameters(esvmModel, ID, displaySV);
+        return;
+    }
+    svmModel* model = makeCompiledModel();  // compiled-only
+    logModelParameters(model, ID, displaySV);
+    destroyModel(&model);
 }
 
 void ESVM::logModelParameters(svmModel *model, std::string id, bool displaySV)
@@ -389,16 +818,14 @@ void ESVM::logModelParameters(svmModel *model, std::string id, bool displaySV)
            << "   nr class:    " << model->nr_class << std::endl
            << "   pos label:   " << model->label[0] << std::endl
            << "   neg label:   " << model->label[1] << std::endl
-           << "   W mode:      " << ESVM_WEIGHTS_MODE << std::endl;
-    #if ESVM_WEIGHTS_MODE
-    if (getFreeSV(model) != FreeModelState::MODEL) {  // when using a pre-trained model, 'rho' is used instead of weights (they are not set)    
+           << "   W mode:      " << (model->param.nr_weight > 0 ? "class weights" : "unused") << std::endl;
+    if (model->param.nr_weight > 0 && getFreeSV(model) != FreeModelState::MODEL) {  // when using a pre-trained model, 'rho' is used instead of weights (they are not set)
     logger << "   nr W:        " << model->param.nr_weight << std::endl
            << "   W pos:       " << model->param.weight[0] << std::endl
            << "   W neg:       " << model->param.weight[1] << std::endl
            << "   W pos label: " << model->param.weight_label[0] << std::endl
            << "   W neg label: " << model->param.weight_label[1] << std::endl;    
     } // end if
-    #endif/*ESVM_WEIGHTS_MODE*/
 
     #if ESVM_USE_LIBSVM
 
@@ -406,8 +833,8 @@ void ESVM::logModelParameters(svmModel *model, std::string id, bool displaySV)
     if (model->sv_coef)
         svCoefVector = std::vector<double>(model->sv_coef[0], model->sv_coef[0] + model->l);
     logger << "   free sv:     " << model->free_sv << std::endl
-           << "   shrinking:   " << (model->free_sv == FreeModelState::MODEL ? "n/a" : std::to_string(model->param.shrinking)) << std::endl
-           << "   probability: " << (model->free_sv == FreeModelState::MODEL ? "n/a" : std::to_string(model->param.probability)) << std::endl;
+           << "   shrinking:   " << (getFreeSV(model) == FreeModelState::MODEL ? "n/a" : std::to_string(model->param.shrinking)) << std::endl
+           << "   probability: " << (getFreeSV(model) == FreeModelState::MODEL ? "n/a" : std::to_string(model->param.probability)) << std::endl;
     if (model->param.probability) {
     logger << "   probA:       " << (model->probA == nullptr ? "'null'" : std::to_string(model->probA[0])) << std::endl
            << "   probB:       " << (model->probB == nullptr ? "'null'" : std::to_string(model->probB[0])) << std::endl;
@@ -432,7 +859,7 @@ void ESVM::logModelParameters(svmModel *model, std::string id, bool displaySV)
            << "   nr features: " << model->nr_feature << std::endl
            << "   W:           " << (displaySV ? model->w != nullptr ? "" : "'null'" : "'displaySV=false'") << std::endl;
     if (displaySV && model->w != nullptr) {
-        int nw = (model->nr_feature + model->bias) * model->nr_class;
+        int nw = getWeightsCount(model);
         FeatureVector fv(nw);
         fv.assign(model->w, model->w + nw);
         logger << "      " << featuresToVectorString(fv) << std::endl;
@@ -444,9 +871,9 @@ void ESVM::logModelParameters(svmModel *model, std::string id, bool displaySV)
 /*
     Verifies that the specified 'svmModel' parameters are adequately set to be employed by the ESVM class
 */
-bool ESVM::checkModelParameters(svmModel* model)
+bool ESVM::checkModelParameters(svmModel* model, const esvmConfig& config)
 {
-    try { checkModelParameters_assert(model); }
+    try { checkModelParameters_assert(model, config); }
     catch (...) { return false; }
     return true;
 }
@@ -455,7 +882,7 @@ bool ESVM::checkModelParameters(svmModel* model)
     Verifies that the specified 'svmModel' parameters are adequately set to be employed by the ESVM class
     This is the version employed internally by the class, other method (no '_assert') is publicly available for quick validation test
 */
-void ESVM::checkModelParameters_assert(svmModel* model)
+void ESVM::checkModelParameters_assert(svmModel* model, const esvmConfig& config)
 {
     ASSERT_THROW(model != nullptr, "No SVM model reference specified");
     ASSERT_THROW(model->nr_class == 2, "ESVM model must have two classes (positives, negatives)");
@@ -470,15 +897,16 @@ void ESVM::checkModelParameters_assert(svmModel* model)
     ASSERT_THROW(model->param.kernel_type == LINEAR, "ESVM model must have a LINEAR kernel");
     ASSERT_THROW(model->l > 1, "ESVN model number of samples must be greater than one (at least 1 positive and 1 negative)");
 
-    #if ESVM_USE_PREDICT_PROBABILITY
-    ASSERT_THROW(model->param.probability == 1, "Probability option disabled when it should be set to '1'");
-    ASSERT_THROW(model->probA != nullptr, "Reference of probability estimate parameter 'probA' not specified for ESVM using probability prediction");
-    ASSERT_THROW(model->probB != nullptr, "Reference of probability estimate parameter 'probB' not specified for ESVM using probability prediction");
-    #else
-    ASSERT_THROW(model->param.probability == 0, "Probability option enabled when it should be set to '0'");
-    ASSERT_THROW(model->probA == nullptr, "Reference of probability estimate parameter 'probA' not null for ESVM not using probability prediction");
-    ASSERT_THROW(model->probB == nullptr, "Reference of probability estimate parameter 'probB' not null for ESVM not using probability prediction");
-    #endif/*ESVM_USE_PREDICT_PROBABILITY*/
+    if (config.usePredictProbability()) {
+        ASSERT_THROW(model->param.probability == 1, "Probability option disabled when it should be set to '1'");
+        ASSERT_THROW(model->probA != nullptr, "Reference of probability estimate parameter 'probA' not specified for ESVM using probability prediction");
+        ASSERT_THROW(model->probB != nullptr, "Reference of probability estimate parameter 'probB' not specified for ESVM using probability prediction");
+    }
+    else {
+        ASSERT_THROW(model->param.probability == 0, "Probability option enabled when it should be set to '0'");
+        ASSERT_THROW(model->probA == nullptr, "Reference of probability estimate parameter 'probA' not null for ESVM not using probability prediction");
+        ASSERT_THROW(model->probB == nullptr, "Reference of probability estimate parameter 'probB' not null for ESVM not using probability prediction");
+    }
 
     #endif/*ESVM_USE_LIBSVM*/
 
@@ -517,8 +945,8 @@ void ESVM::checkModelParameters_assert(svmModel* model)
 
         #elif ESVM_USE_LIBLINEAR
 
-        ASSERT_THROW(model->param.solver_type == L2R_L2LOSS_SVC, "ESVM model must have a L2R_L2LOSS_SVC solver");
-        ASSERT_THROW(model->bias == 0, "ESVM model bias must be equal to 0");
+        ASSERT_THROW(model->param.solver_type == L2R_L2LOSS_SVC || model->param.solver_type == L2R_L2LOSS_SVC_DUAL,
+                     "ESVM model must have a L2R_L2LOSS_SVC or L2R_L2LOSS_SVC_DUAL solver");
         ASSERT_THROW(model->nr_feature > 0, "ESVM model must have a positive feature count");
         ASSERT_THROW(model->w != nullptr, "ESVM model weights must be specified");
 
@@ -532,7 +960,19 @@ void ESVM::checkModelParameters_assert(svmModel* model)
 void ESVM::readSampleDataFile(std::string filePath, std::vector<FeatureVector>& sampleFeatureVectors,
                               std::vector<int>& targetOutputs, FileFormat format)
 {
-    DataFile::readSampleDataFile(filePath, sampleFeatureVectors, targetOutputs, format, format == LIBSVM ? "" : ESVM_BINARY_HEADER_SAMPLES);
+    if (format == BINARY && !esvmMappedSamples::hasHeader(filePath, ESVM_BINARY_HEADER_SAMPLES))
+    {
+        // aligned and float32 layouts are not handled by the generic parser, features are read (widened) from the mapped file
+        esvmMappedSamples mappedSamples(filePath);
+        cv::Mat samples;
+        mappedSamples.getSamples().convertTo(samples, CV_64F);
+        sampleFeatureVectors = std::vector<FeatureVector>(samples.rows);
+        for (int s = 0; s < samples.rows; ++s)
+            sampleFeatureVectors[s].assign(samples.ptr<double>(s), samples.ptr<double>(s) + samples.cols);
+        targetOutputs = mappedSamples.getTargetOutputs();
+    }
+    else
+        DataFile::readSampleDataFile(filePath, sampleFeatureVectors, targetOutputs, format, format == LIBSVM ? "" : ESVM_BINARY_HEADER_SAMPLES);
     for (size_t t = 0; t < targetOutputs.size(); ++t)
         ASSERT_THROW(targetOutputs[t] == ESVM_POSITIVE_CLASS || targetOutputs[t] == ESVM_NEGATIVE_CLASS,
                      "Invalid class label specified in file for ESVM");
@@ -549,14 +989,66 @@ void ESVM::readSampleDataFile(std::string filePath, std::vector<FeatureVector>&
 
 /*
     Writes feature vectors and corresponding target output class to a data sample file
+    BINARY files are written with an aligned features block, as float32 if 'float32' is specified (defaults to 'ESVM_USE_FLOAT32').
 */
 void ESVM::writeSampleDataFile(std::string filePath, std::vector<FeatureVector>& sampleFeatureVectors,
-                               std::vector<int>& targetOutputs, FileFormat format)
+                               std::vector<int>& targetOutputs, FileFormat format, bool float32)
 {
     for (size_t t = 0; t < targetOutputs.size(); ++t)
         ASSERT_THROW(targetOutputs[t] == ESVM_POSITIVE_CLASS || targetOutputs[t] == ESVM_NEGATIVE_CLASS,
                      "Target output value must correspond to either positive or negative class");
-    DataFile::writeSampleDataFile(filePath, sampleFeatureVectors, targetOutputs, format, format == LIBSVM ? "" : ESVM_BINARY_HEADER_SAMPLES);
+    if (format == BINARY)
+        writeSampleDataFile_binary(filePath, sampleFeatureVectors, targetOutputs, float32);
+    else
+        DataFile::writeSampleDataFile(filePath, sampleFeatureVectors, targetOutputs, format, "");
+}
+
+/*
+    Writes feature vectors and corresponding target output class to a BINARY data sample file with an aligned features block
+    Padding places the features at an offset multiple of 'ESVM_SAMPLES_FILE_ALIGNMENT' so that they can be mapped without copy.
+
+    Expected data format and order:    <all reinterpreted as char*>
+
+        TYPE          QUANTITY                VALUE
+        ========================================
+        (char)      | len(header)           | 'ESVM_BINARY_HEADER_SAMPLES_ALIGNED[_FLOAT32]'
+        (int)       | 1                     | nSamples
+        (int)       | 1                     | nFeatures
+        (int)       | nSamples              | target outputs
+        (char)      | padding               | zeros up to the next 'ESVM_SAMPLES_FILE_ALIGNMENT' offset
+        (double)    | nSamples * nFeatures  | sample features (float if 'float32' is specified)
+*/
+void ESVM::writeSampleDataFile_binary(std::string filePath, const std::vector<FeatureVector>& sampleFeatureVectors,
+                                      const std::vector<int>& targetOutputs, bool float32)
+{
+    int nSamples = (int)sampleFeatureVectors.size();
+    ASSERT_THROW(nSamples > 0, "Number of samples must be greater than zero");
+    ASSERT_THROW(targetOutputs.size() == (size_t)nSamples, "Number of samples and target outputs must match");
+    int nFeatures = (int)sampleFeatureVectors[0].size();
+    ASSERT_THROW(nFeatures > 0, "Number of features must be greater than zero");
+
+    std::ofstream samplesFile(filePath, std::ios::out | std::ios::binary);
+    ASSERT_THROW(samplesFile.is_open(), "Failed to open the specified samples BINARY file: '" + filePath + "'");
+
+    std::string headerStr = float32 ? ESVM_BINARY_HEADER_SAMPLES_ALIGNED_FLOAT32 : ESVM_BINARY_HEADER_SAMPLES_ALIGNED;
+    samplesFile.write(headerStr.c_str(), headerStr.size());
+    samplesFile.write(reinterpret_cast<const char*>(&nSamples), sizeof(int));
+    samplesFile.write(reinterpret_cast<const char*>(&nFeatures), sizeof(int));
+    samplesFile.write(reinterpret_cast<const char*>(targetOutputs.data()), nSamples * sizeof(int));
+    size_t offset = headerStr.size() + (2 + (size_t)nSamples) * sizeof(int);
+    std::vector<char> padding((ESVM_SAMPLES_FILE_ALIGNMENT - offset % ESVM_SAMPLES_FILE_ALIGNMENT) % ESVM_SAMPLES_FILE_ALIGNMENT, 0);
+    samplesFile.write(padding.data(), padding.size());
+    std::vector<float> sampleFeatures(float32 ? nFeatures : 0);
+    for (int s = 0; s < nSamples; ++s) {
+        ASSERT_THROW(sampleFeatureVectors[s].size() == (size_t)nFeatures, "Number of features must be identical for all samples");
+        if (float32) {
+            sampleFeatures.assign(sampleFeatureVectors[s].begin(), sampleFeatureVectors[s].end());
+            samplesFile.write(reinterpret_cast<const char*>(sampleFeatures.data()), nFeatures * sizeof(float));
+        }
+        else
+            samplesFile.write(reinterpret_cast<const char*>(sampleFeatureVectors[s].data()), nFeatures * sizeof(double));
+    }
+    ASSERT_THROW(samplesFile.good(), "Invalid file stream status when writing samples BINARY file");
 }
 
 /*
@@ -584,7 +1076,8 @@ bool ESVM::loadModelFile(std::string modelFilePath, FileFormat format, std::stri
 void ESVM::loadModelFile_libsvm(std::string filePath)
 {
     std::ifstream modelFile(filePath, std::ios::in | std::ios::binary);
-    bool isBinary = DataFile::checkBinaryHeader(modelFile, ESVM_BINARY_HEADER_MODEL_LIBSVM) ||
+    bool isBinary = DataFile::checkBinaryHeader(modelFile, ESVM_BINARY_HEADER_MODEL) ||
+                    DataFile::checkBinaryHeader(modelFile, ESVM_BINARY_HEADER_MODEL_LIBSVM) ||
                     DataFile::checkBinaryHeader(modelFile, ESVM_BINARY_HEADER_MODEL_LIBLINEAR);
     if (modelFile.is_open())
         modelFile.close();
@@ -603,73 +1096,206 @@ void ESVM::loadModelFile_libsvm(std::string filePath)
 }
 
 /*
-    Reads and updates the ESVM from a pre-trained BINARY model file
-    (see writing function for expected format)
+    Reads and updates the ESVM from a pre-trained BINARY model file, either the current format (see writing function)
+    or the legacy LIBSVM support vectors format ('ESVM_BINARY_HEADER_MODEL_LIBSVM')
 */
 void ESVM::loadModelFile_binary(std::string filePath)
 {
-    // check for opened file
+    std::string headerStr = ESVM_BINARY_HEADER_MODEL;
+    std::string fileHeader(headerStr.size(), '\0');
     std::ifstream modelFile(filePath, std::ios::in | std::ios::binary);
     ASSERT_THROW(modelFile.is_open(), "Failed to open the specified model BINARY file: '" + filePath + "'");
+    modelFile.read(&fileHeader[0], fileHeader.size());
+    modelFile.close();
+    if (fileHeader == headerStr)
+        loadModelFile_binaryWeights(filePath);
+    else
+        loadModelFile_binarySupportVectors(filePath);
+}
+
+/*
+    Reads and updates the ESVM from a BINARY model file storing the dense LINEAR decision function (see writing function)
+    The whole file is read at once and rejected if truncated or if its checksum does not match, before any model allocation.
+*/
+void ESVM::loadModelFile_binaryWeights(std::string filePath)
+{
+    std::ifstream modelFile(filePath, std::ios::in | std::ios::binary | std::ios::ate);
+    ASSERT_THROW(modelFile.is_open(), "Failed to open the specified model BINARY file: '" + filePath + "'");
+    std::streamoff fileSize = modelFile.tellg();
+    modelFile.seekg(0, std::ios::beg);
+    std::vector<char> content((size_t)std::max(fileSize, (std::streamoff)0));
+    modelFile.read(content.data(), content.size());
+    ASSERT_THROW(modelFile.good(), "Invalid file stream status when reading model");
+    modelFile.close();
+
+    // fixed size fields, then checksum of all preceding bytes at the end of the file
+    std::string headerStr = ESVM_BINARY_HEADER_MODEL;
+    const size_t fieldsSize = headerStr.size() + 8 * sizeof(int) + 3 * sizeof(double);
+    ASSERT_THROW(content.size() >= fieldsSize + sizeof(uint32_t), "Model BINARY file is truncated: '" + filePath + "'");
+    uint32_t fileChecksum;
+    std::memcpy(&fileChecksum, content.data() + content.size() - sizeof(uint32_t), sizeof(uint32_t));
+    boost::crc_32_type checksum;
+    checksum.process_bytes(content.data(), content.size() - sizeof(uint32_t));
+    ASSERT_THROW(checksum.checksum() == fileChecksum, "Model BINARY file checksum mismatch (corrupted or incomplete file): '" + filePath + "'");
+
+    const char* cursor = content.data() + headerStr.size();
+    auto readValue = [&cursor](void* value, size_t size) { std::memcpy(value, cursor, size); cursor += size; };
+    int version, byteOrder, library, labels[2], nFeatures, valueSize, hasProbability;
+    double bias, probability[2];
+    readValue(&version, sizeof(int));
+    readValue(&byteOrder, sizeof(int));
+    readValue(&library, sizeof(int));
+    readValue(labels, 2 * sizeof(int));
+    readValue(&nFeatures, sizeof(int));
+    readValue(&valueSize, sizeof(int));
+    readValue(&hasProbability, sizeof(int));
+    readValue(&bias, sizeof(double));
+    readValue(probability, 2 * sizeof(double));
+    ASSERT_THROW(version == ESVM_MODEL_FILE_VERSION, "Unsupported model BINARY file format version: " + std::to_string(version));
+    ASSERT_THROW(byteOrder == 0x01020304, "Model BINARY file was saved with a different byte order");
+    ASSERT_THROW(library == 0 || library == 1, "Invalid SVM library in model BINARY file");
+    ASSERT_THROW((labels[0] == ESVM_POSITIVE_CLASS && labels[1] == ESVM_NEGATIVE_CLASS) ||
+                 (labels[1] == ESVM_POSITIVE_CLASS && labels[0] == ESVM_NEGATIVE_CLASS),
+                 "Read labels are not set to expected distinct positive and negative class values");
+    ASSERT_THROW(nFeatures > 0, "Read number of features should be greater than zero");
+    ASSERT_THROW(valueSize == sizeof(float) || valueSize == sizeof(double), "Invalid weights value size in model BINARY file");
+
+    size_t weightsOffset = fieldsSize + (ESVM_MODEL_FILE_ALIGNMENT - fieldsSize % ESVM_MODEL_FILE_ALIGNMENT) % ESVM_MODEL_FILE_ALIGNMENT;
+    ASSERT_THROW(content.size() == weightsOffset + (size_t)nFeatures * valueSize + sizeof(uint32_t),
+                 "Model BINARY file size does not match the expected weights size");
+    FeatureVector modelWeights(nFeatures);
+    if (valueSize == sizeof(double))
+        std::memcpy(modelWeights.data(), content.data() + weightsOffset, nFeatures * sizeof(double));
+    else {
+        std::vector<float> modelWeights32(nFeatures);
+        std::memcpy(modelWeights32.data(), content.data() + weightsOffset, nFeatures * sizeof(float));
+        modelWeights.assign(modelWeights32.begin(), modelWeights32.end());
+    }
+
+    resetModel(makeCompiledModel(modelWeights.data(), (size_t)nFeatures, bias, labels, hasProbability ? probability : nullptr, config), false);
+}
+
+/*
+    Reads and updates the ESVM from a legacy pre-trained BINARY model file of LIBSVM support vectors
+    (format of the previous writing function, without the decision function collapsed to weights)
+
+        TYPE          QUANTITY                VALUE
+        ========================================
+        (char)      | len(header)           | 'ESVM_BINARY_HEADER_MODEL_LIBSVM'
+        (double)    | 1                     | rho (constant in decision function - only one since 2 classes)
+        (int)       | 2                     | class labels (corresponding to following support vectors order)
+        (int)       | 2                     | nSV (number of support vectors per corresponding class label)
+        (int)       | 1                     | nFeatures (number of feature nodes of each support vector)
+        (double)    | sum(nSV)              | coefficients of decision function for corresponding support vectors
+        (svm_node)  | sum(nSV) * nFeatures  | raw support vector nodes (without their (-1,?) terminator)
+
+    Coefficients and support vector nodes are read in bulk after validating the file length. Node indexes are kept as
+    written, indexes lower than one are ignored by the decision function as for any LIBSVM model (see 'collapseModel').
+    When models are compiled ('ESVM_USE_COMPILED_MODEL'), support vectors are directly collapsed to the weight vector (single
+    support vector model, see the compiled constructor), otherwise their nodes are laid out in a single contiguous allocation.
+*/
+void ESVM::loadModelFile_binarySupportVectors(std::string filePath)
+{
+    // check for opened file
+    std::ifstream modelFile(filePath, std::ios::in | std::ios::binary | std::ios::ate);
+    ASSERT_THROW(modelFile.is_open(), "Failed to open the specified model BINARY file: '" + filePath + "'");
 
-    svmModel* model;
+    svmModel* model = nullptr;
     try
     {
         #if ESVM_USE_LIBSVM
 
+        std::streamoff fileSize = modelFile.tellg();
+        modelFile.seekg(0, std::ios::beg);
+
         // check for header
         ASSERT_THROW(DataFile::checkBinaryHeader(modelFile, ESVM_BINARY_HEADER_MODEL_LIBSVM), "Expected BINARY file header was not found");
 
+        // labels required to determine/ensure of the order of positives/negatives SV saved to file
+        double rho = 0;
+        int labels[2]{ 0, 0 };
+        int nSV[2]{ 0, 0 };
+        int nFeatures = 0;
+        modelFile.read(reinterpret_cast<char*>(&rho), sizeof(rho));
+        modelFile.read(reinterpret_cast<char*>(labels), 2 * sizeof(labels[0]));
+        modelFile.read(reinterpret_cast<char*>(nSV), 2 * sizeof(nSV[0]));          // positive/negative SV
+        modelFile.read(reinterpret_cast<char*>(&nFeatures), sizeof(nFeatures));    // features count for each SV
+        ASSERT_THROW(modelFile.good(), "Invalid file stream status when reading model");
+        ASSERT_THROW((labels[0] == ESVM_POSITIVE_CLASS && labels[1] == ESVM_NEGATIVE_CLASS) ||
+                     (labels[1] == ESVM_POSITIVE_CLASS && labels[0] == ESVM_NEGATIVE_CLASS),
+                     "Read labels are not set to expected distinct positive and negative class values");
+        ASSERT_THROW(nSV[0] > 0, "Read number of positive support vectors should be greater than zero");
+        ASSERT_THROW(nSV[1] > 0, "Read number of negative support vectors should be greater than zero");
+        ASSERT_THROW(nFeatures > 0, "Read number of features should be greater than zero");
+        int nTotalSV = nSV[0] + nSV[1];
+
+        // read decision function coefficients followed by raw support vector nodes [sv][feature] in bulk
+        size_t nNodes = (size_t)nTotalSV * (size_t)nFeatures;
+        ASSERT_THROW((size_t)(fileSize - modelFile.tellg()) == nTotalSV * sizeof(double) + nNodes * sizeof(svmFeature),
+                     "Model BINARY file size does not match the expected support vectors size");
+        std::vector<double> coefficients(nTotalSV);
+        std::vector<svmFeature> nodesSV(nNodes);
+        modelFile.read(reinterpret_cast<char*>(coefficients.data()), nTotalSV * sizeof(double));
+        modelFile.read(reinterpret_cast<char*>(nodesSV.data()), nNodes * sizeof(svmFeature));
+        ASSERT_THROW(modelFile.good(), "Invalid file stream status when reading model");
+        modelFile.close();
+        for (size_t n = 0; n < nNodes; ++n)
+            ASSERT_THROW(nodesSV[n].index <= nFeatures, "Support vector node index exceeds the number of features in model BINARY file");
+
+        #if ESVM_USE_COMPILED_MODEL
+        if (!config.usePredictProbability())
+        {
+            FeatureVector compiledWeights(nFeatures, 0.0);
+            for (size_t n = 0; n < nNodes; ++n)
+                if (nodesSV[n].index > 0)
+                    compiledWeights[nodesSV[n].index - 1] += coefficients[n / nFeatures] * nodesSV[n].value;
+            model = makeCompiledModel(compiledWeights.data(), (size_t)nFeatures, -rho, labels, nullptr, config);
+            resetModel(model, false);
+            return;
+        }
+        #endif/*ESVM_USE_COMPILED_MODEL*/
+
         // set assumed parameters and prepare containers
         svmParam param;
         param.svm_type = C_SVC;
         param.kernel_type = LINEAR;
-        model = makeEmptyModel();
+        model = makeEmptyModel(config);
         model->param = param;
         model->nr_class = 2;
+        model->l = nTotalSV;
         model->rho = Malloc(double, 1);             // 1 decision function parameter
-        model->sv_coef = Malloc(double*, 1);        // 1 x N sv coefficients for 1 decision function
+        model->rho[0] = rho;
         model->label = Malloc(int, model->nr_class);
         model->nSV = Malloc(int, model->nr_class);
-
-        // labels required to determine/ensure of the order of positives/negatives SV saved to file
-        modelFile.read(reinterpret_cast<char*>(&model->rho[0]), sizeof(model->rho[0]));
-        modelFile.read(reinterpret_cast<char*>(&model->label[0]), model->nr_class * sizeof(model->label[0]));
-        ASSERT_THROW((model->label[0] == ESVM_POSITIVE_CLASS && model->label[1] == ESVM_NEGATIVE_CLASS) ||
-                     (model->label[1] == ESVM_POSITIVE_CLASS && model->label[0] == ESVM_NEGATIVE_CLASS),
-                     "Read labels are not set to expected distinct positive and negative class values");
-
-        // read general parameters
-        int nFeatures = 0;
-        modelFile.read(reinterpret_cast<char*>(&model->nSV[0]), model->nr_class * sizeof(model->nSV[0]));   // positive/negative SV
-        modelFile.read(reinterpret_cast<char*>(&nFeatures), sizeof(nFeatures));                             // features count for each SV
-        model->l = model->nSV[0] + model->nSV[1];                                                           // total number of support vectors
-        ASSERT_THROW(model->l > 0, "Read total number of support vectors should be greater than zero");
-        ASSERT_THROW(model->nSV[0] > 0, "Read number of positive support vectors should be greater than zero");
-        ASSERT_THROW(model->nSV[1] > 0, "Read number of negative support vectors should be greater than zero");
-        ASSERT_THROW(nFeatures > 0, "Read number of features should be greater than zero");
-
-        // read support vectors and decision function coefficients
-        std::vector<FeatureVector> sampleSV(model->l);
+        for (int c = 0; c < model->nr_class; ++c) {
+            model->label[c] = labels[c];
+            model->nSV[c] = nSV[c];
+        }
+        model->sv_coef = Malloc(double*, 1);        // 1 x N sv coefficients for 1 decision function
         model->sv_coef[0] = Malloc(double, model->l);
-        modelFile.read(reinterpret_cast<char*>(&model->sv_coef[0][0]), model->l * sizeof(model->sv_coef[0][0]));
+        std::copy(coefficients.begin(), coefficients.end(), model->sv_coef[0]);
+
+        // support vector nodes in one contiguous allocation (flagged to be deallocated as a single block, see 'destroyModel')
         model->SV = Malloc(svmFeature*, model->l);
-        for (int sv = 0; sv < model->l; ++sv)
-        {
-            sampleSV[sv] = FeatureVector(nFeatures);
-            modelFile.read(reinterpret_cast<char*>(&sampleSV[sv][0]), nFeatures * sizeof(&sampleSV[sv][0]));
-            model->SV[sv] = getFeatureNodes(sampleSV[sv]);
-            ASSERT_THROW(modelFile.good(), "Invalid file stream status when reading model");
+        model->SV[0] = Malloc(svmFeature, (size_t)model->l * (nFeatures + 1));
+        for (int sv = 0; sv < model->l; ++sv) {
+            svmFeature* nodes = model->SV[0] + (size_t)sv * (nFeatures + 1);
+            std::copy(nodesSV.begin() + (size_t)sv * nFeatures, nodesSV.begin() + (size_t)(sv + 1) * nFeatures, nodes);
+            nodes[nFeatures].index = -1;
+            model->SV[sv] = nodes;
         }
 
-        model->param.probability = ESVM_USE_PREDICT_PROBABILITY;
+        model->param.probability = config.usePredictProbability();
         model->probA = nullptr;
         model->probB = nullptr;
 
-        model->free_sv = FreeModelState::MODEL; // flag model obtained from pre-trained file instead of trained from samples
-        modelFile.close();
-        checkModelParameters_assert(model);
-        resetModel(model);
+        model->free_sv = FreeModelState::CONTIGUOUS;    // flag model obtained from pre-trained file with contiguous support vectors
+        checkModelParameters_assert(model, config);
+        resetModel(model, false);
+
+        #elif ESVM_USE_LIBLINEAR
+
+        THROW("Legacy BINARY model files of support vectors are only supported by LIBSVM");
 
         #endif/*ESVM_USE_LIBSVM*/
     }
@@ -677,8 +1303,8 @@ void ESVM::loadModelFile_binary(std::string filePath)
     {
         if (modelFile.is_open())
             modelFile.close();
-        if (model)
-            svmFreeModel(model);
+        if (model && model != esvmModel)
+            destroyModel(&model);
         throw ex;
     }
 }
@@ -690,7 +1316,15 @@ bool ESVM::saveModelFile(std::string modelFilePath, FileFormat format) const
 {
     ASSERT_THROW(isModelSet(), "Cannot save an unset model");
 
-    if (format == LIBSVM)
+    if (format == LIBSVM && esvmModel == nullptr)
+    {
+        // compiled-only, equivalent model saved
+        svmModel* model = makeCompiledModel();
+        bool saved = svmSaveModel(modelFilePath.c_str(), model) == 0;
+        destroyModel(&model);
+        return saved;
+    }
+    else if (format == LIBSVM)
         return svmSaveModel(modelFilePath.c_str(), esvmModel) == 0;     // 0 if success, -1 otherwise
     else if (format == BINARY)
     {
@@ -704,62 +1338,72 @@ bool ESVM::saveModelFile(std::string modelFilePath, FileFormat format) const
 
 /*
     Writes the ESVM model to a BINARY model file
+    The LINEAR decision function is stored as dense weights and bias for both LIBSVM and LIBLINEAR, weights being aligned
+    from the start of the file ('ESVM_MODEL_FILE_ALIGNMENT') for direct vectorized use once loaded or memory-mapped.
 */
 void ESVM::saveModelFile_binary(std::string filePath) const
 {
     /*
     Expected data format and order:    <all reinterpreted as char*>
 
-        TYPE          QUANTITY                VALUE
+        TYPE          QUANTITY                      VALUE
         ========================================
-        (char)      | len(header)           | 'ESVM_BINARY_HEADER_MODEL'
-        (double)    | 1                     | rho (constant in decision function - only one since 2 classes)
-        (int)       | 2                     | class labels (corresponding to following support vectors order)
-        (int)       | 2                     | nSV (number of support vectors per corresponding class label)
-        (int)       | 1                     | nFeatures (number of features forming support vectors)
-        (double)    | sum(nSV)              | coefficients of decision function for corresponding support vectors
-        (double)    | sum(nSV) * nFeatures  | support vector features
+        (char)      | len(header)                 | 'ESVM_BINARY_HEADER_MODEL'
+        (int)       | 1                           | format version ('ESVM_MODEL_FILE_VERSION')
+        (int)       | 1                           | byte order mark (0x01020304)
+        (int)       | 1                           | SVM library of the saved model (0: LIBSVM, 1: LIBLINEAR)
+        (int)       | 2                           | class labels (positive/negative order of the decision function)
+        (int)       | 1                           | nFeatures (number of weights)
+        (int)       | 1                           | weights value size (4|8)
+        (int)       | 1                           | probability parameters available (0|1)
+        (double)    | 1                           | bias (constant of the decision function)
+        (double)    | 2                           | probability parameters (probA, probB), zero if unavailable
+        (char)      | [0, ESVM_MODEL_FILE_ALIGNMENT[ | zero padding to align following weights
+        (esvmScalar)| nFeatures                   | weights of the decision function (float with 'ESVM_USE_FLOAT32', double otherwise)
+        (uint32)    | 1                           | CRC-32 of all preceding bytes
     */
 
-    std::ofstream modelFile(filePath, std::ios::out | std::ios::binary);
-    ASSERT_THROW(modelFile.is_open(), "Failed to open the specified model BINARY file: '" + filePath + "'");
-
-    try
-    {
-        #if ESVM_USE_LIBSVM
-
-        // get support vector and feature counts (expected valid dimensions from properly trained model)
-        int nFeatures = (int)getFeatureVector(esvmModel->SV[0]).size(); // warning: format 'int' required, not 'size_t' for matching binary dimension
-        ASSERT_THROW(esvmModel->l > 0, "Cannot save a model that doesn't contain any support vector");
-        ASSERT_THROW(nFeatures > 0, "Cannot save a model with support vectors not containing any feature");
-
-        // write header and counts for later reading
-        std::string headerStr = ESVM_BINARY_HEADER_MODEL_LIBSVM;
-        const char *headerChar = headerStr.c_str();
-        modelFile.write(headerChar, headerStr.size());
-        modelFile.write(reinterpret_cast<const char*>(&esvmModel->rho[0]), sizeof(esvmModel->rho[0]));
-        modelFile.write(reinterpret_cast<const char*>(&esvmModel->label[0]), esvmModel->nr_class * sizeof(esvmModel->label[0]));
-        modelFile.write(reinterpret_cast<const char*>(&esvmModel->nSV[0]), esvmModel->nr_class * sizeof(esvmModel->nSV[0]));
-        modelFile.write(reinterpret_cast<const char*>(&nFeatures), sizeof(nFeatures));
-
-        // write support vectors and decision function coefficients
-        modelFile.write(reinterpret_cast<const char*>(&esvmModel->sv_coef[0][0]), esvmModel->l * sizeof(esvmModel->sv_coef[0][0]));
-        for (int sv = 0; sv < esvmModel->l; ++sv)
-            modelFile.write(reinterpret_cast<const char*>(&esvmModel->SV[sv][0]), nFeatures * sizeof(esvmModel->SV[sv][0]));
-        modelFile.close();
+    FeatureVector modelWeights;
+    double modelBias = bias;
+    if (esvmModel == nullptr)   // compiled-only
+        modelWeights.assign(weights.ptr<esvmScalar>(), weights.ptr<esvmScalar>() + weights.cols);
+    else
+        ASSERT_THROW(collapseModel(esvmModel, modelWeights, modelBias), "Only LINEAR two-class models can be saved to BINARY model file");
+    ASSERT_THROW(modelWeights.size() > 0, "Cannot save a model with support vectors not containing any feature");
 
-        #elif ESVM_USE_LIBLINEAR
+    int labels[2];
+    double probability[2];
+    getOutputParameters(labels, probability);
+    int hasProbability = 0;
+    #if ESVM_USE_LIBSVM
+    if (esvmModel == nullptr)
+        hasProbability = (config.usePredictProbability() && (probability[0] != 0 || probability[1] != 0)) ? 1 : 0;
+    else
+        hasProbability = (esvmModel->param.probability && esvmModel->probA && esvmModel->probB) ? 1 : 0;
+    int library = 0;
+    #elif ESVM_USE_LIBLINEAR
+    int library = 1;
+    #endif/*ESVM_USE_LIBSVM*/
 
-        #error "LIBLINEAR not implemented"
+    std::string content = ESVM_BINARY_HEADER_MODEL;
+    auto appendValue = [&content](const void* value, size_t size) { content.append(reinterpret_cast<const char*>(value), size); };
+    std::vector<esvmScalar> storedWeights(modelWeights.begin(), modelWeights.end());   // narrowed once if float32 weights
+    int fields[] = { ESVM_MODEL_FILE_VERSION, 0x01020304, library, labels[0], labels[1], (int)storedWeights.size(), (int)sizeof(esvmScalar), hasProbability };
+    appendValue(fields, sizeof(fields));
+    appendValue(&modelBias, sizeof(double));
+    appendValue(probability, 2 * sizeof(double));
+    content.append((ESVM_MODEL_FILE_ALIGNMENT - content.size() % ESVM_MODEL_FILE_ALIGNMENT) % ESVM_MODEL_FILE_ALIGNMENT, '\0');
+    appendValue(storedWeights.data(), storedWeights.size() * sizeof(esvmScalar));
+    boost::crc_32_type checksum;
+    checksum.process_bytes(content.data(), content.size());
+    uint32_t contentChecksum = checksum.checksum();
+    appendValue(&contentChecksum, sizeof(uint32_t));
 
-        #endif/*esvm impl*/
-    }
-    catch(std::exception& ex)
-    {
-        if (modelFile.is_open())
-            modelFile.close();
-        throw ex;
-    }
+    std::ofstream modelFile(filePath, std::ios::out | std::ios::binary);
+    ASSERT_THROW(modelFile.is_open(), "Failed to open the specified model BINARY file: '" + filePath + "'");
+    modelFile.write(content.data(), content.size());
+    ASSERT_THROW(modelFile.good(), "Invalid file stream status when writing model");
+    modelFile.close();
 }
 
 /*
@@ -776,6 +1420,14 @@ void ESVM::trainModel(std::vector<FeatureVector> samples, std::vector<int> targe
     svmProblem prob;
     prob.l = (int)samples.size();   // number of training data
 
+    #if ESVM_USE_LIBLINEAR
+    // feature count including the constant bias feature appended to every sample
+    for (int s = 1; s < prob.l; ++s)
+        ASSERT_THROW(samples[s].size() == samples[0].size(), "LIBLINEAR samples must all have the same feature count for the bias node");
+    prob.n = (int)samples[0].size() + ESVM_BIAS_NODES;
+    prob.bias = ESVM_LIBLINEAR_BIAS;
+    #endif/*ESVM_USE_LIBLINEAR*/
+
     // convert and assign training vectors and corresponding target values for classification
     prob.y = Malloc(double, prob.l);
     prob.x = Malloc(svmFeature*, prob.l);
@@ -789,48 +1441,7 @@ void ESVM::trainModel(std::vector<FeatureVector> samples, std::vector<int> targe
     }
 
     // set training parameters
-    svmParam param;
-    param.C = 1;                // cost constraint violation used for w*C
-    param.eps = 0.001;          // stopping optimization criterion
-
-    #if ESVM_USE_LIBSVM
-
-    param.svm_type = C_SVC;     // cost classifier SVM
-    param.kernel_type = LINEAR; // linear kernel
-    param.probability = 0;      // possibility to use probability outputs instead of (+1,-1) classes (adds extra training time)
-    param.shrinking = 1;        // use problem shrinking heuristics
-    param.cache_size = 100;     // size in MB
-
-    /* unused default values
-          libsvm 'svm_check_parameter' sometimes returns an error if some parameters don't pass verifications values althought
-          these parameters are not employed by the current SVM/kernel types, simply set valid values to avoid random errors
-    */
-    param.coef0 = 0;            // coefficient of { POLY, SIGMOID } kernels
-    param.degree = 0;           // degree of POLY kernel
-    param.gamma = 0;            // gamma of { POLY, RBF, SIGMOID } kernels
-    param.nu = 0;               // nu for { NU_SVC, ONE_CLASS, NU_SVR } SVMs
-
-    #elif ESVM_USE_LIBLINEAR
-
-    param.solver_type = L2R_L2LOSS_SVC;
-
-    #endif/*ESVM_USE_LIBSVM*/
-
-    param.p = 0.1;              // epsilon in epsilon-insensitive loss function of support vector regression (SVR) types in LIBSVM/LIBLINEAR
-
-    #if ESVM_WEIGHTS_MODE == 0
-    param.nr_weight = 0;
-    param.weight = nullptr;
-    param.weight_label = nullptr;
-    #else/*ESVM_WEIGHTS_MODE != 0*/
-    param.nr_weight = 2;                    // number of weights
-    param.weight = Malloc(double, 2);       // class weights (positive, negative)
-    param.weight[0] = classWeights[0];
-    param.weight[1] = classWeights[1];
-    param.weight_label = Malloc(int, 2);    // class labels
-    param.weight_label[0] = ESVM_POSITIVE_CLASS;
-    param.weight_label[1] = ESVM_NEGATIVE_CLASS;
-    #endif/*ESVM_WEIGHTS_MODE*/
+    svmParam param = getTrainingParameters(classWeights, config);
 
     // validate parameters and train models
     svmModel* trainedModel = nullptr;
@@ -866,27 +1477,331 @@ void ESVM::trainModel(std::vector<FeatureVector> samples, std::vector<int> targe
     #endif/*ESVM_DISPLAY_TRAIN_PARAMS && !ESVM_DEBUG*/
 }
 
+/*
+    Trains the ESVM with the problem directly referencing the specified feature nodes (shared, not deallocated).
+    Trained support vectors are copied out of the shared nodes so that the model owns its memory as usual.
+    When an initial solution is specified, the optimization starts from it instead of zero (LIBLINEAR primal solver only).
+*/
+void ESVM::trainModelNodes(std::vector<svmFeature*> sampleNodes, std::vector<int> targetOutputs, std::vector<double> classWeights,
+                           const FeatureVector& initialSolution)
+{
+    ASSERT_THROW(sampleNodes.size() > 1, "Number of samples must be greater than one (at least 1 positive and 1 negative)");
+    ASSERT_THROW(sampleNodes.size() == targetOutputs.size(), "Number of samples must match number of corresponding target outputs");
+    ASSERT_THROW(classWeights.size() == 2, "Exemplar-SVM expects two weights (positive, negative)");
+    #if ESVM_USE_LIBLINEAR
+    ASSERT_THROW(initialSolution.empty() || config.solverMode == 1, "Warm start from an initial solution requires the primal solver");
+    #else/*ESVM_USE_LIBLINEAR*/
+    ASSERT_THROW(initialSolution.empty(), "Warm start from an initial solution is only supported by the LIBLINEAR primal solver");
+    #endif/*ESVM_USE_LIBLINEAR*/
+
+    logstream logger(LOGGER_FILE);
+
+    svmProblem prob;
+    prob.l = (int)sampleNodes.size();
+    prob.y = Malloc(double, prob.l);
+    prob.x = Malloc(svmFeature*, prob.l);
+    for (int s = 0; s < prob.l; ++s)
+    {
+        prob.y[s] = targetOutputs[s];
+        prob.x[s] = sampleNodes[s];
+    }
+
+    #if ESVM_USE_LIBLINEAR
+    // feature count from highest index, shared nodes already contain the constant bias feature (see 'makeFeatureNodes')
+    prob.n = 0;
+    for (int s = 0; s < prob.l; ++s)
+        for (svmFeature* node = prob.x[s]; node->index != -1; ++node)
+            prob.n = std::max(prob.n, node->index);
+    prob.bias = ESVM_LIBLINEAR_BIAS;
+    #endif/*ESVM_USE_LIBLINEAR*/
+
+    svmParam param = getTrainingParameters(classWeights, config);
+    svmModel* trainedModel = nullptr;
+    #if ESVM_USE_LIBLINEAR
+    std::vector<double> initialWeights;
+    #endif/*ESVM_USE_LIBLINEAR*/
+    try
+    {
+        #if ESVM_USE_LIBLINEAR
+        // initial solution in the LIBLINEAR weights space, the bias is the weight of the constant bias feature (see 'setBiasNode')
+        if (!initialSolution.empty()) {
+            ASSERT_THROW((int)initialSolution.size() == prob.n, "Initial solution must contain the weights of all features followed by the bias");
+            initialWeights.assign(initialSolution.begin(), initialSolution.end());
+            initialWeights.back() /= ESVM_LIBLINEAR_BIAS;
+            param.init_sol = initialWeights.data();
+        }
+        #endif/*ESVM_USE_LIBLINEAR*/
+        const char* msg = svmCheckParam(&prob, &param);
+        ASSERT_THROW(msg == nullptr, "Failure message from 'svm_check_parameter': " + std::string(msg) + "\n");
+        trainedModel = svmTrain(&prob, &param);
+    }
+    catch (std::exception& ex)
+    {
+        logger << "Exception occurred during ESVM training with shared feature nodes: [" << ex.what() << "]" << std::endl;
+        FreeNull(prob.x);
+        FreeNull(prob.y);
+        FreeNull(param.weight);
+        FreeNull(param.weight_label);
+        throw ex;
+    }
+
+    #if ESVM_USE_LIBSVM
+    // replace references to shared feature nodes by owned copies of corresponding support vectors
+    for (int sv = 0; sv < trainedModel->l; ++sv)
+        trainedModel->SV[sv] = copyFeatureNodes(trainedModel->SV[sv]);
+    #elif ESVM_USE_LIBLINEAR
+    trainedModel->param.init_sol = nullptr;     // local initial solution is only required during training
+    #endif/*ESVM_USE_LIBSVM*/
+
+    removeTrainedModelSharedData(trainedModel, &prob);
+    resetModel(trainedModel, false);
+
+    #if ESVM_DISPLAY_TRAIN_PARAMS && defined(ESVM_DEBUG)
+    logModelParameters(esvmModel, ID, ESVM_DISPLAY_TRAIN_PARAMS == 2);
+    #endif/*ESVM_DISPLAY_TRAIN_PARAMS && !ESVM_DEBUG*/
+}
+
+/*
+    Trains the ESVM with a precomputed kernel, the problem references the shared kernel rows of the negatives of the patch
+    and appends the rows of its own 'exemplarSamples' (positives and additional negatives), whose kernel values against
+    the negatives and themselves are the only ones computed for this exemplar (negatives Gram matrix is computed once).
+    Trained support vectors are then converted back to their LINEAR feature nodes so that the resulting model is identical
+    to one trained directly with the LINEAR kernel (same coefficients and decision function, compiled/saved as usual).
+*/
+void ESVM::trainModelPrecomputed(const cv::Mat& kernelNegatives, svmFeature** kernelRows, size_t kernelColumn,
+                                 const std::vector<FeatureVector>& exemplarSamples, std::vector<int> targetOutputs,
+                                 std::vector<double> classWeights)
+{
+    #if ESVM_USE_LIBSVM
+
+    int nNegatives = kernelNegatives.rows;
+    int nExemplar = (int)exemplarSamples.size();
+    ASSERT_THROW(kernelRows != nullptr || nNegatives == 0, "Missing precomputed kernel rows to train the model");
+    ASSERT_THROW(nExemplar + nNegatives > 1, "Number of samples must be greater than one (at least 1 positive and 1 negative)");
+    ASSERT_THROW(exemplarSamples.size() == targetOutputs.size(), "Number of samples must match number of corresponding target outputs");
+    ASSERT_THROW(classWeights.size() == 2, "Exemplar-SVM expects two weights (positive, negative)");
+    ASSERT_THROW(kernelNegatives.type() == CV_64F, "Precomputed kernel negatives must be of type 'CV_64F'");
+
+    logstream logger(LOGGER_FILE);
+
+    // kernel values of exemplar samples against the negatives and themselves, serial numbers of exemplar samples follow the
+    // negatives at the exemplar columns, which must have been reserved in the shared rows by 'makePrecomputedKernel'
+    int nFeatures = kernelNegatives.cols;
+    int firstSerial = nNegatives + (int)kernelColumn + 1;
+    cv::Mat exemplars(nExemplar, nFeatures, CV_64F);
+    for (int s = 0; s < nExemplar; ++s) {
+        ASSERT_THROW((int)exemplarSamples[s].size() == nFeatures, "Exemplar samples must have the same feature count as kernel negatives");
+        std::copy(exemplarSamples[s].begin(), exemplarSamples[s].end(), exemplars.ptr<double>(s));
+    }
+    cv::Mat exemplarKernel, negativeKernel;
+    cv::gemm(exemplars, exemplars, 1.0, cv::Mat(), 0.0, exemplarKernel, cv::GEMM_2_T);
+    if (nNegatives > 0) {
+        ASSERT_THROW(kernelRows[0][firstSerial + nExemplar - 1].index == firstSerial + nExemplar - 1,
+                     "Exemplar columns must be reserved in the precomputed kernel rows");
+        cv::gemm(kernelNegatives, exemplars, 1.0, cv::Mat(), 0.0, negativeKernel, cv::GEMM_2_T);
+        for (int neg = 0; neg < nNegatives; ++neg) {
+            const double* values = negativeKernel.ptr<double>(neg);
+            for (int s = 0; s < nExemplar; ++s)
+                kernelRows[neg][firstSerial + s].value = values[s];
+        }
+    }
+
+    // exemplar rows span up to their own serial numbers, columns of other exemplars are never referenced by this problem
+    int rowNodes = firstSerial + nExemplar + 1;
+    svmFeature* exemplarRows = Malloc(svmFeature, (size_t)nExemplar * (size_t)rowNodes);
+    for (int s = 0; s < nExemplar; ++s) {
+        svmFeature* row = exemplarRows + (size_t)s * rowNodes;
+        row[0].index = 0;
+        row[0].value = firstSerial + s;
+        for (int k = 1; k < firstSerial + nExemplar; ++k) {
+            row[k].index = k;
+            row[k].value = k <= nNegatives ? negativeKernel.ptr<double>(k - 1)[s]
+                         : k >= firstSerial ? exemplarKernel.ptr<double>(s)[k - firstSerial] : 0;
+        }
+        row[rowNodes - 1].index = -1;
+    }
+
+    // problem rows as [exemplar samples][negatives], their first node holds the kernel sample serial number (see LIBSVM README)
+    svmProblem prob;
+    prob.l = nExemplar + nNegatives;
+    prob.y = Malloc(double, prob.l);
+    prob.x = Malloc(svmFeature*, prob.l);
+    for (int s = 0; s < prob.l; ++s)
+    {
+        prob.y[s] = s < nExemplar ? targetOutputs[s] : ESVM_NEGATIVE_CLASS;
+        prob.x[s] = s < nExemplar ? exemplarRows + (size_t)s * rowNodes : kernelRows[s - nExemplar];
+    }
+
+    svmParam param = getTrainingParameters(classWeights, config);
+    param.kernel_type = PRECOMPUTED;
+
+    svmModel* trainedModel = nullptr;
+    try
+    {
+        const char* msg = svmCheckParam(&prob, &param);
+        ASSERT_THROW(msg == nullptr, "Failure message from 'svm_check_parameter': " + std::string(msg) + "\n");
+        trainedModel = svmTrain(&prob, &param);
+    }
+    catch (std::exception& ex)
+    {
+        logger << "Exception occurred during ESVM training with precomputed kernel: [" << ex.what() << "]" << std::endl;
+        FreeNull(exemplarRows);
+        FreeNull(prob.x);
+        FreeNull(prob.y);
+        FreeNull(param.weight);
+        FreeNull(param.weight_label);
+        throw ex;
+    }
+
+    // replace references to kernel rows by the LINEAR feature nodes of corresponding support vectors
+    for (int sv = 0; sv < trainedModel->l; ++sv) {
+        int s = trainedModel->sv_indices[sv] - 1;   // one-based
+        trainedModel->SV[sv] = s < nExemplar ? getFeatureNodes(exemplarSamples[s])
+                                             : getFeatureNodes(kernelNegatives.ptr<double>(s - nExemplar), nFeatures);
+    }
+    trainedModel->param.kernel_type = LINEAR;
+    FreeNull(exemplarRows);
+
+    removeTrainedModelSharedData(trainedModel, &prob);
+    resetModel(trainedModel, false);
+
+    #if ESVM_DISPLAY_TRAIN_PARAMS && defined(ESVM_DEBUG)
+    logModelParameters(esvmModel, ID, ESVM_DISPLAY_TRAIN_PARAMS == 2);
+    #endif/*ESVM_DISPLAY_TRAIN_PARAMS && !ESVM_DEBUG*/
+
+    #else/*ESVM_USE_LIBSVM*/
+    THROW("Precomputed kernel training is only available with LIBSVM");
+    #endif/*ESVM_USE_LIBSVM*/
+}
+
+/*
+    Generates the precomputed LINEAR kernel rows (Gram matrix) of the negatives of a patch/subspace in LIBSVM 'PRECOMPUTED'
+    format, followed by 'exemplarColumns' columns reserved for the kernel values of exemplar samples (see the precomputed
+    kernel ESVM constructor). Row 'i' is '(0, i+1) (1, K(i,0)) ... (N, K(i,N-1)) (N+1, 0) ... (N+C, 0) (-1, ?)' and all
+    rows are allocated in a single contiguous block. Kernel values are computed by blocks of rows with matrix products to
+    limit the temporary memory.
+*/
+svmFeature** ESVM::makePrecomputedKernel(const cv::Mat& kernelNegatives, size_t exemplarColumns)
+{
+    #if ESVM_USE_LIBSVM
+
+    int N = kernelNegatives.rows;
+    ASSERT_THROW(N > 0, "Precomputed kernel requires at least one sample");
+    ASSERT_THROW(kernelNegatives.type() == CV_64F, "Precomputed kernel negatives must be of type 'CV_64F'");
+    const cv::Mat& samples = kernelNegatives;
+    int nColumns = N + (int)exemplarColumns;
+
+    svmFeature** kernelRows = Malloc(svmFeature*, N);
+    kernelRows[0] = Malloc(svmFeature, (size_t)N * (size_t)(nColumns + 2));
+    for (int s = 1; s < N; ++s)
+        kernelRows[s] = kernelRows[s - 1] + (nColumns + 2);
+
+    const int blockRows = 256;
+    int nBlocks = (N + blockRows - 1) / blockRows;
+    #ifndef ESVM_DEBUG
+    #pragma omp parallel for schedule(dynamic, 1)
+    #endif
+    for (int b = 0; b < nBlocks; ++b)
+    {
+        int first = b * blockRows;
+        int last = std::min(first + blockRows, N);
+        cv::Mat kernelBlock;
+        cv::gemm(samples.rowRange(first, last), samples, 1.0, cv::Mat(), 0.0, kernelBlock, cv::GEMM_2_T);
+        for (int s = first; s < last; ++s) {
+            svmFeature* row = kernelRows[s];
+            const double* values = kernelBlock.ptr<double>(s - first);
+            row[0].index = 0;
+            row[0].value = s + 1;       // sample serial number, one-based
+            for (int k = 0; k < nColumns; ++k) {
+                row[k + 1].index = k + 1;
+                row[k + 1].value = k < N ? values[k] : 0;
+            }
+            row[nColumns + 1].index = -1;
+        }
+    }
+    return kernelRows;
+
+    #else/*ESVM_USE_LIBSVM*/
+    THROW("Precomputed kernel training is only available with LIBSVM");
+    #endif/*ESVM_USE_LIBSVM*/
+}
+
 bool ESVM::isModelSet() const
 {
-    return (esvmModel != nullptr);
+    return (esvmModel != nullptr || isModelCompiled());
 }
 
 bool ESVM::isModelTrained() const
 {
-    return (isModelSet() && getFreeSV(esvmModel) != FreeModelState::PARAM);
+    return (isModelCompiled() || (esvmModel != nullptr && getFreeSV(esvmModel) != FreeModelState::PARAM));
+}
+
+/*
+    Obtains the ESVM training parameters with the specified class weights (positive, negative)
+*/
+svmParam ESVM::getTrainingParameters(std::vector<double> classWeights, const esvmConfig& config)
+{
+    svmParam param;
+    param.C = 1;                // cost constraint violation used for w*C
+    param.eps = 0.001;          // stopping optimization criterion
+
+    #if ESVM_USE_LIBSVM
+
+    param.svm_type = C_SVC;     // cost classifier SVM
+    param.kernel_type = LINEAR; // linear kernel
+    param.probability = 0;      // possibility to use probability outputs instead of (+1,-1) classes (adds extra training time)
+    param.shrinking = 1;        // use problem shrinking heuristics
+    param.cache_size = 100;     // size in MB
+
+    /* unused default values
+          libsvm 'svm_check_parameter' sometimes returns an error if some parameters don't pass verifications values althought
+          these parameters are not employed by the current SVM/kernel types, simply set valid values to avoid random errors
+    */
+    param.coef0 = 0;            // coefficient of { POLY, SIGMOID } kernels
+    param.degree = 0;           // degree of POLY kernel
+    param.gamma = 0;            // gamma of { POLY, RBF, SIGMOID } kernels
+    param.nu = 0;               // nu for { NU_SVC, ONE_CLASS, NU_SVR } SVMs
+
+    #elif ESVM_USE_LIBLINEAR
+
+    // L2-regularized L2-loss (squared hinge) SVC solved either in the dual (coordinate descent) or primal (trust region Newton)
+    // problem, both directly produce the weight vector of the decision function without keeping any support vector
+    param.solver_type = (config.solverMode == 1) ? L2R_L2LOSS_SVC : L2R_L2LOSS_SVC_DUAL;
+    param.init_sol = nullptr;   // no initial solution (see LIBLINEAR README)
+
+    #endif/*ESVM_USE_LIBSVM*/
+
+    param.p = 0.1;              // epsilon in epsilon-insensitive loss function of support vector regression (SVR) types in LIBSVM/LIBLINEAR
+
+    if (config.weightsMode == 0) {
+        param.nr_weight = 0;
+        param.weight = nullptr;
+        param.weight_label = nullptr;
+    }
+    else {
+        param.nr_weight = 2;                    // number of weights
+        param.weight = Malloc(double, 2);       // class weights (positive, negative)
+        param.weight[0] = classWeights[0];
+        param.weight[1] = classWeights[1];
+        param.weight_label = Malloc(int, 2);    // class labels
+        param.weight_label[0] = ESVM_POSITIVE_CLASS;
+        param.weight_label[1] = ESVM_NEGATIVE_CLASS;
+    }
+
+    return param;
 }
 
 /*
     Calculates positive and negative class weights (Wp, Wn) according to the specified weighting mode.
 
-    ESVM_WEIGHTS_MODE:
+    weightsMode ('ESVM_WEIGHTS_MODE' by default):
         0: (Wp = 0, Wn = 0)         unused
         1: (Wp = 1, Wn = 0.01)      enforced values
         2: (Wp = 100, Wn = 1)       enforced values
         3: (Wp = N/Np, Wn = N/Nn)   ratio of sample counts
         4: (Wp = 1, Wn = Np/Nn)     ratio of sample counts normalized for positives (Np/Nn = [N/Nn]/[N/Np])
 */
-std::vector<double> ESVM::calcClassWeightsFromMode(int positivesCount, int negativesCount)
+std::vector<double> ESVM::calcClassWeightsFromMode(int positivesCount, int negativesCount, int weightsMode)
 {
     int Np = positivesCount;
     int Nn = negativesCount;
@@ -894,22 +1809,15 @@ std::vector<double> ESVM::calcClassWeightsFromMode(int positivesCount, int negat
     ASSERT_THROW(Np > 0, "Number of positives must be greater than zero");
     ASSERT_THROW(Nn > 0, "Number of negatives must be greater than zero");
 
-    #if ESVM_WEIGHTS_MODE == 0
-    double Wp = 0;
-    double Wn = 0;
-    #elif ESVM_WEIGHTS_MODE == 1
-    double Wp = 1;
-    double Wn = 0.01;
-    #elif ESVM_WEIGHTS_MODE == 2
-    double Wp = 100;
-    double Wn = 1;
-    #elif ESVM_WEIGHTS_MODE == 3
-    double Wp = (double)N / (double)Np;
-    double Wn = (double)N / (double)Nn;
-    #elif ESVM_WEIGHTS_MODE == 4
-    double Wp = 1;
-    double Wn = (double)Np / (double)Nn;
-    #endif/*ESVM_WEIGHTS_MODE*/
+    double Wp, Wn;
+    switch (weightsMode) {
+        case 0:  Wp = 0;                        Wn = 0;                         break;
+        case 1:  Wp = 1;                        Wn = 0.01;                      break;
+        case 2:  Wp = 100;                      Wn = 1;                         break;
+        case 3:  Wp = (double)N / (double)Np;   Wn = (double)N / (double)Nn;    break;
+        case 4:  Wp = 1;                        Wn = (double)Np / (double)Nn;   break;
+        default: THROW("Unsupported weights mode: " + std::to_string(weightsMode));
+    }
 
     #ifdef ESVM_DEBUG
     logstream logger(LOGGER_FILE);
@@ -924,57 +1832,185 @@ std::vector<double> ESVM::calcClassWeightsFromMode(int positivesCount, int negat
     return { Wp, Wn };
 }
 
+/*
+    Converts a decision value of the compiled linear model to the output specified by the configured prediction mode,
+    matching the values that the SVM library would return for the same probe.
+*/
+double ESVM::predictOutput(double decision) const
+{
+    switch (config.predictMode) {
+        case 0:  return predictOutput<0>(decision);
+        case 1:  return predictOutput<1>(decision);
+        case 2:  return predictOutput<2>(decision);
+        default: THROW("Unsupported prediction mode: " + std::to_string(config.predictMode));
+    }
+}
+
+/*
+    Dot product of compiled weights with probe features using the SIMD kernel selected at runtime ('ESVM_USE_SIMD_DOT').
+    Probe features of another precision than the weights are first converted into a per-thread buffer.
+*/
+static inline double dotCompiledWeights(const cv::Mat& weights, const esvmScalar* probeSample, size_t nFeatures)
+{
+    return dotProduct(weights.ptr<esvmScalar>(), probeSample, nFeatures);
+}
+
+template<typename T>
+static inline double dotCompiledWeights(const cv::Mat& weights, const T* probeSample, size_t nFeatures)
+{
+    static thread_local std::vector<esvmScalar> probeScalar;
+    probeScalar.assign(probeSample, probeSample + nFeatures);
+    return dotProduct(weights.ptr<esvmScalar>(), probeScalar.data(), nFeatures);
+}
+
 /*
     Predicts the classification value for the specified feature vector sample using the trained ESVM model.
 */
-double ESVM::predict(FeatureVector probeSample) const
+double ESVM::predict(const FeatureVector& probeSample) const
+{
+    return predict(probeSample.data(), probeSample.size());
+}
+
+/*
+    Predicts the classification value for the specified array of features using the trained ESVM model.
+    No heap allocation occurs in steady state: the compiled model only requires a dot product, otherwise the SVM library
+    feature nodes are written into per-thread scratch buffers that are reused (and only grown) across calls.
+*/
+double ESVM::predict(const double* probeSample, size_t featureCount) const
 {
     ASSERT_THROW(isModelTrained(), "Cannot predict with untrained ESVM model");
 
-    #if   ESVM_PREDICT_MODE == 0    // predict values
-
-    // Obtain decision values directly (instead of predicted label/probability from 'svm_predict'/'svm_predict_probability')
-    // Since the number of decision values of each class combination is calculated with [ nr_class*(nr_class-1)/2 ],
-    // and that we have only 2 classes, we have only one decision value (positive vs. negative)
-    double* decisionValues = new double[esvmModel->nr_class * (esvmModel->nr_class - 1) / 2];
-    svmPredictValues(esvmModel, getFeatureNodes(probeSample), decisionValues);
-    double decision = decisionValues[0];
-    delete[] decisionValues;
-    return decision;
-
-    #elif ESVM_PREDICT_MODE == 1    // predict
-    
-    // Obtain predicted class
-    return svmPredict(esvmModel, getFeatureNodes(probeSample));
-
-    #elif ESVM_PREDICT_MODE == 2    // predict probability
-    
-    ASSERT_THROW(model->param.probability, "Cannot predict probability with SVM model without probability option");
-    /*
-    double* probEstimates = (double *)malloc(model->nr_class * sizeof(double)); // = new double[model->nr_class];
-    double p = svm_predict_probability(model, getFeatureVector(probeSample), probEstimates);
-    */
-    double* probEstimates = Malloc(double, model->nr_class);
-    svmPredictProbability(model, getFeatureVector(probeSample), probEstimates);
-    double probability = probEstimates[0];
-    FreeNull(probEstimates);
-    return probability;
+    if (isModelCompiled())
+    {
+        // features missing from the probe or the weights are zero-valued (sparse representation)
+        size_t nFeatures = std::min(featureCount, (size_t)weights.cols);
+        return predictOutput(bias + dotCompiledWeights(weights, probeSample, nFeatures));
+    }
+
+    static thread_local std::vector<svmFeature> probeNodes;
+    static thread_local std::vector<double> predictValues;
+    size_t nNodes = featureCount;
+    #if ESVM_USE_LIBLINEAR
+    // probe features beyond the model features would be confused with its constant bias feature (see 'setBiasNode')
+    nNodes = std::min(featureCount, (size_t)esvmModel->nr_feature);
+    #endif/*ESVM_USE_LIBLINEAR*/
+    if (probeNodes.size() < nNodes + 1 + ESVM_BIAS_NODES)
+        probeNodes.resize(nNodes + 1 + ESVM_BIAS_NODES);
+    for (size_t f = 0; f < nNodes; ++f)
+    {
+        probeNodes[f].index = (int)f + 1;       // indexes should be one based
+        probeNodes[f].value = probeSample[f];
+    }
+    #if ESVM_USE_LIBLINEAR
+    if (esvmModel->bias >= 0) {
+        probeNodes[nNodes].index = esvmModel->nr_feature + 1;
+        probeNodes[nNodes++].value = esvmModel->bias;
+    }
+    #endif/*ESVM_USE_LIBLINEAR*/
+    probeNodes[nNodes].index = -1;              // Additional feature value must be (-1,?) to end the vector (see LIBSVM README)
+
+    switch (config.predictMode) {
+        case 0:     // predict values
+            // Obtain decision values directly (instead of predicted label/probability from 'svm_predict'/'svm_predict_probability')
+            // Since the number of decision values of each class combination is calculated with [ nr_class*(nr_class-1)/2 ],
+            // and that we have only 2 classes, we have only one decision value (positive vs. negative)
+            predictValues.resize(esvmModel->nr_class * (esvmModel->nr_class - 1) / 2);
+            svmPredictValues(esvmModel, probeNodes.data(), predictValues.data());
+            return predictValues[0];
+
+        case 1:     // predict
+            // Obtain predicted class
+            return svmPredict(esvmModel, probeNodes.data());
+
+        #if ESVM_USE_LIBSVM
+        case 2:     // predict probability
+            ASSERT_THROW(esvmModel->param.probability, "Cannot predict probability with SVM model without probability option");
+            predictValues.resize(esvmModel->nr_class);
+            svmPredictProbability(esvmModel, probeNodes.data(), predictValues.data());
+            return predictValues[0];
+        #endif/*ESVM_USE_LIBSVM*/
 
-    #endif/*ESVM_PREDICT_MODE*/
+        default:
+            THROW("Unsupported prediction mode: " + std::to_string(config.predictMode));
+    }
+}
+
+/*
+    Predicts the classification value for the specified array of float32 features using the trained ESVM model.
+    The compiled model dot product is computed at the weights precision ('esvmScalar'), otherwise features are widened
+    into a per-thread buffer for the SVM library which only handles double precision feature nodes.
+*/
+double ESVM::predict(const float* probeSample, size_t featureCount) const
+{
+    ASSERT_THROW(isModelTrained(), "Cannot predict with untrained ESVM model");
+
+    if (!isModelCompiled())
+    {
+        static thread_local FeatureVector probeSampleDouble;
+        probeSampleDouble.assign(probeSample, probeSample + featureCount);
+        return predict(probeSampleDouble.data(), featureCount);
+    }
+
+    size_t nFeatures = std::min(featureCount, (size_t)weights.cols);
+    return predictOutput(bias + dotCompiledWeights(weights, probeSample, nFeatures));
+}
+
+/*
+    Validates that the trained model supports the configured prediction mode.
+    Batch predictions check it once before their parallel region, as exceptions cannot propagate out of an OpenMP region
+    (single probe predictions then cannot throw within the region).
+*/
+void ESVM::checkPredictMode_assert() const
+{
+    ASSERT_THROW(isModelTrained(), "Cannot predict with untrained ESVM model");
+    ASSERT_THROW(config.predictMode >= 0 && config.predictMode <= 2, "Unsupported prediction mode: " + std::to_string(config.predictMode));
+    #if ESVM_USE_LIBSVM
+    ASSERT_THROW(!config.usePredictProbability() || isModelCompiled() || esvmModel->param.probability,
+                 "Cannot predict probability with SVM model without probability option");
+    #else/*ESVM_USE_LIBSVM*/
+    ASSERT_THROW(!config.usePredictProbability(), "Probability prediction mode is only supported by LIBSVM");
+    #endif/*ESVM_USE_LIBSVM*/
 }
 
 /*
     Predicts the classification values for the specified list of feature vector samples using the trained ESVM model.
 */
-std::vector<double> ESVM::predict(std::vector<FeatureVector> probeSamples) const
+std::vector<double> ESVM::predict(const std::vector<FeatureVector>& probeSamples) const
 {
-    size_t nPredictions = probeSamples.size();
+    checkPredictMode_assert();
+
+    omp_size_t nPredictions = (omp_size_t)probeSamples.size();
     std::vector<double> outputs(nPredictions);
-    for (size_t p = 0; p < nPredictions; ++p)
+    #pragma omp parallel for if (nPredictions >= ESVM_PREDICT_BATCH_PARALLEL_MIN)
+    for (omp_size_t p = 0; p < nPredictions; ++p)
         outputs[p] = this->predict(probeSamples[p]);
     return outputs;
 }
 
+/*
+    Predicts the classification values for all samples (rows) of a contiguous matrix of features using the trained ESVM model.
+    Samples matrix must be of type 'CV_64F' or 'CV_32F', and 'scores' must be a caller-provided buffer of at least 'rows' values.
+    Probes are predicted in parallel when the batch is large enough to amortize the threads startup.
+*/
+void ESVM::predictBatch(const cv::Mat& probeSamples, double* scores) const
+{
+    checkPredictMode_assert();
+    ASSERT_THROW(probeSamples.type() == CV_64F || probeSamples.type() == CV_32F, "Probe samples matrix must be of type 'CV_64F' or 'CV_32F'");
+    ASSERT_THROW(scores != nullptr || probeSamples.rows == 0, "Output scores buffer must be specified");
+
+    int nPredictions = probeSamples.rows;
+    size_t nFeatures = (size_t)probeSamples.cols;
+    bool isFloat = probeSamples.type() == CV_32F;
+    #pragma omp parallel for if (nPredictions >= ESVM_PREDICT_BATCH_PARALLEL_MIN)
+    for (int p = 0; p < nPredictions; ++p)
+    {
+        if (!isFloat)
+            scores[p] = predict(probeSamples.ptr<double>(p), nFeatures);
+        else
+            scores[p] = predict(probeSamples.ptr<float>(p), nFeatures);
+    }
+}
+
 /*
     Predicts all classification values for each of the feature vector samples within the file using the trained ESVM model.
     The file must be saved in the LIBSVM sample data format.
@@ -1006,23 +2042,128 @@ FeatureVector ESVM::getFeatureVector(svmFeature* features)
 /*
     Converts a feature vector to an array of LIBSVM 'svm_node' / LIBLINEAR 'feature_node'
 */
-svmFeature* ESVM::getFeatureNodes(FeatureVector features)
+svmFeature* ESVM::getFeatureNodes(const FeatureVector& features)
 {
-    return getFeatureNodes(&features[0], (int)features.size());
+    return getFeatureNodes(features.data(), (int)features.size());
 }
 
 /*
     Converts an array of 'double' features to an array of LIBSVM 'svm_node' / LIBLINEAR 'feature_node'
+    LIBLINEAR nodes are followed by the constant bias feature node (see 'setBiasNode').
 */
-svmFeature* ESVM::getFeatureNodes(double* features, int featureCount)
+svmFeature* ESVM::getFeatureNodes(const double* features, int featureCount)
 {
-    svmFeature* fv = Malloc(svmFeature, featureCount + 1);
+    svmFeature* fv = Malloc(svmFeature, featureCount + 1 + ESVM_BIAS_NODES);
     for (int f = 0; f < featureCount; ++f)
     {
         fv[f].index = f + 1;        // indexes should be one based
         fv[f].value = features[f];
     }
-    fv[featureCount].index = -1;    // Additional feature value must be (-1,?) to end the vector (see LIBSVM README)
+    fv[setBiasNode(fv, featureCount)].index = -1;   // Additional feature value must be (-1,?) to end the vector (see LIBSVM README)
+    return fv;
+}
+
+/*
+    Sets the constant bias feature node following the 'featureCount' feature nodes when required by the SVM library and
+    returns the position of the next node. LIBLINEAR learns the bias term of the decision function as the weight of an
+    additional feature of constant value ('ESVM_LIBLINEAR_BIAS') that must be present in every sample (see LIBLINEAR README),
+    while LIBSVM obtains it directly as '-rho' (no node is set).
+*/
+int ESVM::setBiasNode(svmFeature* nodes, int featureCount)
+{
+    #if ESVM_USE_LIBLINEAR
+    nodes[featureCount].index = featureCount + 1;
+    nodes[featureCount].value = ESVM_LIBLINEAR_BIAS;
+    #endif/*ESVM_USE_LIBLINEAR*/
+    return featureCount + ESVM_BIAS_NODES;
+}
+
+/*
+    Converts all feature vectors to LIBSVM 'svm_node' / LIBLINEAR 'feature_node' arrays allocated in a single contiguous block
+    Returned rows must be deallocated with 'destroyFeatureNodes'
+*/
+svmFeature** ESVM::makeFeatureNodes(const std::vector<FeatureVector>& samples)
+{
+    int nSamples = (int)samples.size();
+    ASSERT_THROW(nSamples > 0, "Feature nodes conversion requires at least one sample");
+
+    size_t nNodes = 0;
+    for (int s = 0; s < nSamples; ++s) {
+        #if ESVM_USE_LIBLINEAR
+        ASSERT_THROW(samples[s].size() == samples[0].size(), "LIBLINEAR samples must all have the same feature count for the bias node");
+        #endif/*ESVM_USE_LIBLINEAR*/
+        nNodes += samples[s].size() + 1 + ESVM_BIAS_NODES;
+    }
+
+    svmFeature** rows = Malloc(svmFeature*, nSamples);
+    rows[0] = Malloc(svmFeature, nNodes);
+    for (int s = 1; s < nSamples; ++s)
+        rows[s] = rows[s - 1] + samples[s - 1].size() + 1 + ESVM_BIAS_NODES;
+
+    #ifndef ESVM_DEBUG
+    #pragma omp parallel for
+    #endif
+    for (int s = 0; s < nSamples; ++s)
+    {
+        int nFeatures = (int)samples[s].size();
+        for (int f = 0; f < nFeatures; ++f) {
+            rows[s][f].index = f + 1;       // indexes should be one based
+            rows[s][f].value = samples[s][f];
+        }
+        rows[s][setBiasNode(rows[s], nFeatures)].index = -1;
+    }
+    return rows;
+}
+
+/*
+    Converts all rows of a 'CV_64F' samples matrix to feature nodes allocated in a single contiguous block
+    Returned rows must be deallocated with 'destroyFeatureNodes'
+*/
+svmFeature** ESVM::makeFeatureNodes(const cv::Mat& samples)
+{
+    ASSERT_THROW(samples.type() == CV_64F, "Samples matrix must be of type 'CV_64F' for feature nodes conversion");
+    int nSamples = samples.rows;
+    int nFeatures = samples.cols;
+    ASSERT_THROW(nSamples > 0, "Feature nodes conversion requires at least one sample");
+
+    svmFeature** rows = Malloc(svmFeature*, nSamples);
+    rows[0] = Malloc(svmFeature, (size_t)nSamples * (size_t)(nFeatures + 1 + ESVM_BIAS_NODES));
+    for (int s = 1; s < nSamples; ++s)
+        rows[s] = rows[s - 1] + nFeatures + 1 + ESVM_BIAS_NODES;
+
+    #ifndef ESVM_DEBUG
+    #pragma omp parallel for
+    #endif
+    for (int s = 0; s < nSamples; ++s)
+    {
+        const double* sample = samples.ptr<double>(s);
+        for (int f = 0; f < nFeatures; ++f) {
+            rows[s][f].index = f + 1;       // indexes should be one based
+            rows[s][f].value = sample[f];
+        }
+        rows[s][setBiasNode(rows[s], nFeatures)].index = -1;
+    }
+    return rows;
+}
+
+// Deallocates contiguous feature nodes rows generated by 'makeFeatureNodes' or 'makePrecomputedKernel'
+void ESVM::destroyFeatureNodes(svmFeature*** rows)
+{
+    if (rows != nullptr && *rows != nullptr) {
+        FreeNull((*rows)[0]);
+        FreeNull(*rows);
+    }
+}
+
+/*
+    Copies an array of LIBSVM 'svm_node' / LIBLINEAR 'feature_node' terminated by (-1,?) to a newly allocated array
+*/
+svmFeature* ESVM::copyFeatureNodes(const svmFeature* features)
+{
+    int nNodes = 0;                             // contains +1 for (-1,?)
+    while (features[nNodes++].index != -1);
+    svmFeature* fv = Malloc(svmFeature, nNodes);
+    std::copy(features, features + nNodes, fv);
     return fv;
 }
 
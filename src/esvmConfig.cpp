@@ -0,0 +1,43 @@
+#include "esvmConfig.h"
+#include "esvmTypes.h"
+
+#include "CommonCpp.h"
+
+#include <string>
+
+//namespace esvm {
+
+/*
+    Verifies that every mode of the configuration is supported.
+*/
+void esvmConfig::validate() const
+{
+    ASSERT_THROW(predictMode >= 0 && predictMode <= 2, "Unsupported prediction mode: " + std::to_string(predictMode));
+    #if ESVM_USE_LIBLINEAR
+    ASSERT_THROW(!usePredictProbability(), "Probability prediction mode is only supported by LIBSVM");
+    #endif/*ESVM_USE_LIBLINEAR*/
+    ASSERT_THROW(weightsMode >= 0 && weightsMode <= 4, "Unsupported weights mode: " + std::to_string(weightsMode));
+    ASSERT_THROW(solverMode >= 0 && solverMode <= 1, "Unsupported solver mode: " + std::to_string(solverMode));
+    #if ESVM_USE_LIBSVM
+    ASSERT_THROW(solverMode == 0, "Primal solver mode is only supported by LIBLINEAR");
+    #endif/*ESVM_USE_LIBSVM*/
+    ASSERT_THROW(!warmStart || solverMode == 1, "Warm start training requires the LIBLINEAR primal solver mode");
+    ASSERT_THROW(!useHardNegativeMining() || miningBatch > 0, "Hard negative mining must add at least one negative per iteration");
+    ASSERT_THROW(roiPreprocessMode >= 0 && roiPreprocessMode <= 2, "Unsupported ROI pre-processing mode: " + std::to_string(roiPreprocessMode));
+    ASSERT_THROW(roiCropRatio > 0 && roiCropRatio <= 1, "ROI crop ratio must be within ]0,1]");
+    ASSERT_THROW(featureNormMode >= 0 && featureNormMode <= 8, "Unsupported feature normalization mode: " + std::to_string(featureNormMode));
+    ASSERT_THROW(scoreNormMode >= 0 && scoreNormMode <= 6, "Unsupported score normalization mode: " + std::to_string(scoreNormMode));
+    ASSERT_THROW(rsmCount == 0 || rsmFeatures > 0, "Random subspaces must contain at least one feature");
+}
+
+/*
+    Subspace ESVM of a patch are folded into a single patch model for scoring (weights scattered back to the patch feature space
+    and summed for average fusion) when each ESVM output is affine in its decision value, that is when predicting raw values
+    with pre-fusion score normalization either disabled or not clipped (otherwise weights are only scattered, not summed)
+*/
+bool esvmConfig::isFoldedRSM() const
+{
+    return useRandomSubspaces() && predictMode == 0 && (!isScoreNormPreFusion() || !scoreNormClip);
+}
+
+//} // namespace esvm
@@ -340,12 +340,11 @@ int proc_createNegativesSampleFiles()
         // write resulting sample files gradually (per patch) to distribute memory allocation
         std::string strPatch = "-patch" + std::to_string(p);
         #if PROC_ESVM_GENERATE_SAMPLE_FILES_BINARY
-            std::string h = ESVM_BINARY_HEADER_SAMPLES;
-            DataFile::writeSampleDataFile("negatives-raw"                      + strPatch + ".bin",  fvNegRaw[p],                negClass, BINARY, h);
-            DataFile::writeSampleDataFile("negatives-normPatch-minmax-overAll" + strPatch + ".bin",  fvNegMinMaxPatchOverAll[p], negClass, BINARY, h);
-            DataFile::writeSampleDataFile("negatives-normPatch-zcore-overAll"  + strPatch + ".bin",  fvNegZScorePatchOverAll[p], negClass, BINARY, h);
-            DataFile::writeSampleDataFile("negatives-normPatch-minmax-perFeat" + strPatch + ".bin",  fvNegMinMaxPatchPerFeat[p], negClass, BINARY, h);
-            DataFile::writeSampleDataFile("negatives-normPatch-zcore-perFeat"  + strPatch + ".bin",  fvNegZScorePatchPerFeat[p], negClass, BINARY, h);
+            ESVM::writeSampleDataFile("negatives-raw"                      + strPatch + ".bin",  fvNegRaw[p],                negClass, BINARY);
+            ESVM::writeSampleDataFile("negatives-normPatch-minmax-overAll" + strPatch + ".bin",  fvNegMinMaxPatchOverAll[p], negClass, BINARY);
+            ESVM::writeSampleDataFile("negatives-normPatch-zcore-overAll"  + strPatch + ".bin",  fvNegZScorePatchOverAll[p], negClass, BINARY);
+            ESVM::writeSampleDataFile("negatives-normPatch-minmax-perFeat" + strPatch + ".bin",  fvNegMinMaxPatchPerFeat[p], negClass, BINARY);
+            ESVM::writeSampleDataFile("negatives-normPatch-zcore-perFeat"  + strPatch + ".bin",  fvNegZScorePatchPerFeat[p], negClass, BINARY);
         #endif/*PROC_ESVM_GENERATE_SAMPLE_FILES_BINARY*/
         #if PROC_ESVM_GENERATE_SAMPLE_FILES_LIBSVM
             DataFile::writeSampleDataFile("negatives-raw"                      + strPatch + ".data", fvNegRaw[p],                negClass, LIBSVM);
@@ -394,11 +393,10 @@ int proc_createNegativesSampleFiles()
         // write resulting sample files gradually (per patch) to distribute memory allocation
         std::string strPatch = "-patch" + std::to_string(p);
         #if PROC_ESVM_GENERATE_SAMPLE_FILES_BINARY
-            std::string h = ESVM_BINARY_HEADER_SAMPLES;
-            DataFile::writeSampleDataFile("negatives-normROI-minmax-overAll" + strPatch + ".bin",  fvNegMinMaxROIOverAll[p], negClass, BINARY, h);
-            DataFile::writeSampleDataFile("negatives-normROI-zcore-overAll"  + strPatch + ".bin",  fvNegZScoreROIOverAll[p], negClass, BINARY, h);
-            DataFile::writeSampleDataFile("negatives-normROI-minmax-perFeat" + strPatch + ".bin",  fvNegMinMaxROIPerFeat[p], negClass, BINARY, h);
-            DataFile::writeSampleDataFile("negatives-normROI-zcore-perFeat"  + strPatch + ".bin",  fvNegZScoreROIPerFeat[p], negClass, BINARY, h);
+            ESVM::writeSampleDataFile("negatives-normROI-minmax-overAll" + strPatch + ".bin",  fvNegMinMaxROIOverAll[p], negClass, BINARY);
+            ESVM::writeSampleDataFile("negatives-normROI-zcore-overAll"  + strPatch + ".bin",  fvNegZScoreROIOverAll[p], negClass, BINARY);
+            ESVM::writeSampleDataFile("negatives-normROI-minmax-perFeat" + strPatch + ".bin",  fvNegMinMaxROIPerFeat[p], negClass, BINARY);
+            ESVM::writeSampleDataFile("negatives-normROI-zcore-perFeat"  + strPatch + ".bin",  fvNegZScoreROIPerFeat[p], negClass, BINARY);
         #endif/*PROC_ESVM_GENERATE_SAMPLE_FILES_BINARY*/
         #if PROC_ESVM_GENERATE_SAMPLE_FILES_LIBSVM
             DataFile::writeSampleDataFile("negatives-normROI-minmax-overAll" + strPatch + ".data", fvNegMinMaxROIOverAll[p], negClass, LIBSVM);
@@ -0,0 +1,249 @@
+#include "esvmDot.h"
+
+#include "generic.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define ESVM_DOT_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// per-function instruction set for GCC/Clang (no global '-mavx2' required), MSVC accepts all intrinsics as is
+#if defined(ESVM_DOT_X86) && (defined(__GNUC__) || defined(__clang__))
+#define ESVM_DOT_TARGET(isa) __attribute__((target(isa)))
+#else
+#define ESVM_DOT_TARGET(isa)
+#endif
+
+//namespace esvm {
+
+/* --- scalar kernels --- */
+
+template<typename T>
+static inline T dotScalar(const T* a, const T* b, size_t n)
+{
+    T sum = 0;
+    for (size_t i = 0; i < n; ++i)
+        sum += a[i] * b[i];
+    return sum;
+}
+
+#ifdef ESVM_DOT_X86
+
+/* --- SSE2 kernels --- */
+
+ESVM_DOT_TARGET("sse2")
+static double dotSSE2(const double* a, const double* b, size_t n)
+{
+    __m128d sum0 = _mm_setzero_pd(), sum1 = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        sum0 = _mm_add_pd(sum0, _mm_mul_pd(_mm_loadu_pd(a + i),     _mm_loadu_pd(b + i)));
+        sum1 = _mm_add_pd(sum1, _mm_mul_pd(_mm_loadu_pd(a + i + 2), _mm_loadu_pd(b + i + 2)));
+    }
+    double lanes[2];
+    _mm_storeu_pd(lanes, _mm_add_pd(sum0, sum1));
+    return lanes[0] + lanes[1] + dotScalar(a + i, b + i, n - i);
+}
+
+ESVM_DOT_TARGET("sse2")
+static float dotSSE2(const float* a, const float* b, size_t n)
+{
+    __m128 sum0 = _mm_setzero_ps(), sum1 = _mm_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(a + i),     _mm_loadu_ps(b + i)));
+        sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, _mm_add_ps(sum0, sum1));
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + dotScalar(a + i, b + i, n - i);
+}
+
+/* --- AVX2 + FMA kernels --- */
+
+ESVM_DOT_TARGET("avx2,fma")
+static double dotAVX2(const double* a, const double* b, size_t n)
+{
+    __m256d sum0 = _mm256_setzero_pd(), sum1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        sum0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i),     _mm256_loadu_pd(b + i),     sum0);
+        sum1 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4), sum1);
+    }
+    double lanes[4];
+    _mm256_storeu_pd(lanes, _mm256_add_pd(sum0, sum1));
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + dotScalar(a + i, b + i, n - i);
+}
+
+ESVM_DOT_TARGET("avx2,fma")
+static float dotAVX2(const float* a, const float* b, size_t n)
+{
+    __m256 sum0 = _mm256_setzero_ps(), sum1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i),     _mm256_loadu_ps(b + i),     sum0);
+        sum1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), sum1);
+    }
+    float lanes[8];
+    _mm256_storeu_ps(lanes, _mm256_add_ps(sum0, sum1));
+    float sum = 0;
+    for (int l = 0; l < 8; ++l)
+        sum += lanes[l];
+    return sum + dotScalar(a + i, b + i, n - i);
+}
+
+/* --- AVX-512F kernels --- */
+
+ESVM_DOT_TARGET("avx512f")
+static double dotAVX512(const double* a, const double* b, size_t n)
+{
+    __m512d sum0 = _mm512_setzero_pd(), sum1 = _mm512_setzero_pd();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        sum0 = _mm512_fmadd_pd(_mm512_loadu_pd(a + i),     _mm512_loadu_pd(b + i),     sum0);
+        sum1 = _mm512_fmadd_pd(_mm512_loadu_pd(a + i + 8), _mm512_loadu_pd(b + i + 8), sum1);
+    }
+    double lanes[8];
+    _mm512_storeu_pd(lanes, _mm512_add_pd(sum0, sum1));
+    double sum = 0;
+    for (int l = 0; l < 8; ++l)
+        sum += lanes[l];
+    return sum + dotScalar(a + i, b + i, n - i);
+}
+
+ESVM_DOT_TARGET("avx512f")
+static float dotAVX512(const float* a, const float* b, size_t n)
+{
+    __m512 sum0 = _mm512_setzero_ps(), sum1 = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        sum0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i),      _mm512_loadu_ps(b + i),      sum0);
+        sum1 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i + 16), _mm512_loadu_ps(b + i + 16), sum1);
+    }
+    float lanes[16];
+    _mm512_storeu_ps(lanes, _mm512_add_ps(sum0, sum1));
+    float sum = 0;
+    for (int l = 0; l < 16; ++l)
+        sum += lanes[l];
+    return sum + dotScalar(a + i, b + i, n - i);
+}
+
+#ifdef _MSC_VER
+// CPUID feature bits with OS support of the extended registers state (XGETBV)
+static bool cpuSupports(DotKernel kernel)
+{
+    int info[4];
+    __cpuid(info, 0);
+    int nIds = info[0];
+    __cpuid(info, 1);
+    bool sse2 = (info[3] & (1 << 26)) != 0;
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool fma = (info[2] & (1 << 12)) != 0;
+    if (kernel == DOT_SSE2)
+        return sse2;
+    if (!osxsave || nIds < 7)
+        return false;
+    unsigned long long xcr0 = _xgetbv(0);
+    __cpuidex(info, 7, 0);
+    if (kernel == DOT_AVX2)
+        return fma && (info[1] & (1 << 5)) != 0 && (xcr0 & 0x06) == 0x06;
+    if (kernel == DOT_AVX512)
+        return (info[1] & (1 << 16)) != 0 && (xcr0 & 0xE6) == 0xE6;
+    return false;
+}
+#else
+static bool cpuSupports(DotKernel kernel)
+{
+    __builtin_cpu_init();
+    switch (kernel) {
+        case DOT_SSE2:      return __builtin_cpu_supports("sse2");
+        case DOT_AVX2:      return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+        case DOT_AVX512:    return __builtin_cpu_supports("avx512f");
+        default:            return false;
+    }
+}
+#endif/*_MSC_VER*/
+
+#endif/*ESVM_DOT_X86*/
+
+// Verifies if the specified kernel can be executed by the running CPU
+bool isDotKernelSupported(DotKernel kernel)
+{
+    if (kernel == DOT_SCALAR)
+        return true;
+    #ifdef ESVM_DOT_X86
+    return cpuSupports(kernel);
+    #else
+    return false;
+    #endif/*ESVM_DOT_X86*/
+}
+
+// Best dot product kernel supported by the running CPU, detected once (scalar if 'ESVM_USE_SIMD_DOT' is disabled)
+DotKernel getDotKernel()
+{
+    static const DotKernel kernel = []() {
+        #if ESVM_USE_SIMD_DOT
+        for (DotKernel k : { DOT_AVX512, DOT_AVX2, DOT_SSE2 })
+            if (isDotKernelSupported(k))
+                return k;
+        #endif/*ESVM_USE_SIMD_DOT*/
+        return DOT_SCALAR;
+    }();
+    return kernel;
+}
+
+std::string getDotKernelName(DotKernel kernel)
+{
+    switch (kernel) {
+        case DOT_SCALAR:    return "SCALAR";
+        case DOT_SSE2:      return "SSE2";
+        case DOT_AVX2:      return "AVX2";
+        case DOT_AVX512:    return "AVX512";
+        default:            return "UNKNOWN";
+    }
+}
+
+double dotProduct(const double* a, const double* b, size_t n)
+{
+    return dotProduct(a, b, n, getDotKernel());
+}
+
+float dotProduct(const float* a, const float* b, size_t n)
+{
+    return dotProduct(a, b, n, getDotKernel());
+}
+
+/*
+    Dot product of two dense arrays using the specified kernel (must be supported by the running CPU)
+    Kernels accumulate in multiple lanes, results can differ from the scalar kernel by floating point rounding.
+*/
+double dotProduct(const double* a, const double* b, size_t n, DotKernel kernel)
+{
+    switch (kernel) {
+        #ifdef ESVM_DOT_X86
+        case DOT_SSE2:      return dotSSE2(a, b, n);
+        case DOT_AVX2:      return dotAVX2(a, b, n);
+        case DOT_AVX512:    return dotAVX512(a, b, n);
+        #endif/*ESVM_DOT_X86*/
+        case DOT_SCALAR:    return dotScalar(a, b, n);
+        default:            THROW("Unsupported dot product kernel: " + getDotKernelName(kernel));
+    }
+}
+
+float dotProduct(const float* a, const float* b, size_t n, DotKernel kernel)
+{
+    switch (kernel) {
+        #ifdef ESVM_DOT_X86
+        case DOT_SSE2:      return dotSSE2(a, b, n);
+        case DOT_AVX2:      return dotAVX2(a, b, n);
+        case DOT_AVX512:    return dotAVX512(a, b, n);
+        #endif/*ESVM_DOT_X86*/
+        case DOT_SCALAR:    return dotScalar(a, b, n);
+        default:            THROW("Unsupported dot product kernel: " + getDotKernelName(kernel));
+    }
+}
+
+//} // namespace esvm
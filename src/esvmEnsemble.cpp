@@ -1,29 +1,41 @@
 #include "esvmEnsemble.h"
 #include "esvmOptions.h"
+#include "esvmMappedSamples.h"
+#include "esvmDot.h"
 
 #include "CommonCpp.h"
 
+#include <cfloat>
+#include <cmath>
+#include <cstring>
 #include <fstream>
+#include <functional>
+#include <queue>
 #include <sstream>
 
 //namespace esvm {
 
 /*
-    Initializes an Ensemble of ESVM (EoESVM)
+    Initializes an Ensemble of ESVM (EoESVM) with the specified processing modes configuration
 */
 esvmEnsemble::esvmEnsemble(const std::vector<std::vector<cv::Mat> >& positiveROIs, const std::string referenceFileDirectory,
-                           const std::vector<std::string>& positiveIDs, const std::vector<std::vector<cv::Mat> >& additionalNegativeROIs)
+                           const std::vector<std::string>& positiveIDs, const std::vector<std::vector<cv::Mat> >& additionalNegativeROIs,
+                           const esvmConfig& config)
 {
+    setConfig(config);
     setConstants(referenceFileDirectory);
+    negativesDirectory = referenceFileDirectory;
     size_t nPositives = positiveROIs.size();
     size_t nPatches = getPatchCount();
+    std::shared_ptr<Models> updatedModels = std::make_shared<Models>();
+    Models& models = *updatedModels;
     if (positiveIDs.size() == nPositives)
-        enrolledPositiveIDs = positiveIDs;
+        models.enrolledPositiveIDs = positiveIDs;
     else
     {
-        enrolledPositiveIDs = std::vector<std::string>(nPositives);
+        models.enrolledPositiveIDs = std::vector<std::string>(nPositives);
         for (size_t pos = 0; pos < nPositives; ++pos)
-            enrolledPositiveIDs[pos] = std::to_string(pos);
+            models.enrolledPositiveIDs[pos] = std::to_string(pos);
     }
 
     // positive samples
@@ -36,12 +48,8 @@ esvmEnsemble::esvmEnsemble(const std::vector<std::vector<cv::Mat> >& positiveROI
     size_t nAdditionalNegatives = additionalNegativeROIs.size();
 
     // Ensemble of exemplar-SVM
-    #if ESVM_RANDOM_SUBSPACE_METHOD > 0
-    size_t dimsESVM[2]{ nPatches * ESVM_RANDOM_SUBSPACE_METHOD, nPositives };
-    #else
-    size_t dimsESVM[2]{ nPatches, nPositives };
-    #endif/*ESVM_RANDOM_SUBSPACE_METHOD*/
-    EoESVM = xstd::mvector<2, ESVM>(dimsESVM);                          // [patch|random-subspace][positive](ESVM)
+    size_t dimsESVM[2]{ nPatches * getSubspaceCount(), nPositives };
+    models.EoESVM = xstd::mvector<2, std::shared_ptr<const ESVM> >(dimsESVM);  // [patch|random-subspace][positive](ESVM)
 
     // load positive target still images, extract features and normalize
     for (size_t pos = 0; pos < nPositives; ++pos)
@@ -50,37 +58,12 @@ esvmEnsemble::esvmEnsemble(const std::vector<std::vector<cv::Mat> >& positiveROI
         size_t nRepresentations = positiveROIs[pos].size();
         for (size_t p = 0; p < nPatches; ++p)
             posSamples[p][pos] = std::vector<FeatureVector>(nRepresentations);
-        for (size_t r = 0; r < nRepresentations; ++r)
+        #pragma omp parallel for schedule(dynamic, 1) if(nRepresentations > 1)
+        for (omp_size_t r = 0; r < (omp_size_t)nRepresentations; ++r)
         {
-            // apply pre-processing operation as required
-            #if ESVM_ROI_PREPROCESS_MODE == 2
-            cv::Mat roi = imCropByRatio(positiveROIs[pos][r], ESVM_ROI_CROP_RATIO, CENTER_MIDDLE);
-            #else
-            cv::Mat roi = positiveROIs[pos][r];
-            #endif/*ESVM_ROI_PREPROCESS_MODE*/
-
-            std::vector<cv::Mat> patches = imPreprocess(roi, imageSize, patchCounts, ESVM_USE_HIST_EQUAL);
+            std::vector<FeatureVector> patchFeatures = computeFeatures(positiveROIs[pos][r]);
             for (size_t p = 0; p < nPatches; ++p)
-            {
-                posSamples[p][pos][r] = hog.compute(patches[p]);
-                #if   ESVM_FEATURE_NORM_MODE == 1
-                posSamples[p][pos][r] = normalizeOverAll(MIN_MAX,    posSamples[p][pos][r], hogMin,     hogMax,       ESVM_FEATURE_NORM_CLIP);
-                #elif ESVM_FEATURE_NORM_MODE == 2
-                posSamples[p][pos][r] = normalizeOverAll(Z_SCORE,    posSamples[p][pos][r], hogMean,    hogStdDev,    ESVM_FEATURE_NORM_CLIP);
-                #elif ESVM_FEATURE_NORM_MODE == 3
-                posSamples[p][pos][r] = normalizePerFeature(MIN_MAX, posSamples[p][pos][r], hogMin,     hogMax,       ESVM_FEATURE_NORM_CLIP);
-                #elif ESVM_FEATURE_NORM_MODE == 4
-                posSamples[p][pos][r] = normalizePerFeature(Z_SCORE, posSamples[p][pos][r], hogMean,    hogStdDev,    ESVM_FEATURE_NORM_CLIP);
-                #elif ESVM_FEATURE_NORM_MODE == 5
-                posSamples[p][pos][r] = normalizeOverAll(MIN_MAX,    posSamples[p][pos][r], hogMin[p],  hogMax[p],    ESVM_FEATURE_NORM_CLIP);
-                #elif ESVM_FEATURE_NORM_MODE == 6
-                posSamples[p][pos][r] = normalizeOverAll(Z_SCORE,    posSamples[p][pos][r], hogMean[p], hogStdDev[p], ESVM_FEATURE_NORM_CLIP);
-                #elif ESVM_FEATURE_NORM_MODE == 7
-                posSamples[p][pos][r] = normalizePerFeature(MIN_MAX, posSamples[p][pos][r], hogMin[p],  hogMax[p],    ESVM_FEATURE_NORM_CLIP);
-                #elif ESVM_FEATURE_NORM_MODE == 8
-                posSamples[p][pos][r] = normalizePerFeature(Z_SCORE, posSamples[p][pos][r], hogMean[p], hogStdDev[p], ESVM_FEATURE_NORM_CLIP);
-                #endif/*ESVM_FEATURE_NORM_MODE*/
-            }
+                posSamples[p][pos][r] = patchFeatures[p];
         }
 
         // extract features and normalize from additional negatives if specified and matching positives to enroll
@@ -89,118 +72,769 @@ esvmEnsemble::esvmEnsemble(const std::vector<std::vector<cv::Mat> >& positiveROI
             size_t nNegatives = additionalNegativeROIs[pos].size();
             for (size_t p = 0; p < nPatches; ++p)
                 negSamples[p][pos] = std::vector<FeatureVector>(nNegatives);
-            for (size_t neg = 0; neg < nNegatives; ++neg)
+            #pragma omp parallel for schedule(dynamic, 1) if(nNegatives > 1)
+            for (omp_size_t neg = 0; neg < (omp_size_t)nNegatives; ++neg)
             {
-                // apply pre-processing operation as required
-                #if ESVM_ROI_PREPROCESS_MODE == 2
-                cv::Mat roi = imCropByRatio(additionalNegativeROIs[pos][neg], ESVM_ROI_CROP_RATIO, CENTER_MIDDLE);
-                #else
-                cv::Mat roi = additionalNegativeROIs[pos][neg];
-                #endif/*ESVM_ROI_PREPROCESS_MODE*/
-
-                std::vector<cv::Mat> patches = imPreprocess(roi, imageSize, patchCounts, ESVM_USE_HIST_EQUAL);
+                std::vector<FeatureVector> patchFeatures = computeFeatures(additionalNegativeROIs[pos][neg]);
                 for (size_t p = 0; p < nPatches; ++p)
-                {
-                    negSamples[p][pos][neg] = hog.compute(patches[p]);
-                    #if   ESVM_FEATURE_NORM_MODE == 1
-                    negSamples[p][pos][neg] = normalizeOverAll(MIN_MAX,    negSamples[p][pos][neg], hogMin,     hogMax,       ESVM_FEATURE_NORM_CLIP);
-                    #elif ESVM_FEATURE_NORM_MODE == 2
-                    negSamples[p][pos][neg] = normalizeOverAll(Z_SCORE,    negSamples[p][pos][neg], hogMean,    hogStdDev,    ESVM_FEATURE_NORM_CLIP);
-                    #elif ESVM_FEATURE_NORM_MODE == 3
-                    negSamples[p][pos][neg] = normalizePerFeature(MIN_MAX, negSamples[p][pos][neg], hogMin,     hogMax,       ESVM_FEATURE_NORM_CLIP);
-                    #elif ESVM_FEATURE_NORM_MODE == 4
-                    negSamples[p][pos][neg] = normalizePerFeature(Z_SCORE, negSamples[p][pos][neg], hogMean,    hogStdDev,    ESVM_FEATURE_NORM_CLIP);
-                    #elif ESVM_FEATURE_NORM_MODE == 5
-                    negSamples[p][pos][neg] = normalizeOverAll(MIN_MAX,    negSamples[p][pos][neg], hogMin[p],  hogMax[p],    ESVM_FEATURE_NORM_CLIP);
-                    #elif ESVM_FEATURE_NORM_MODE == 6
-                    negSamples[p][pos][neg] = normalizeOverAll(Z_SCORE,    negSamples[p][pos][neg], hogMean[p], hogStdDev[p], ESVM_FEATURE_NORM_CLIP);
-                    #elif ESVM_FEATURE_NORM_MODE == 7
-                    negSamples[p][pos][neg] = normalizePerFeature(MIN_MAX, negSamples[p][pos][neg], hogMin[p],  hogMax[p],    ESVM_FEATURE_NORM_CLIP);
-                    #elif ESVM_FEATURE_NORM_MODE == 8
-                    negSamples[p][pos][neg] = normalizePerFeature(Z_SCORE, negSamples[p][pos][neg], hogMean[p], hogStdDev[p], ESVM_FEATURE_NORM_CLIP);
-                    #endif/*ESVM_FEATURE_NORM_MODE*/
-                }
+                    negSamples[p][pos][neg] = patchFeatures[p];
             }
         }
     }
 
+    trainModels(models, posSamples, negSamples, 0);
+    packModels(models);
+    publishModels(updatedModels);
+}
+
+
+/*
+    Enrolls a new individual in the ensemble by training only its ESVM of every patch/subspace against the pre-generated
+    negatives (and optional additional negatives), the ESVM of already enrolled individuals are left untouched.
+*/
+void esvmEnsemble::enroll(const std::string& positiveID, const std::vector<cv::Mat>& positiveROIs, const std::vector<cv::Mat>& additionalNegativeROIs)
+{
+    ASSERT_THROW(!positiveROIs.empty(), "Enrollment requires at least one positive ROI");
+    ASSERT_THROW(!getModels()->EoESVM.empty(), "Enrollment requires an initialized ensemble");
+
+    // extract features and normalize from positive and additional negative ROIs
+    size_t nPatches = getPatchCount();
+    size_t dimsSamples[3]{ nPatches, 1, 0 };
+    xstd::mvector<3, FeatureVector> posSamples(dimsSamples);            // [patch][1][representation](FeatureVector)
+    xstd::mvector<3, FeatureVector> negSamples(dimsSamples);            // [patch][1][negatives](FeatureVector)
+    for (size_t p = 0; p < nPatches; ++p) {
+        posSamples[p][0] = std::vector<FeatureVector>(positiveROIs.size());
+        negSamples[p][0] = std::vector<FeatureVector>(additionalNegativeROIs.size());
+    }
+    #pragma omp parallel for schedule(dynamic, 1) if(positiveROIs.size() > 1)
+    for (omp_size_t r = 0; r < (omp_size_t)positiveROIs.size(); ++r) {
+        std::vector<FeatureVector> patchFeatures = computeFeatures(positiveROIs[r]);
+        for (size_t p = 0; p < nPatches; ++p)
+            posSamples[p][0][r] = patchFeatures[p];
+    }
+    #pragma omp parallel for schedule(dynamic, 1) if(additionalNegativeROIs.size() > 1)
+    for (omp_size_t neg = 0; neg < (omp_size_t)additionalNegativeROIs.size(); ++neg) {
+        std::vector<FeatureVector> patchFeatures = computeFeatures(additionalNegativeROIs[neg]);
+        for (size_t p = 0; p < nPatches; ++p)
+            negSamples[p][0][neg] = patchFeatures[p];
+    }
+
+    // append the new positive column to an updated copy of the models and train its ESVM in place (published models are
+    // left untouched if training fails), concurrent predictions keep using the current snapshot until published
+    std::lock_guard<std::mutex> lock(*updateMutex);
+    std::shared_ptr<Models> updatedModels = std::make_shared<Models>(*getModels());
+    Models& models = *updatedModels;
+    ASSERT_THROW(std::find(models.enrolledPositiveIDs.begin(), models.enrolledPositiveIDs.end(), positiveID) == models.enrolledPositiveIDs.end(),
+                 "Positive ID '" + positiveID + "' is already enrolled in the ensemble");
+    size_t positiveIndex = models.enrolledPositiveIDs.size();
+    models.enrolledPositiveIDs.push_back(positiveID);
+    for (size_t svm = 0; svm < models.EoESVM.size(); ++svm)
+        models.EoESVM[svm].push_back(nullptr);
+    trainModels(models, posSamples, negSamples, positiveIndex);
+    packModels(models);
+    publishModels(updatedModels);
+}
+
+/*
+    Removes an enrolled individual and its ESVM of every patch/subspace from the ensemble.
+    Returns false if the positive ID is not enrolled.
+*/
+bool esvmEnsemble::remove(const std::string& positiveID)
+{
+    std::lock_guard<std::mutex> lock(*updateMutex);
+    std::shared_ptr<Models> updatedModels = std::make_shared<Models>(*getModels());
+    Models& models = *updatedModels;
+    auto itID = std::find(models.enrolledPositiveIDs.begin(), models.enrolledPositiveIDs.end(), positiveID);
+    if (itID == models.enrolledPositiveIDs.end())
+        return false;
+
+    size_t positiveIndex = (size_t)(itID - models.enrolledPositiveIDs.begin());
+    models.enrolledPositiveIDs.erase(itID);
+    for (size_t svm = 0; svm < models.EoESVM.size(); ++svm)
+        models.EoESVM[svm].erase(models.EoESVM[svm].begin() + positiveIndex);
+    packModels(models);
+    publishModels(updatedModels);
+    return true;
+}
+
+/*
+    Publishes updated models for all subsequent predictions, predictions in progress complete with their previous snapshot.
+*/
+void esvmEnsemble::publishModels(const std::shared_ptr<const Models>& models)
+{
+    std::atomic_store(&modelsSnapshot, models);
+}
+
+/*
+    Trains the ESVM of all patches/subspaces for the positives samples [patch][positive][representation] against their
+    additional negatives [patch][positive][negative] and the pre-generated negatives files. Trained ESVM are assigned to
+    the ensemble columns starting at 'positiveOffset', which must already exist along with corresponding positive IDs.
+*/
+void esvmEnsemble::trainModels(Models& models, xstd::mvector<3, FeatureVector>& posSamples, xstd::mvector<3, FeatureVector>& negSamples,
+                               size_t positiveOffset) const
+{
+    size_t nPositives = posSamples.empty() ? 0 : posSamples[0].size();
+    size_t nPatches = getPatchCount();
+    ASSERT_THROW(posSamples.size() == nPatches && negSamples.size() == nPatches, "Training samples must be specified for every patch");
+    ASSERT_THROW(positiveOffset + nPositives <= models.enrolledPositiveIDs.size(), "Trained positives must have corresponding ensemble columns");
+    ASSERT_THROW(!negativesDirectory.empty(), "Negatives directory must be specified to train ESVM");
+
     // training
-    for (size_t p = 0; p < nPatches; ++p)
-    {
-        /* note:
-                we re-assign the negative samples per patch individually and sequentially clear them as loading them all
-                simultaneously can sometimes be hard on the available memory if a LOT of negatives are employed
-        */
+    /* note:
+            every (patch, positive) ESVM of a random-subspace slice is an independent training task, tasks are flattened into a
+            single list and dynamically distributed to available threads so that no core idles on a slow model or a small loop
+
+            negative samples of a patch are converted to feature nodes once per random-subspace and shared by pointer across
+            the training problems of all positives instead of being copied and converted again by every ESVM
+
+            negative samples from pre-generated files are loaded by groups of patches that fit within the memory budget
+            'ESVM_TRAINING_NEGATIVES_MEMORY_BUDGET' (at least one patch at a time) and cleared once the group is trained
+            as loading them all simultaneously can sometimes be hard on the available memory if a LOT of negatives are employed
+            (memory of a patch is estimated from its sample/feature counts, see 'estimateNegativesMemory', BINARY files only
+            need their header for this while other formats are loaded first and carried over to the next group if needed)
 
+            with hard negative mining ('config.miningNegatives'), file negatives of a patch/subspace become the mining pool of
+            its ESVM, which only train against the margin violators found by scoring the pool from its shared feature nodes
+            (patches trained with a shared precomputed kernel already employ all their negatives and are not mined)
+    */
+    const size_t memoryBudget = (size_t)ESVM_TRAINING_NEGATIVES_MEMORY_BUDGET * 1024 * 1024;
+    cv::Mat pendingSamples;     // negatives of the next patch already loaded from a non-BINARY file that exceeded the group budget
+    size_t p = 0;
+    while (p < nPatches)
+    {
         // load negative samples from pre-generated files for training (samples in files are pre-normalized)
-        #if   ESVM_FEATURE_NORM_MODE == 0
-        std::string negativeFileName = "negatives-raw-patch"                      + std::to_string(p) + sampleFileExt;
-        #elif ESVM_FEATURE_NORM_MODE == 1
-        std::string negativeFileName = "negatives-normROI-minmax-overAll-patch"   + std::to_string(p) + sampleFileExt;
-        #elif ESVM_FEATURE_NORM_MODE == 2
-        std::string negativeFileName = "negatives-normROI-zscore-overAll-patch"   + std::to_string(p) + sampleFileExt;
-        #elif ESVM_FEATURE_NORM_MODE == 3
-        std::string negativeFileName = "negatives-normROI-minmax-perFeat-patch"   + std::to_string(p) + sampleFileExt;
-        #elif ESVM_FEATURE_NORM_MODE == 4
-        std::string negativeFileName = "negatives-normROI-zscore-perFeat-patch"   + std::to_string(p) + sampleFileExt;
-        #elif ESVM_FEATURE_NORM_MODE == 5
-        std::string negativeFileName = "negatives-normPatch-minmax-overAll-patch" + std::to_string(p) + sampleFileExt;
-        #elif ESVM_FEATURE_NORM_MODE == 6
-        std::string negativeFileName = "negatives-normPatch-zscore-overAll-patch" + std::to_string(p) + sampleFileExt;
-        #elif ESVM_FEATURE_NORM_MODE == 7
-        std::string negativeFileName = "negatives-normPatch-minmax-perFeat-patch" + std::to_string(p) + sampleFileExt;
-        #elif ESVM_FEATURE_NORM_MODE == 8
-        std::string negativeFileName = "negatives-normPatch-zscore-perFeat-patch" + std::to_string(p) + sampleFileExt;
-        #endif/*ESVM_FEATURE_NORM_MODE*/
-
-        std::vector<FeatureVector> negFileSamples;  // reset on each patch
-        DataFile::readSampleDataFile(referenceFileDirectory + negativeFileName, negFileSamples, sampleFileFormat, ESVM_BINARY_HEADER_SAMPLES);
+        std::vector<size_t> groupPatches;
+        std::vector<cv::Mat> negFileSamples;                        // [group patch](negatives x features, CV_64F)
+        std::vector<esvmMappedSamples> negFileMappings;             // BINARY files mapped for the lifetime of the group
+        size_t groupMemory = 0;
+        while (p < nPatches)
+        {
+            std::string negativeFilePath = negativesDirectory + getNegativesFileName(p);
+            size_t nSamples = 0, nFeatures = 0, fileFeatureSize = sizeof(double);
+            if (sampleFileFormat == BINARY)
+                esvmMappedSamples::readDimensions(negativeFilePath, ESVM_BINARY_HEADER_SAMPLES, nSamples, nFeatures, fileFeatureSize);
+            else {
+                if (pendingSamples.empty()) {
+                    std::vector<FeatureVector> negFileVectors;
+                    DataFile::readSampleDataFile(negativeFilePath, negFileVectors, sampleFileFormat, ESVM_BINARY_HEADER_SAMPLES);
+                    pendingSamples = getSamplesMatrix(negFileVectors);
+                }
+                nSamples = (size_t)pendingSamples.rows;
+                nFeatures = (size_t)pendingSamples.cols;
+            }
+            size_t fileMemory = estimateNegativesMemory(nSamples, nFeatures, fileFeatureSize == sizeof(float));
+            if (!groupPatches.empty() && groupMemory + fileMemory > memoryBudget)
+                break;
 
-        for (size_t pos = 0; pos < nPositives; ++pos) {
-            negSamples[p][pos].insert(negSamples[p][pos].end(), negFileSamples.begin(), negFileSamples.end());
-            std::string idESVM = enrolledPositiveIDs[pos] + "-patch" + std::to_string(p);
-
-            #if ESVM_RANDOM_SUBSPACE_METHOD == 0
-            EoESVM[p][pos] = ESVM(posSamples[p][pos], negSamples[p][pos], idESVM);
-
-            #else/*ESVM_RANDOM_SUBSPACE_METHOD*/
-
-            // transfer features from random selection
-            size_t nPosRS = posSamples[p][pos].size();
-            size_t nNegRS = negSamples[p][pos].size();
-            xstd::mvector<2, FeatureVector> posSamplesRS({ ESVM_RANDOM_SUBSPACE_METHOD, nPosRS });
-            xstd::mvector<2, FeatureVector> negSamplesRS({ ESVM_RANDOM_SUBSPACE_METHOD, nNegRS });
-            #pragma omp parallel for
-            for (omp_size_t rs = 0; rs < ESVM_RANDOM_SUBSPACE_METHOD; ++rs) {
-                for (size_t iPosRS = 0; iPosRS < nPosRS; ++iPosRS) {
-                    posSamplesRS[rs][iPosRS] = FeatureVector(ESVM_RANDOM_SUBSPACE_FEATURES);
-                    for (size_t f = 0; f < ESVM_RANDOM_SUBSPACE_FEATURES; ++f)
-                        posSamplesRS[rs][iPosRS][f] = posSamples[p][pos][iPosRS][rsmFeatureIndexes[rs][f]];
+            if (sampleFileFormat == BINARY) {
+                // zero-copy contiguous view over the mapped file, float32 samples are widened once for training in double precision
+                negFileMappings.push_back(esvmMappedSamples(negativeFilePath, ESVM_BINARY_HEADER_SAMPLES));
+                cv::Mat mappedSamples = negFileMappings.back().getSamples();
+                if (mappedSamples.type() != CV_64F)
+                    mappedSamples.convertTo(mappedSamples, CV_64F);
+                negFileSamples.push_back(mappedSamples);
+            }
+            else {
+                negFileSamples.push_back(pendingSamples);
+                pendingSamples = cv::Mat();
+            }
+            groupPatches.push_back(p);
+            groupMemory += fileMemory;
+            ++p;
+        }
+
+        size_t nSubspaces = getSubspaceCount();
+
+        // train all ESVM of a patch/subspace with a shared precomputed kernel when applicable (negatives kernel computed once)
+        std::vector<bool> kernelTrained(groupPatches.size(), false);
+        #if ESVM_USE_PRECOMPUTED_KERNEL && ESVM_USE_LIBSVM
+        #if defined(_OPENMP) && !defined(ESVM_DEBUG)
+        size_t nKernelSlots = (size_t)omp_get_max_threads();
+        #else
+        size_t nKernelSlots = 1;
+        #endif
+        for (size_t g = 0; g < groupPatches.size(); ++g)
+        {
+            // kernel rows of file negatives followed by one slot of exemplar columns per thread, each ESVM writes the kernel
+            // values of its positive and additional negatives samples in the slot of its thread (see 'makePrecomputedKernel')
+            size_t tp = groupPatches[g];
+            size_t nKernelNegatives = (size_t)negFileSamples[g].rows;
+            size_t slotColumns = 0;
+            for (size_t pos = 0; pos < nPositives; ++pos)
+                slotColumns = std::max(slotColumns, posSamples[tp][pos].size() + negSamples[tp][pos].size());
+            size_t nKernelColumns = nKernelNegatives + nKernelSlots * slotColumns;
+            if (nKernelNegatives == 0 || nPositives == 0)
+                continue;
+            if (nKernelColumns > ESVM_PRECOMPUTED_KERNEL_MAX_SAMPLES) {
+                logstream logger(LOGGER_FILE);
+                logger << "Precomputed kernel of patch " << tp << " skipped, its " << nKernelColumns << " columns (" << nKernelNegatives
+                       << " negatives, " << nKernelSlots << " x " << slotColumns << " exemplar samples) exceed "
+                       << "'ESVM_PRECOMPUTED_KERNEL_MAX_SAMPLES' (" << ESVM_PRECOMPUTED_KERNEL_MAX_SAMPLES << "), ESVM are trained normally" << std::endl;
+                continue;
+            }
+
+            for (size_t rs = 0; rs < nSubspaces; ++rs)
+            {
+                cv::Mat kernelNegatives = config.useRandomSubspaces() ? getSubspaceSamples(negFileSamples[g], rs) : negFileSamples[g];
+                svmFeature** kernelRows = ESVM::makePrecomputedKernel(kernelNegatives, nKernelSlots * slotColumns);
+
+                #ifndef ESVM_DEBUG
+                #pragma omp parallel for schedule(dynamic, 1)
+                for (omp_size_t pos = 0; pos < (omp_size_t)nPositives; ++pos) {
+                #else
+                for (size_t pos = 0; pos < nPositives; ++pos) {
+                #endif/*ESVM_DEBUG*/
+                    #if defined(_OPENMP) && !defined(ESVM_DEBUG)
+                    size_t kernelColumn = (size_t)omp_get_thread_num() * slotColumns;
+                    #else
+                    size_t kernelColumn = 0;
+                    #endif
+                    std::string idESVM = models.enrolledPositiveIDs[positiveOffset + pos] + "-patch" + std::to_string(tp);
+                    if (config.useRandomSubspaces())
+                        idESVM += "-rs" + std::to_string(rs);
+                    models.EoESVM[tp * nSubspaces + rs][positiveOffset + pos] = config.useRandomSubspaces()
+                        ? std::make_shared<ESVM>(kernelNegatives, kernelRows, kernelColumn, getSubspaceSamples(posSamples[tp][pos], rs),
+                                                 getSubspaceSamples(negSamples[tp][pos], rs), idESVM, config)
+                        : std::make_shared<ESVM>(kernelNegatives, kernelRows, kernelColumn, posSamples[tp][pos],
+                                                 negSamples[tp][pos], idESVM, config);
                 }
-                for (size_t iNegRS = 0; iNegRS < nNegRS; ++iNegRS) {
-                    negSamplesRS[rs][iNegRS] = FeatureVector(ESVM_RANDOM_SUBSPACE_FEATURES);
-                    for (size_t f = 0; f < ESVM_RANDOM_SUBSPACE_FEATURES; ++f)
-                        negSamplesRS[rs][iNegRS][f] = negSamples[p][pos][iNegRS][rsmFeatureIndexes[rs][f]];
+                ESVM::destroyFeatureNodes(&kernelRows);
+            }
+            kernelTrained[g] = true;
+        }
+        #endif/*ESVM_USE_PRECOMPUTED_KERNEL && ESVM_USE_LIBSVM*/
+
+        // train remaining ESVM by subspace slices, file negatives of each patch are converted to feature nodes only once per
+        // slice and shared by all ESVM of that slice, tasks of a slice as [group patch][positive] are dynamically distributed
+        // with warm start, ESVM start from the average solution of enrolled ESVM of their patch/subspace, or when none are
+        // enrolled, from the solution of the first positive of their patch/subspace trained beforehand as a 'seed' task
+        omp_size_t nTasks = (omp_size_t)(groupPatches.size() * nPositives);
+        for (size_t rs = 0; rs < nSubspaces; ++rs)
+        {
+            std::vector<svmFeature**> negFileNodes(groupPatches.size(), nullptr);
+            std::vector<FeatureVector> warmSolutions(groupPatches.size());
+            std::vector<bool> seedPatches(groupPatches.size(), false);
+            for (size_t g = 0; g < groupPatches.size(); ++g) {
+                if (kernelTrained[g] || negFileSamples[g].empty())
+                    continue;
+                negFileNodes[g] = ESVM::makeFeatureNodes(config.useRandomSubspaces() ? getSubspaceSamples(negFileSamples[g], rs)
+                                                                                      : negFileSamples[g]);
+            }
+            if (config.warmStart && nPositives > 0) {
+                for (size_t g = 0; g < groupPatches.size(); ++g) {
+                    warmSolutions[g] = getWarmStartSolution(models, groupPatches[g] * nSubspaces + rs, positiveOffset, nPositives);
+                    seedPatches[g] = warmSolutions[g].empty() && !kernelTrained[g];
+                }
+            }
+
+            for (size_t pass = config.warmStart ? 0 : 1; pass < 2; ++pass)
+            {
+                #ifndef ESVM_DEBUG
+                #pragma omp parallel for schedule(dynamic, 1)
+                for (omp_size_t t = 0; t < nTasks; ++t) {
+                #else
+                for (size_t t = 0; t < (size_t)nTasks; ++t) {
+                #endif/*ESVM_DEBUG*/
+                    size_t g = (size_t)t / nPositives;
+                    size_t pos = (size_t)t % nPositives;
+                    bool isSeedTask = seedPatches[g] && pos == 0;
+                    if (kernelTrained[g] || isSeedTask != (pass == 0))
+                        continue;
+                    size_t tp = groupPatches[g];
+                    const std::vector<FeatureVector>& posPatch = posSamples[tp][pos];
+                    const std::vector<FeatureVector>& negPatch = negSamples[tp][pos];
+                    size_t nNegFile = (size_t)negFileSamples[g].rows;
+
+                    // positives and additional negatives are specific to this ESVM (few samples), file negatives are shared
+                    bool isSubspace = config.useRandomSubspaces();
+                    svmFeature** posNodes = ESVM::makeFeatureNodes(isSubspace ? getSubspaceSamples(posPatch, rs) : posPatch);
+                    svmFeature** negNodes = negPatch.empty() ? nullptr
+                                          : ESVM::makeFeatureNodes(isSubspace ? getSubspaceSamples(negPatch, rs) : negPatch);
+                    std::vector<svmFeature*> positives(posNodes, posNodes + posPatch.size());
+                    std::vector<svmFeature*> negatives;
+                    negatives.reserve(negPatch.size() + nNegFile);
+                    if (negNodes)
+                        negatives.insert(negatives.end(), negNodes, negNodes + negPatch.size());
+
+                    std::string idESVM = models.enrolledPositiveIDs[positiveOffset + pos] + "-patch" + std::to_string(tp);
+                    if (isSubspace)
+                        idESVM += "-rs" + std::to_string(rs);
+                    if (config.useHardNegativeMining() && nNegFile > config.miningNegatives) {
+                        // file negatives are the mining pool, only violators of the margin are added to the training problem
+                        models.EoESVM[tp * nSubspaces + rs][positiveOffset + pos] =
+                            std::make_shared<ESVM>(positives, negatives, negFileNodes[g], nNegFile, idESVM, config, warmSolutions[g]);
+                    }
+                    else {
+                        if (negFileNodes[g])
+                            negatives.insert(negatives.end(), negFileNodes[g], negFileNodes[g] + nNegFile);
+                        models.EoESVM[tp * nSubspaces + rs][positiveOffset + pos] =
+                            std::make_shared<ESVM>(positives, negatives, idESVM, config, warmSolutions[g]);
+                    }
+
+                    ESVM::destroyFeatureNodes(&posNodes);
+                    ESVM::destroyFeatureNodes(&negNodes);
                 }
+
+                // seed solutions are available to warm start the remaining positives once all seed tasks are trained
+                for (size_t g = 0; pass == 0 && g < groupPatches.size(); ++g)
+                    if (seedPatches[g])
+                        warmSolutions[g] = models.EoESVM[groupPatches[g] * nSubspaces + rs][positiveOffset]->getSolution();
+            }
+
+            for (size_t g = 0; g < groupPatches.size(); ++g)
+                ESVM::destroyFeatureNodes(&negFileNodes[g]);
+        }
+
+        for (size_t g = 0; g < groupPatches.size(); ++g)
+            negSamples[groupPatches[g]].clear();
+    }
+}
+
+/*
+    Computes the features of every patch of the ROI (pre-processing, patch split, feature extraction and normalization)
+*/
+std::vector<FeatureVector> esvmEnsemble::computeFeatures(const cv::Mat& roi) const
+{
+    return computePatchFeatures(preprocessPatches(roi));
+}
+
+/*
+    Applies the ROI pre-processing operations and splits it into patches for feature extraction
+*/
+std::vector<cv::Mat> esvmEnsemble::preprocessPatches(const cv::Mat& roi) const
+{
+    ASSERT_THROW(!roi.empty(), "ROI must not be empty for prediction");
+
+    // apply pre-processing operation as required
+    cv::Mat procROI = (config.roiPreprocessMode == 2) ? imCropByRatio(roi, config.roiCropRatio, CENTER_MIDDLE) : roi;
+
+    return imPreprocess(procROI, imageSize, patchCounts, ESVM_USE_HIST_EQUAL);
+}
+
+/*
+    Extracts and normalizes the features of every pre-processed patch
+*/
+std::vector<FeatureVector> esvmEnsemble::computePatchFeatures(const std::vector<cv::Mat>& patches, bool parallel) const
+{
+    size_t nPatches = getPatchCount();
+    ASSERT_THROW(patches.size() == nPatches, "Number of pre-processed patches must match the ensemble patch count");
+
+    // patches are extracted in parallel unless already within a parallel region over ROIs (nested regions run sequentially)
+    // callers already running concurrently outside OpenMP (ie: pipeline workers) must disable it to avoid a team per caller
+    std::vector<FeatureVector> patchFeatures(nPatches);
+    #pragma omp parallel for if (parallel)
+    for (omp_size_t p = 0; p < (omp_size_t)nPatches; ++p)
+    {
+        patchFeatures[p] = getThreadHOG().compute(patches[p]);
+        if (config.featureNormMode == 0)
+            continue;
+
+        // reference values of the patch (see their layout according to the mode)
+        NormType normType = config.isFeatureNormMinMax() ? MIN_MAX : Z_SCORE;
+        size_t iRef = config.isFeatureNormPerPatch() ? (size_t)p : 0;
+        if (config.isFeatureNormPerFeature())
+            patchFeatures[p] = normalizePerFeature(normType, patchFeatures[p], hogRefMinMean[iRef], hogRefMaxStdDev[iRef], config.featureNormClip);
+        else
+            patchFeatures[p] = normalizeOverAll(normType, patchFeatures[p], hogRefMinMean[0][iRef], hogRefMaxStdDev[0][iRef], config.featureNormClip);
+    }
+    return patchFeatures;
+}
+
+/*
+    HOG feature extractor of the calling thread (per-thread state, nothing shared across concurrent predictions), created on
+    first use and recreated only if the HOG parameters differ from those of the last ensemble employed by the thread.
+*/
+const FeatureExtractorHOG& esvmEnsemble::getThreadHOG() const
+{
+    struct ThreadHOG {
+        cv::Size windowSize, blockSize, blockStride, cellSize;
+        int nBins = 0;
+        FeatureExtractorHOG hog;
+    };
+    static thread_local ThreadHOG threadHOG;
+    if (threadHOG.nBins != nBins || threadHOG.windowSize != windowSize || threadHOG.blockSize != blockSize ||
+        threadHOG.blockStride != blockStride || threadHOG.cellSize != cellSize)
+    {
+        threadHOG.hog = FeatureExtractorHOG(windowSize, blockSize, blockStride, cellSize, nBins);
+        threadHOG.windowSize = windowSize;
+        threadHOG.blockSize = blockSize;
+        threadHOG.blockStride = blockStride;
+        threadHOG.cellSize = cellSize;
+        threadHOG.nBins = nBins;
+    }
+    return threadHOG.hog;
+}
+
+/*
+    Obtains the file name of pre-generated negative samples of the specified patch according to feature normalization mode.
+*/
+std::string esvmEnsemble::getNegativesFileName(size_t patch) const
+{
+    static const char* normNames[9] = {
+        "raw",
+        "normROI-minmax-overAll",   "normROI-zscore-overAll",   "normROI-minmax-perFeat",   "normROI-zscore-perFeat",
+        "normPatch-minmax-overAll", "normPatch-zscore-overAll", "normPatch-minmax-perFeat", "normPatch-zscore-perFeat"
+    };
+    return "negatives-" + std::string(normNames[config.featureNormMode]) + "-patch" + std::to_string(patch) + sampleFileExt;
+}
+
+/*
+    Estimates the memory (in bytes) held while training against 'nSamples' pre-generated negatives of 'nFeatures' features:
+    the 'CV_64F' samples matrix (plus the mapped file when float32 samples are widened), the random subspace slice matrix
+    when applicable and the feature nodes of the slice shared by its ESVM (with their bias and terminator nodes).
+*/
+size_t esvmEnsemble::estimateNegativesMemory(size_t nSamples, size_t nFeatures, bool mappedFloat32) const
+{
+    size_t sampleBytes = nFeatures * (sizeof(double) + (mappedFloat32 ? sizeof(float) : 0));
+    size_t nSliceFeatures = nFeatures;
+    if (config.useRandomSubspaces()) {
+        nSliceFeatures = config.rsmFeatures;
+        sampleBytes += nSliceFeatures * sizeof(double);
+    }
+    sampleBytes += (nSliceFeatures + ESVM_BIAS_NODES + 1) * sizeof(svmFeature);
+    return nSamples * sampleBytes;
+}
+
+/*
+    Obtains the average solution (weights followed by bias) of enrolled ESVM of the patch/subspace 'slot', excluding the
+    positives [positiveOffset, positiveOffset + nPositives[ being trained, to warm start their training.
+    Returns an empty solution if no other ESVM is enrolled (cold start).
+*/
+FeatureVector esvmEnsemble::getWarmStartSolution(const Models& models, size_t slot, size_t positiveOffset, size_t nPositives) const
+{
+    FeatureVector solution;
+    size_t nSolutions = 0;
+    for (size_t pos = 0; pos < models.EoESVM[slot].size(); ++pos) {
+        if ((pos >= positiveOffset && pos < positiveOffset + nPositives) || !models.EoESVM[slot][pos])
+            continue;
+        FeatureVector esvmSolution = models.EoESVM[slot][pos]->getSolution();
+        if (solution.empty())
+            solution.assign(esvmSolution.size(), 0.0);
+        ASSERT_THROW(esvmSolution.size() == solution.size(), "Enrolled ESVM of a patch/subspace must have the same feature count");
+        for (size_t f = 0; f < solution.size(); ++f)
+            solution[f] += esvmSolution[f];
+        ++nSolutions;
+    }
+    for (size_t f = 0; f < solution.size(); ++f)
+        solution[f] /= (double)nSolutions;
+    return solution;
+}
+
+/*
+    Obtains the samples reduced to the features selected by the specified random subspace.
+*/
+std::vector<FeatureVector> esvmEnsemble::getSubspaceSamples(const std::vector<FeatureVector>& samples, size_t rs) const
+{
+    size_t nSamples = samples.size();
+    std::vector<FeatureVector> samplesRS(nSamples, FeatureVector(config.rsmFeatures));
+    for (size_t s = 0; s < nSamples; ++s)
+        for (size_t f = 0; f < config.rsmFeatures; ++f)
+            samplesRS[s][f] = samples[s][rsmFeatureIndexes[rs][f]];
+    return samplesRS;
+}
+cv::Mat esvmEnsemble::getSubspaceSamples(const cv::Mat& samples, size_t rs) const
+{
+    cv::Mat samplesRS(samples.rows, (int)config.rsmFeatures, CV_64F);
+    for (int s = 0; s < samples.rows; ++s) {
+        const double* sample = samples.ptr<double>(s);
+        double* sampleRS = samplesRS.ptr<double>(s);
+        for (size_t f = 0; f < config.rsmFeatures; ++f)
+            sampleRS[f] = sample[rsmFeatureIndexes[rs][f]];
+    }
+    return samplesRS;
+}
+
+/*
+    Copies feature vectors into a single contiguous 'CV_64F' matrix [sample][feature].
+*/
+cv::Mat esvmEnsemble::getSamplesMatrix(const std::vector<FeatureVector>& samples)
+{
+    if (samples.empty())
+        return cv::Mat();
+    cv::Mat samplesMat((int)samples.size(), (int)samples[0].size(), CV_64F);
+    for (size_t s = 0; s < samples.size(); ++s) {
+        ASSERT_THROW(samples[s].size() == (size_t)samplesMat.cols, "Samples must all have the same feature count");
+        std::copy(samples[s].begin(), samples[s].end(), samplesMat.ptr<double>((int)s));
+    }
+    return samplesMat;
+}
+
+/*
+    Packs the compiled weights of all ESVM into one contiguous row-major matrix to allow batched scoring.
+    Rows are ordered as [svm * nPositives + pos] so that probe features of each patch/subspace are scored against
+    every enrolled positive with a single matrix product. Packing is skipped if any ESVM is not compiled.
+
+    With random subspaces, weights of each subspace ESVM are scattered back to the feature space of its patch so that
+    probe patch features are scored directly without any subspace gather. When the output of each ESVM is affine in its
+    decision value ('esvmConfig::isFoldedRSM'), the (normalized) subspace models of a patch are also summed into a single
+    patch model for average fusion, rows then being ordered as [patch * nPositives + pos].
+*/
+void esvmEnsemble::packModels(Models& models) const
+{
+    models.packedWeights.release();
+    models.packedBias.release();
+    models.packedBound.release();
+    models.archiveRegion.reset();   // packed models are owned from now on (loaded ESVM keep their own reference to the archive)
+    models.archiveMapping.reset();
+
+    size_t nESVM = models.EoESVM.size();
+    size_t nPositives = models.enrolledPositiveIDs.size();
+    if (nESVM == 0 || nPositives == 0)
+        return;
+
+    size_t nFeatures = 0;
+    for (size_t svm = 0; svm < nESVM; ++svm) {
+        for (size_t pos = 0; pos < nPositives; ++pos) {
+            if (!models.EoESVM[svm][pos]->isModelCompiled())
+                return;
+            nFeatures = std::max(nFeatures, (size_t)models.EoESVM[svm][pos]->getWeights().cols);
+        }
+    }
+
+    if (!config.useRandomSubspaces())
+    {
+        // weights shorter than the feature count are zero-padded (trailing features without support vector values)
+        models.packedWeights = cv::Mat::zeros((int)(nESVM * nPositives), (int)nFeatures, ESVM_CV_SCALAR);
+        models.packedBias = cv::Mat((int)nESVM, (int)nPositives, CV_64F);
+        for (size_t svm = 0; svm < nESVM; ++svm) {
+            for (size_t pos = 0; pos < nPositives; ++pos) {
+                const cv::Mat& weights = models.EoESVM[svm][pos]->getWeights();
+                std::copy(weights.ptr<esvmScalar>(), weights.ptr<esvmScalar>() + weights.cols,
+                          models.packedWeights.ptr<esvmScalar>((int)(svm * nPositives + pos)));
+                models.packedBias.at<double>((int)svm, (int)pos) = models.EoESVM[svm][pos]->getBias();
+            }
+        }
+        boundPackedModels(models);
+        return;
+    }
+
+    ASSERT_THROW(nFeatures <= config.rsmFeatures, "Subspace ESVM weights cannot exceed the random subspace feature count");
+    size_t nPatchFeatures = 0;
+    for (size_t rs = 0; rs < config.rsmCount; ++rs)
+        for (size_t f = 0; f < config.rsmFeatures; ++f)
+            nPatchFeatures = std::max(nPatchFeatures, (size_t)rsmFeatureIndexes[rs][f] + 1);
+    bool isFolded = config.isFoldedRSM();
+    size_t nPackedRows = isFolded ? getPatchCount() : nESVM;
+
+    models.packedWeights = cv::Mat::zeros((int)(nPackedRows * nPositives), (int)nPatchFeatures, ESVM_CV_SCALAR);
+    models.packedBias = cv::Mat::zeros((int)nPackedRows, (int)nPositives, CV_64F);
+    for (size_t svm = 0; svm < nESVM; ++svm) {
+        size_t rs = svm % config.rsmCount;
+        size_t row = isFolded ? svm / config.rsmCount : svm;
+        double scale = 1.0;
+        double offset = 0.0;
+        if (isFolded && config.isScoreNormPreFusion()) {
+            // affine pre-fusion score normalization (not clipped) folded into the weights and bias
+            scale = config.isScoreNormMinMax() ? 1.0 / (scoreRefMaxStdDevSVM[svm] - scoreRefMinMeanSVM[svm]) : 1.0 / scoreRefMaxStdDevSVM[svm];
+            offset = -scoreRefMinMeanSVM[svm] * scale;
+        }
+        for (size_t pos = 0; pos < nPositives; ++pos) {
+            // indexes repeated within a subspace accumulate, matching the gathered dot product
+            const cv::Mat& weights = models.EoESVM[svm][pos]->getWeights();
+            const esvmScalar* weightsRow = weights.ptr<esvmScalar>();
+            esvmScalar* packedRow = models.packedWeights.ptr<esvmScalar>((int)(row * nPositives + pos));
+            for (int f = 0; f < weights.cols; ++f)
+                packedRow[rsmFeatureIndexes[rs][f]] += (esvmScalar)(scale * weightsRow[f]);
+            models.packedBias.at<double>((int)row, (int)pos) += scale * models.EoESVM[svm][pos]->getBias() + offset;
+        }
+    }
+
+    boundPackedModels(models);
+}
+
+/*
+    Builds the probe features matrix of patch features of every frame [frame][patch] as rows [patch * nFrames + frame] over the
+    packed models feature space (zero-padded), as expected by 'scorePackedModels'.
+*/
+cv::Mat esvmEnsemble::getProbeFeatures(const Models& models, const std::vector<std::vector<FeatureVector> >& probeSamples) const
+{
+    size_t nPatches = getPatchCount();
+    size_t nFrames = probeSamples.size();
+    cv::Mat probeFeatures = cv::Mat::zeros((int)(nPatches * nFrames), models.packedWeights.cols, ESVM_CV_SCALAR);
+    for (size_t p = 0; p < nPatches; ++p) {
+        for (size_t f = 0; f < nFrames; ++f) {
+            size_t nFeatures = std::min(probeSamples[f][p].size(), (size_t)models.packedWeights.cols);
+            std::copy(probeSamples[f][p].begin(), probeSamples[f][p].begin() + nFeatures,
+                      probeFeatures.ptr<esvmScalar>((int)(p * nFrames + f)));
+        }
+    }
+    return probeFeatures;
+}
+
+/*
+    Applies the pre-fusion score normalization of the specified ESVM (unchanged if not enabled)
+*/
+double esvmEnsemble::normalizeScoreSVM(double score, size_t svm) const
+{
+    if (!config.isScoreNormPreFusion())
+        return score;
+    return normalize(config.isScoreNormMinMax() ? MIN_MAX : Z_SCORE, score, scoreRefMinMeanSVM[svm], scoreRefMaxStdDevSVM[svm],
+                     config.scoreNormClip);
+}
+
+/*
+    Applies the post-fusion score normalization (unchanged if not enabled)
+*/
+double esvmEnsemble::normalizeScoreFusion(double score) const
+{
+    if (!config.isScoreNormPostFusion())
+        return score;
+    return normalize(config.isScoreNormMinMax() ? MIN_MAX : Z_SCORE, score, scoreRefMinMeanFusion, scoreRefMaxStdDevFusion,
+                     config.scoreNormClip);
+}
+
+/*
+    Accumulates the score terms of packed model decisions [svm][frame * nPositives + pos] into the fusion sums [frame][pos].
+    Specialized for each prediction mode and pre-fusion score normalization (0: none, 1: min-max, 2: z-score, with clip)
+    to remove mode dispatch from the innermost scoring loop.
+*/
+template<int PredictMode, int ScoreNormSVM, bool ScoreNormClip>
+static void accumulateScoreTerms(const cv::Mat& decisions, const xstd::mvector<2, std::shared_ptr<const ESVM> >& EoESVM,
+                                 const std::vector<double>& refMinMean, const std::vector<double>& refMaxStdDev,
+                                 std::vector<std::vector<double> >& scoreSums)
+{
+    size_t nFrames = scoreSums.size();
+    size_t nESVM = (size_t)decisions.rows;
+    for (size_t f = 0; f < nFrames; ++f) {
+        size_t nPositives = scoreSums[f].size();
+        for (size_t svm = 0; svm < nESVM; ++svm) {
+            const double* decisionsSVM = decisions.ptr<double>((int)svm) + f * nPositives;
+            for (size_t pos = 0; pos < nPositives; ++pos) {
+                double score = EoESVM[svm][pos]->predictOutput<PredictMode>(decisionsSVM[pos]);
+                if (ScoreNormSVM == 1)
+                    score = normalize(MIN_MAX, score, refMinMean[svm], refMaxStdDev[svm], ScoreNormClip);
+                else if (ScoreNormSVM == 2)
+                    score = normalize(Z_SCORE, score, refMinMean[svm], refMaxStdDev[svm], ScoreNormClip);
+                scoreSums[f][pos] += score;
             }
+        }
+    }
+}
+
+/*
+    Selects the score terms kernel specialized for the prediction mode and pre-fusion score normalization of the configuration.
+*/
+esvmEnsemble::ScoreTermsKernel esvmEnsemble::selectScoreTermsKernel(const esvmConfig& config)
+{
+    // kernels ordered as [predictMode][ScoreNormSVM][ScoreNormClip]
+    static const ScoreTermsKernel kernels[] = {
+        accumulateScoreTerms<0, 0, false>, accumulateScoreTerms<0, 0, true>,
+        accumulateScoreTerms<0, 1, false>, accumulateScoreTerms<0, 1, true>,
+        accumulateScoreTerms<0, 2, false>, accumulateScoreTerms<0, 2, true>,
+        accumulateScoreTerms<1, 0, false>, accumulateScoreTerms<1, 0, true>,
+        accumulateScoreTerms<1, 1, false>, accumulateScoreTerms<1, 1, true>,
+        accumulateScoreTerms<1, 2, false>, accumulateScoreTerms<1, 2, true>,
+        accumulateScoreTerms<2, 0, false>, accumulateScoreTerms<2, 0, true>,
+        accumulateScoreTerms<2, 1, false>, accumulateScoreTerms<2, 1, true>,
+        accumulateScoreTerms<2, 2, false>, accumulateScoreTerms<2, 2, true>,
+    };
+    int scoreNormSVM = !config.isScoreNormPreFusion() ? 0 : config.isScoreNormMinMax() ? 1 : 2;
+    return kernels[(config.predictMode * 3 + scoreNormSVM) * 2 + (config.scoreNormClip ? 1 : 0)];
+}
 
-            // train with random subspaces
-            #ifndef ESVM_DEBUG
-            #pragma omp parallel for
-            for (omp_size_t rs = 0; rs < ESVM_RANDOM_SUBSPACE_METHOD; ++rs) {
-            #else
-            for (size_t rs = 0; rs < ESVM_RANDOM_SUBSPACE_METHOD; ++rs) {
-            #endif/*ESVM_DEBUG*/
-                std::string idESVMrs = idESVM + "-rs" + std::to_string(rs);
-                EoESVM[p * ESVM_RANDOM_SUBSPACE_METHOD + rs][pos] = ESVM(posSamplesRS[rs], negSamplesRS[rs], idESVMrs);
+/*
+    Applies the validated configuration and selects the scoring kernels specialized for it.
+*/
+void esvmEnsemble::setConfig(const esvmConfig& config)
+{
+    config.validate();
+    this->config = config;
+    scoreTermsKernel = selectScoreTermsKernel(config);
+}
+
+/*
+    Computes the upper bound of the score term that each packed row can add to the fusion of each positive for any probe.
+    Features are within [0,1] without normalization (HOG) or with clipped normalization, which bounds decision values by the
+    bias plus positive weights. Otherwise decisions are unbounded and only bounded outputs (labels, probability, clipped scores)
+    limit the terms. ESVM outputs and score normalizations being monotonic, bounds are obtained at the decision extremes.
+    When any term remains unbounded (unclipped feature normalization with decision values output or folded RSM, and without
+    clipped pre-fusion score normalization), no positive can ever be rejected: bounds are not kept and a warning is logged.
+*/
+void esvmEnsemble::boundPackedModels(Models& models) const
+{
+    models.packedBound.release();
+    if (models.packedWeights.empty())
+        return;
+
+    int nRows = models.packedBias.rows;
+    int nPositives = models.packedBias.cols;
+    models.packedBound = cv::Mat(nRows, nPositives, CV_64F);
+    bool isScoreClipped = config.isScoreNormPreFusion() && config.scoreNormClip;
+    bool isBounded = true;
+    for (int row = 0; row < nRows && isBounded; ++row) {
+        for (int pos = 0; pos < nPositives; ++pos) {
+            double decisionBound = DBL_MAX;
+            if (config.isFeatureBounded()) {
+                decisionBound = models.packedBias.at<double>(row, pos);
+                const esvmScalar* weights = models.packedWeights.ptr<esvmScalar>(row * nPositives + pos);
+                for (int f = 0; f < models.packedWeights.cols; ++f)
+                    decisionBound += std::max((double)weights[f], 0.0);
+            }
+            if (config.isFoldedRSM()) {
+                models.packedBound.at<double>(row, pos) = decisionBound;
+                isBounded = isBounded && decisionBound < DBL_MAX;
+                continue;
             }
+            const ESVM& esvm = *models.EoESVM[row][pos];
+            double outputBound = std::max(esvm.predictOutput(decisionBound), esvm.predictOutput(-DBL_MAX));
+            models.packedBound.at<double>(row, pos) = normalizeScoreSVM(outputBound, (size_t)row);
+            isBounded = isBounded && (outputBound < DBL_MAX || isScoreClipped);
+        }
+    }
+
+    if (!isBounded) {
+        models.packedBound.release();
+        logstream logger(LOGGER_FILE);
+        logger << "Warning: cascaded prediction cannot reject any positive with unbounded score terms (feature normalization "
+               << "without clip and decision values or folded RSM), positives are fully scored instead" << std::endl;
+    }
+}
+
+/*
+    Scores probe features against all packed ESVM using the SIMD dot product kernel for a single probe, or otherwise using one
+    matrix product (GEMM) per patch/subspace.
+    Probe features rows are expected as [(svm / svmPerProbeRow) * nProbes + probe] (consecutive packed ESVM sharing the same probe
+    features, ie: subspaces scattered in their patch feature space), decision values are returned as [svm][probe * nPositives + pos].
+    Products are computed at the packed weights precision ('ESVM_CV_SCALAR'), biases are added in double precision.
+*/
+cv::Mat esvmEnsemble::scorePackedModels(const Models& models, const cv::Mat& probeFeatures, int nProbes, int svmPerProbeRow) const
+{
+    int nESVM = models.packedBias.rows;
+    int nPositives = models.packedBias.cols;
+    ASSERT_THROW(probeFeatures.type() == models.packedWeights.type(), "Probe features must be of the packed models type for scoring");
+    ASSERT_THROW(svmPerProbeRow > 0 && probeFeatures.rows * svmPerProbeRow == nESVM * nProbes,
+                 "Probe features rows must match the number of ESVM for each probe");
+    ASSERT_THROW(probeFeatures.cols == models.packedWeights.cols, "Probe features columns must match the packed models feature count");
 
-            #endif/*ESVM_RANDOM_SUBSPACE_METHOD*/
+    cv::Mat scores(nESVM, nProbes * nPositives, CV_64F);
+    if (nProbes == 1) {
+        // single probe (GEMV) scored with the dispatched SIMD dot product kernel over contiguous packed rows
+        int nFeatures = models.packedWeights.cols;
+        for (int svm = 0; svm < nESVM; ++svm) {
+            const esvmScalar* probeSVM = probeFeatures.ptr<esvmScalar>(svm / svmPerProbeRow);
+            const double* biasSVM = models.packedBias.ptr<double>(svm);
+            double* scoresSVM = scores.ptr<double>(svm);
+            for (int pos = 0; pos < nPositives; ++pos)
+                scoresSVM[pos] = biasSVM[pos] + dotProduct(models.packedWeights.ptr<esvmScalar>(svm * nPositives + pos), probeSVM, nFeatures);
+        }
+        return scores;
+    }
 
-            negSamples[p][pos].clear();
+    cv::Mat productsSVM;    // reused across patches/subspaces (same dimensions)
+    for (int svm = 0; svm < nESVM; ++svm) {
+        int probeRow = svm / svmPerProbeRow;
+        cv::Mat probesSVM = probeFeatures.rowRange(probeRow * nProbes, (probeRow + 1) * nProbes);
+        cv::Mat weightsSVM = models.packedWeights.rowRange(svm * nPositives, (svm + 1) * nPositives);
+        cv::gemm(probesSVM, weightsSVM, 1.0, cv::Mat(), 0.0, productsSVM, cv::GEMM_2_T);
+        const double* biasSVM = models.packedBias.ptr<double>(svm);
+        double* scoresSVM = scores.ptr<double>(svm);
+        for (int probe = 0; probe < nProbes; ++probe) {
+            const esvmScalar* productsProbe = productsSVM.ptr<esvmScalar>(probe);
+            for (int pos = 0; pos < nPositives; ++pos)
+                scoresSVM[probe * nPositives + pos] = biasSVM[pos] + productsProbe[pos];
         }
-        negSamples[p].clear();
     }
+    return scores;
 }
 
 void esvmEnsemble::setConstants(std::string referenceFileDirectory)
@@ -212,26 +846,31 @@ void esvmEnsemble::setConstants(std::string referenceFileDirectory)
     cellSize = cv::Size(2, 2);
     nBins = 3;
     windowSize = cv::Size(imageSize.width / patchCounts.width, imageSize.height / patchCounts.height);
-    hog = FeatureExtractorHOG(windowSize, blockSize, blockStride, cellSize, nBins);
 
     /* --- Feature 'hardcoded' normalization values for on-line classification --- */
 
-    #if ESVM_FEATURE_NORM_MODE == 1    // Min-Max overall normalization across patches
+    // reference values layout: overall across patches [0][0], per feature across patches [0], overall for each patch [0][p],
+    // per feature for each patch [p] (values of the other modes are kept for reference, only the last assigned ones apply)
+    hogRefMinMean.clear();
+    hogRefMaxStdDev.clear();
+    switch (config.featureNormMode)
+    {
+    case 1:     // Min-Max overall normalization across patches
         // found min/max using 'FullChokePoint' test with SAMAN pre-generated files
-        hogMin = 0;
-        hogMax = 0.675058;
+        hogRefMinMean = { { 0 } };
+        hogRefMaxStdDev = { { 0.675058 } };
         // found min/max using 'FullGenerationAndTestProcess' test (loaded ROI from ChokePoint + Fast-DT ROI localized search)
-        hogMin = 0;
-        hogMax = 0.704711;
+        hogRefMinMean = { { 0 } };
+        hogRefMaxStdDev = { { 0.704711 } };
 
         // found min/max using 'proc_createNegativesSampleFiles' with 'PROC_ESVM_GENERATE_SAMPLE_FILES'=1 (S1 only)
         // generate AFTER fix of patch split / data pointer access of patches for HOG
-        hogMin = 0;
-        hogMax = 0.766903;
+        hogRefMinMean = { { 0 } };
+        hogRefMaxStdDev = { { 0.766903 } };
 
         // found min/max using 'proc_createNegativesSampleFiles' (REP 0 & Sessions S1 to S4 + validated with SAMAN-MATLAB code)
-        hogMin = 0.0;
-        hogMax = 1.0;
+        hogRefMinMean = { { 0.0 } };
+        hogRefMaxStdDev = { { 1.0 } };
 
         // found min/max using 'create_negatives' procedure with all ChokePoint available ROIs that match the specified negative IDs (35276 samples)
         // feature extraction is executed using the same pre-process as on-line execution (with HistEqual = 0)
@@ -243,35 +882,31 @@ void esvmEnsemble::setConstants(std::string referenceFileDirectory)
         // feature extraction is executed using the same pre-process as on-line execution (with HistEqual = 1)
         ///hogMin = 0;
         ///hogMax = 0.695519;
-    #elif ESVM_FEATURE_NORM_MODE == 2  // Z-Score overall normalization across patches
-        THROW("Not set reference normalization values (ESVM_FEATURE_NORM_MODE == 2)");
-    #elif ESVM_FEATURE_NORM_MODE == 3  // Min-Max per feature normalization across patches
-        THROW("Not set reference normalization values (ESVM_FEATURE_NORM_MODE == 3)");
-        hogMin = {};
-        hogMax = {};
-    #elif ESVM_FEATURE_NORM_MODE == 4  // Z-Score per feature normalization across patches
-        THROW("Not set reference normalization values (ESVM_FEATURE_NORM_MODE == 4)");
-    #elif ESVM_FEATURE_NORM_MODE == 5  // Min-Max overall normalization for each patch
-        THROW("Not set reference normalization values (ESVM_FEATURE_NORM_MODE == 5)");
-    #elif ESVM_FEATURE_NORM_MODE == 6  // Z-Score overall normalization for each patch
-        THROW("Not set reference normalization values (ESVM_FEATURE_NORM_MODE == 6)");
-    #elif ESVM_FEATURE_NORM_MODE == 7  // Min-Max per feature normalization for each patch
-        DataFile::readSampleDataFile(referenceFileDirectory + "negatives-normPatch-minmax-perFeat-MIN.data", hogMin, LIBSVM);
-        DataFile::readSampleDataFile(referenceFileDirectory + "negatives-normPatch-minmax-perFeat-MAX.data", hogMax, LIBSVM);
-    #elif ESVM_FEATURE_NORM_MODE == 8  // Z-Score per feature normalization for each patch
-        THROW("Not set reference normalization values (ESVM_FEATURE_NORM_MODE == 8)");
-    #endif/*ESVM_FEATURE_NORM_MODE*/
+        break;
+    case 7:     // Min-Max per feature normalization for each patch
+        DataFile::readSampleDataFile(referenceFileDirectory + "negatives-normPatch-minmax-perFeat-MIN.data", hogRefMinMean, LIBSVM);
+        DataFile::readSampleDataFile(referenceFileDirectory + "negatives-normPatch-minmax-perFeat-MAX.data", hogRefMaxStdDev, LIBSVM);
+        break;
+    case 2:     // Z-Score overall normalization across patches
+    case 3:     // Min-Max per feature normalization across patches
+    case 4:     // Z-Score per feature normalization across patches
+    case 5:     // Min-Max overall normalization for each patch
+    case 6:     // Z-Score overall normalization for each patch
+    case 8:     // Z-Score per feature normalization for each patch
+        THROW("Not set reference normalization values (feature normalization mode " + std::to_string(config.featureNormMode) + ")");
+    }
 
     /* --- Random Subspace Method for feature selection and compact pool generation --- */
 
-    #if ESVM_RANDOM_SUBSPACE_METHOD
+    if (config.useRandomSubspaces())
+    {
         // read file containing indexes of features to employ from each corresponding random subspace
         // zero-value features are ignored, others are taken as part of the random subspace
         std::vector<FeatureVector> rsmIndexes;
         DataFile::readSampleDataFile(referenceFileDirectory + "rsm-indexes.data", rsmIndexes, LIBSVM);
-        ASSERT_THROW(rsmIndexes.size() == ESVM_RANDOM_SUBSPACE_METHOD, "Incorrect number of RSM subspaces");
+        ASSERT_THROW(rsmIndexes.size() == config.rsmCount, "Incorrect number of RSM subspaces");
 
-        size_t dimsRSM[2]{ ESVM_RANDOM_SUBSPACE_METHOD, ESVM_RANDOM_SUBSPACE_FEATURES };
+        size_t dimsRSM[2]{ config.rsmCount, config.rsmFeatures };
         rsmFeatureIndexes = xstd::mvector<2, int>(dimsRSM, 0);
         for (size_t rs = 0; rs < rsmIndexes.size(); ++rs) {
             size_t iFeat = 0;
@@ -281,26 +916,32 @@ void esvmEnsemble::setConstants(std::string referenceFileDirectory)
                     ++iFeat;
                 }
             }
-            ASSERT_THROW(iFeat == ESVM_RANDOM_SUBSPACE_FEATURES, "Incorrect number of RSM features");
+            ASSERT_THROW(iFeat == config.rsmFeatures, "Incorrect number of RSM features");
         }
-    #endif/*ESVM_RANDOM_SUBSPACE_METHOD*/
+    }
 
     /* --- Score 'hardcoded' normalization values for on-line classification --- */
 
-    #if   ESVM_SCORE_NORM_MODE == 1    // Min-Max normalization only post-fusion
+    scoreRefMinMeanSVM.clear();
+    scoreRefMaxStdDevSVM.clear();
+    scoreRefMinMeanFusion = 0;
+    scoreRefMaxStdDevFusion = 0;
+    switch (config.scoreNormMode)
+    {
+    case 1:     // Min-Max normalization only post-fusion
         // found min/max using 'SimplifiedWorkingProcedure' test with SAMAN pre-generated files
-        scoreMinFusion = -1.578030;
-        scoreMaxFusion = -0.478968;
+        scoreRefMinMeanFusion = -1.578030;
+        scoreRefMaxStdDevFusion = -0.478968;
         // found min/max using 'FullGenerationAndTestProcess' test (loaded ROI from ChokePoint + Fast-DT ROI localized search)
-        scoreMinFusion = -5.15837;
-        scoreMaxFusion = 0.156316;
+        scoreRefMinMeanFusion = -5.15837;
+        scoreRefMaxStdDevFusion = 0.156316;
 
         // found min/max using 'FullGenerationAndTestProcess' AFTER fix of patch split / data pointer access of patches for HOG
         //      S1 - Min / Max : -4.03879 / 0.366612
         //      S3 - Min / Max : -4.16766 / 0.200456
         //      EX - Min / Max : -4.28606 / 0.60522
-        scoreMinFusion = -4.28606;
-        scoreMaxFusion =  0.60522;
+        scoreRefMinMeanFusion = -4.28606;
+        scoreRefMaxStdDevFusion =  0.60522;
 
         // found min/max using FAST-DT live test
         ///scoreRefMin = 0.085;         // Testing
@@ -314,125 +955,283 @@ void esvmEnsemble::setConstants(std::string referenceFileDirectory)
         /* experimental adjustment */
         ///scoreRefMin = -2.929948;
         ///scoreRefMax = -0.731181;
-    #elif ESVM_SCORE_NORM_MODE == 2    // Z-Score normalization only post-fusion
+        break;
+    case 2:     // Z-Score normalization only post-fusion
         // found using FAST-DT live test
         ///scoreRefMean = -1.26193;
         ///scoreRefStdDev = 0.247168;
         // values found using the LBP Improved run in 'live' and calculated over a large amount of samples
-        scoreMeanFusion = -1.61661;
-        scoreStdDevFusion = 0.712719;
-    #elif ESVM_SCORE_NORM_MODE == 3    // Min-Max normalization only pre-fusion
+        scoreRefMinMeanFusion = -1.61661;
+        scoreRefMaxStdDevFusion = 0.712719;
+        break;
+    case 3:     // Min-Max normalization only pre-fusion
         // found with SAMAN-MATLAB code (min-max of 'SEHOG', which contains per-patch scores before 'mat2gray' norm call)
         // in this code, min-max across patches are applied globally, so we repeat the values here along the vector
-        scoreMinSVM = { -2.3173, -2.3173, -2.3173, -2.3173, -2.3173, -2.3173, -2.3173, -2.3173, -2.3173 };
-        scoreMaxSVM = {  0.3041,  0.3041,  0.3041,  0.3041,  0.3041,  0.3041,  0.3041,  0.3041,  0.3041 };
+        scoreRefMinMeanSVM = { -2.3173, -2.3173, -2.3173, -2.3173, -2.3173, -2.3173, -2.3173, -2.3173, -2.3173 };
+        scoreRefMaxStdDevSVM = {  0.3041,  0.3041,  0.3041,  0.3041,  0.3041,  0.3041,  0.3041,  0.3041,  0.3041 };
         // found with live test using multiple samples while using OverAll [0,1] feat norm, apply globally by repeating the values along the vector
-        scoreMinSVM = { -7.452180, -7.452180, -7.452180, -7.452180, -7.452180, -7.452180, -7.452180, -7.452180, -7.452180 };
-        scoreMaxSVM = {  0.106344,  0.106344,  0.106344,  0.106344,  0.106344,  0.106344,  0.106344,  0.106344,  0.106344 };
+        scoreRefMinMeanSVM = { -7.452180, -7.452180, -7.452180, -7.452180, -7.452180, -7.452180, -7.452180, -7.452180, -7.452180 };
+        scoreRefMaxStdDevSVM = {  0.106344,  0.106344,  0.106344,  0.106344,  0.106344,  0.106344,  0.106344,  0.106344,  0.106344 };
         // found with live test using multiple samples while using OverAll [0,1] feat norm, apply per-patch values
-        scoreMinSVM = { -7.56068, -7.39327, -7.12514, -6.41666, -6.88239, -5.35840, -4.91217, -7.09871, -5.09559 };
-        scoreMaxSVM = {  0.67624,  0.04454, -0.08241, -0.01146,  0.10634, -0.33685,  0.44945, -0.38734, -0.08821 };
+        scoreRefMinMeanSVM = { -7.56068, -7.39327, -7.12514, -6.41666, -6.88239, -5.35840, -4.91217, -7.09871, -5.09559 };
+        scoreRefMaxStdDevSVM = {  0.67624,  0.04454, -0.08241, -0.01146,  0.10634, -0.33685,  0.44945, -0.38734, -0.08821 };
         // found with live test using multiple samples while using PerFeat+PerPatch norm, apply per-patch values
-        scoreMinSVM = { -6.807770, -6.909670, -7.877120, -6.726680, -7.312010, -6.640210, -4.512120, -7.31828, -5.050850 };
-        scoreMaxSVM = { -0.411032,  0.192947, -0.626578, -0.042603,  0.900917,  0.146266, -0.256226, -0.41460,  0.106787 };
-    #elif ESVM_SCORE_NORM_MODE == 4    // Z-Score normalization only pre-fusion
-        THROW("Not set reference normalization values (ESVM_SCORE_NORM_MODE == 4)");
-    #elif ESVM_SCORE_NORM_MODE == 5    // Min-Max normalization both pre/post-fusion
-        scoreMinSVM = {};
-        scoreMaxSVM = {};
-        scoreMinFusion = 0;
-        scoreMaxFusion = 0;
-    #elif ESVM_SCORE_NORM_MODE == 6    // Z-Score normalization both pre/post-fusion
-        THROW("Not set reference normalization values (ESVM_SCORE_NORM_MODE == 6)");
-    #endif/*ESVM_SCORE_NORM_MODE*/
+        scoreRefMinMeanSVM = { -6.807770, -6.909670, -7.877120, -6.726680, -7.312010, -6.640210, -4.512120, -7.31828, -5.050850 };
+        scoreRefMaxStdDevSVM = { -0.411032,  0.192947, -0.626578, -0.042603,  0.900917,  0.146266, -0.256226, -0.41460,  0.106787 };
+        break;
+    case 4:     // Z-Score normalization only pre-fusion
+    case 5:     // Min-Max normalization both pre/post-fusion
+    case 6:     // Z-Score normalization both pre/post-fusion
+        THROW("Not set reference normalization values (score normalization mode " + std::to_string(config.scoreNormMode) + ")");
+    }
 
     sampleFileExt = ".bin";
     sampleFileFormat = BINARY;
 }
 
-std::string esvmEnsemble::getPositiveID(int positiveIndex)
+std::string esvmEnsemble::getPositiveID(int positiveIndex) const
 {
-    size_t nPositives = getPositiveCount();
-    return (nPositives != 0 && positiveIndex >= 0 && positiveIndex < nPositives) ? enrolledPositiveIDs[positiveIndex] : "";
+    std::shared_ptr<const Models> models = getModels();
+    size_t nPositives = models->enrolledPositiveIDs.size();
+    return (nPositives != 0 && positiveIndex >= 0 && positiveIndex < nPositives) ? models->enrolledPositiveIDs[positiveIndex] : "";
 }
 
 /*
     Predicts the classification value for the specified roi using the trained Ensemble of ESVM model.
 */
-std::vector<double> esvmEnsemble::predict(const cv::Mat& roi)
+std::vector<double> esvmEnsemble::predict(const cv::Mat& roi) const
+{
+    return predictFrames({ roi })[0];
+}
+
+/*
+    Predicts the track-level classification values of a sequence of frame ROIs (ie: face track) using the trained Ensemble of
+    ESVM model. Frames are processed as a single batch, frame scores are fused for each positive according to the fusion method.
+    Individual frame scores [frame][pos] are also returned if 'frameScores' is specified.
+*/
+std::vector<double> esvmEnsemble::predictTrack(const std::vector<cv::Mat>& rois, TrackFusion fusion,
+                                               std::vector<std::vector<double> >* frameScores) const
+{
+    ASSERT_THROW(!rois.empty(), "Track must contain at least one frame ROI for prediction");
+
+    std::vector<std::vector<double> > scores = predictFrames(rois);
+    size_t nPositives = scores[0].size();
+    std::vector<double> trackScores(nPositives, fusion == TRACK_FUSION_MAX ? -DBL_MAX : 0.0);
+    for (size_t f = 0; f < scores.size(); ++f) {
+        for (size_t pos = 0; pos < nPositives; ++pos) {
+            if (fusion == TRACK_FUSION_MAX)
+                trackScores[pos] = std::max(trackScores[pos], scores[f][pos]);
+            else
+                trackScores[pos] += scores[f][pos];
+        }
+    }
+    if (fusion == TRACK_FUSION_MEAN)
+        for (size_t pos = 0; pos < nPositives; ++pos)
+            trackScores[pos] /= (double)scores.size();
+
+    if (frameScores != nullptr)
+        *frameScores = std::move(scores);
+    return trackScores;
+}
+
+/*
+    Predicts the classification values of the roi with early rejection of positives that cannot reach the decision threshold.
+    A first stage scores a subset of packed models spread over patches ('ESVM_CASCADE_STAGE_RATIO', first subspaces of every
+    patch first) for every positive. Positives whose partial score, completed by the upper bounds of the remaining models, is
+    below the threshold are rejected without further scoring. Remaining positives are fully scored and obtain the same score as
+    'predict' (up to summation order), rejected ones report their score upper bound (below threshold) and are flagged in 'rejected'.
+    Rejection requires bounded score terms (see 'boundPackedModels'): features within [0,1] (no normalization or clipped), or
+    otherwise bounded ESVM outputs (labels, probability) or clipped pre-fusion score normalization. In other configurations,
+    or without packed models, all positives are scored with 'scoreFeatures'.
+*/
+std::vector<double> esvmEnsemble::predictCascade(const cv::Mat& roi, double threshold, std::vector<bool>* rejected) const
+{
+    return predictCascade(*getModels(), roi, threshold, rejected);
+}
+
+std::vector<double> esvmEnsemble::predictCascade(const Models& models, const cv::Mat& roi, double threshold, std::vector<bool>* rejected) const
 {
-    size_t nPositives = getPositiveCount();
+    // score bounds are only available with packed models of bounded score terms
+    if (models.packedWeights.empty() || models.packedBound.empty()) {
+        std::vector<double> scores = scoreFeatures(models, { computeFeatures(roi) })[0];
+        if (rejected != nullptr)
+            rejected->assign(scores.size(), false);
+        return scores;
+    }
+
+    size_t nPositives = models.enrolledPositiveIDs.size();
     size_t nPatches = getPatchCount();
+    size_t nESVM = models.EoESVM.size();
+    int nRows = models.packedBias.rows;
+    int rowsPerPatch = nRows / (int)nPatches;
+    cv::Mat probeFeatures = getProbeFeatures(models, { computeFeatures(roi) });
 
-    // apply pre-processing operation as required
-    #if ESVM_ROI_PREPROCESS_MODE == 2
-    cv::Mat procROI = imCropByRatio(roi, ESVM_ROI_CROP_RATIO, CENTER_MIDDLE);
-    #else
-    cv::Mat procROI = roi;
-    #endif/*ESVM_ROI_PREPROCESS_MODE*/
+    std::vector<int> rowOrder;
+    for (int k = 0; k < rowsPerPatch; ++k)
+        for (int p = 0; p < (int)nPatches; ++p)
+            rowOrder.push_back(p * rowsPerPatch + k);
+    size_t nStageRows = std::min((size_t)nRows, std::max((size_t)1, (size_t)std::ceil(ESVM_CASCADE_STAGE_RATIO * nRows)));
+
+    // score term of a packed row for a positive, as accumulated by average fusion
+    bool isFolded = config.isFoldedRSM();
+    auto scoreTerm = [&](int row, size_t pos) {
+        double decision = models.packedBias.at<double>(row, (int)pos)
+                        + dotProduct(models.packedWeights.ptr<esvmScalar>(row * (int)nPositives + (int)pos),
+                                     probeFeatures.ptr<esvmScalar>(row / rowsPerPatch), (size_t)models.packedWeights.cols);
+        if (isFolded)
+            return decision;
+        return normalizeScoreSVM(models.EoESVM[row][pos]->predictOutput(decision), (size_t)row);
+    };
+
+    std::vector<double> classificationScores(nPositives, 0.0);
+    std::vector<char> isRejected(nPositives, 0);    // not 'std::vector<bool>' to allow concurrent writes
+    #pragma omp parallel for schedule(dynamic, 16)
+    for (omp_size_t pos = 0; pos < (omp_size_t)nPositives; ++pos) {
+        double scoreSum = 0;
+        double boundSum = 0;
+        for (size_t i = 0; i < nStageRows; ++i)
+            scoreSum += scoreTerm(rowOrder[i], (size_t)pos);
+        for (size_t i = nStageRows; i < rowOrder.size(); ++i)
+            boundSum += models.packedBound.at<double>(rowOrder[i], (int)pos);
+        double scoreBound = normalizeScoreFusion((scoreSum + boundSum) / (double)nESVM);
+        if (scoreBound < threshold) {
+            isRejected[pos] = 1;
+            classificationScores[pos] = scoreBound;
+            continue;
+        }
+        for (size_t i = nStageRows; i < rowOrder.size(); ++i)
+            scoreSum += scoreTerm(rowOrder[i], (size_t)pos);
+        classificationScores[pos] = normalizeScoreFusion(scoreSum / (double)nESVM);
+    }
+
+    if (rejected != nullptr)
+        rejected->assign(isRejected.begin(), isRejected.end());
+    return classificationScores;
+}
+
+/*
+    Retrieves the (at most) 'k' best enrolled positives IDs with their score for the roi, in decreasing score order, only
+    considering scores at or above the threshold. Candidates are selected with a bounded min-heap of size 'k' instead of sorting
+    all scores. The cascaded prediction can be employed to skip full scoring of positives that cannot reach the threshold.
+*/
+std::vector<std::pair<std::string, double> > esvmEnsemble::predictTopK(const cv::Mat& roi, size_t k, double threshold, bool useCascade) const
+{
+    std::shared_ptr<const Models> snapshot = getModels();     // same models for scores and their IDs
+    const Models& models = *snapshot;
+    std::vector<bool> rejected;
+    std::vector<double> scores = useCascade ? predictCascade(models, roi, threshold, &rejected)
+                                            : scoreFeatures(models, { computeFeatures(roi) })[0];
+
+    typedef std::pair<double, size_t> Candidate;   // (score, positive index)
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate> > heap;
+    for (size_t pos = 0; pos < scores.size() && k > 0; ++pos) {
+        if ((useCascade && rejected[pos]) || scores[pos] < threshold)
+            continue;
+        if (heap.size() < k)
+            heap.push(Candidate(scores[pos], pos));
+        else if (scores[pos] > heap.top().first) {
+            heap.pop();
+            heap.push(Candidate(scores[pos], pos));
+        }
+    }
+
+    std::vector<std::pair<std::string, double> > candidates(heap.size());
+    for (size_t c = candidates.size(); c > 0; --c) {
+        candidates[c - 1] = std::make_pair(models.enrolledPositiveIDs[heap.top().second], heap.top().first);
+        heap.pop();
+    }
+    return candidates;
+}
+
+/*
+    Predicts the classification values of every frame ROI against all positives using the trained Ensemble of ESVM model.
+    Features of all frames are extracted in parallel and scored against packed models as a single probe matrix.
+    Scores are returned as [frame][pos].
+*/
+std::vector<std::vector<double> > esvmEnsemble::predictFrames(const std::vector<cv::Mat>& rois) const
+{
+    size_t nFrames = rois.size();
 
     // load probe still images, extract features and normalize
-    std::vector<FeatureVector> probeSamples(nPatches);
-    std::vector<cv::Mat> patches = imPreprocess(procROI, imageSize, patchCounts, ESVM_USE_HIST_EQUAL);
-    for (size_t p = 0; p < nPatches; p++)
-    {
-        probeSamples[p] = hog.compute(patches[p]);
-        #if   ESVM_FEATURE_NORM_MODE == 1
-        probeSamples[p] = normalizeOverAll(MIN_MAX,    probeSamples[p], hogMin,     hogMax,       ESVM_FEATURE_NORM_CLIP);
-        #elif ESVM_FEATURE_NORM_MODE == 2
-        probeSamples[p] = normalizeOverAll(Z_SCORE,    probeSamples[p], hogMean,    hogStdDev,    ESVM_FEATURE_NORM_CLIP);
-        #elif ESVM_FEATURE_NORM_MODE == 3
-        probeSamples[p] = normalizePerFeature(MIN_MAX, probeSamples[p], hogMin,     hogMax,       ESVM_FEATURE_NORM_CLIP);
-        #elif ESVM_FEATURE_NORM_MODE == 4
-        probeSamples[p] = normalizePerFeature(Z_SCORE, probeSamples[p], hogMean,    hogStdDev,    ESVM_FEATURE_NORM_CLIP);
-        #elif ESVM_FEATURE_NORM_MODE == 5
-        probeSamples[p] = normalizeOverAll(MIN_MAX,    probeSamples[p], hogMin[p],  hogMax[p],    ESVM_FEATURE_NORM_CLIP);
-        #elif ESVM_FEATURE_NORM_MODE == 6
-        probeSamples[p] = normalizeOverAll(Z_SCORE,    probeSamples[p], hogMean[p], hogStdDev[p], ESVM_FEATURE_NORM_CLIP);
-        #elif ESVM_FEATURE_NORM_MODE == 7
-        probeSamples[p] = normalizePerFeature(MIN_MAX, probeSamples[p], hogMin[p],  hogMax[p],    ESVM_FEATURE_NORM_CLIP);
-        #elif ESVM_FEATURE_NORM_MODE == 8
-        probeSamples[p] = normalizePerFeature(Z_SCORE, probeSamples[p], hogMean[p], hogStdDev[p], ESVM_FEATURE_NORM_CLIP);
-        #endif/*ESVM_FEATURE_NORM_MODE*/
-    }
-
-    // prepare test samples
-    # if !ESVM_RANDOM_SUBSPACE_METHOD
-        size_t nESVM = nPatches;
-        std::vector<FeatureVector> probeSampleTest = probeSamples;
-    #else/*ESVM_RANDOM_SUBSPACE_METHOD*/
-        size_t nESVM = nPatches * ESVM_RANDOM_SUBSPACE_METHOD;
-        std::vector<FeatureVector> probeSampleTest(nESVM);
+    std::vector<std::vector<FeatureVector> > probeSamples(nFrames);
+    #pragma omp parallel for schedule(dynamic, 1) if(nFrames > 1)
+    for (omp_size_t f = 0; f < (omp_size_t)nFrames; ++f)
+        probeSamples[f] = computeFeatures(rois[f]);
+    return scoreFeatures(probeSamples);
+}
+
+/*
+    Scores the patch features of every frame [frame][patch] against all positives with score fusion and normalization.
+    Scores are returned as [frame][pos].
+*/
+std::vector<std::vector<double> > esvmEnsemble::scoreFeatures(const std::vector<std::vector<FeatureVector> >& probeSamples) const
+{
+    return scoreFeatures(*getModels(), probeSamples);
+}
+
+std::vector<std::vector<double> > esvmEnsemble::scoreFeatures(const Models& models, const std::vector<std::vector<FeatureVector> >& probeSamples) const
+{
+    size_t nPositives = models.enrolledPositiveIDs.size();
+    size_t nPatches = getPatchCount();
+    size_t nFrames = probeSamples.size();
+
+    size_t nESVM = nPatches * getSubspaceCount();
+
+    // testing
+    size_t dimsProbes[3]{ nFrames, nESVM, nPositives };
+    xstd::mvector<3, double> scores(dimsProbes, 0.0);
+    std::vector<std::vector<double> > classificationScores(nFrames, std::vector<double>(nPositives, 0.0));
+    bool isAccumulatedScores = false;
+    if (!models.packedWeights.empty() && nFrames > 0) {
+        // batched scoring of patch features of all frames against all positives, subspace models being packed in the patch
+        // feature space (no subspace gather), probe features of a patch are shared by all its packed rows of subspaces
+        int nProbes = (int)nFrames;
+        cv::Mat probeFeatures = getProbeFeatures(models, probeSamples);
+        cv::Mat decisions = scorePackedModels(models, probeFeatures, nProbes, models.packedBias.rows / (int)nPatches);
+        if (config.isFoldedRSM()) {
+            // folded patch decisions already sum the (normalized) outputs of their subspaces, only the fusion average remains
+            for (size_t f = 0; f < nFrames; ++f)
+                for (size_t pos = 0; pos < nPositives; ++pos)
+                    for (size_t p = 0; p < nPatches; ++p)
+                        classificationScores[f][pos] += decisions.at<double>((int)p, (int)(f * nPositives + pos));
+        }
+        else {
+            // output and pre-fusion normalization of each decision by the kernel specialized for the configuration
+            scoreTermsKernel(decisions, models.EoESVM, scoreRefMinMeanSVM, scoreRefMaxStdDevSVM, classificationScores);
+        }
+        isAccumulatedScores = true;
+    }
+    else {
         #pragma omp parallel for
-        for (omp_size_t p = 0; p < nPatches; ++p)
-            for (size_t rs = 0; rs < ESVM_RANDOM_SUBSPACE_METHOD; ++rs) {
-                size_t iRS = p * ESVM_RANDOM_SUBSPACE_METHOD + rs;
-                probeSampleTest[iRS] = FeatureVector(ESVM_RANDOM_SUBSPACE_FEATURES);
-                for (size_t f = 0; f < ESVM_RANDOM_SUBSPACE_FEATURES; ++f)
-                    probeSampleTest[iRS][f] = probeSamples[p][rsmFeatureIndexes[rs][f]];
+        for (omp_size_t f = 0; f < (omp_size_t)nFrames; ++f) {
+            // prepare test samples
+            std::vector<FeatureVector> probeSubspaces;
+            if (config.useRandomSubspaces()) {
+                probeSubspaces.resize(nESVM);
+                for (size_t p = 0; p < nPatches; ++p)
+                    for (size_t rs = 0; rs < config.rsmCount; ++rs) {
+                        size_t iRS = p * config.rsmCount + rs;
+                        probeSubspaces[iRS] = FeatureVector(config.rsmFeatures);
+                        for (size_t i = 0; i < config.rsmFeatures; ++i)
+                            probeSubspaces[iRS][i] = probeSamples[f][p][rsmFeatureIndexes[rs][i]];
+                    }
             }
-    #endif/*ESVM_RANDOM_SUBSPACE_METHOD*/
+            const std::vector<FeatureVector>& probeSampleTest = config.useRandomSubspaces() ? probeSubspaces : probeSamples[f];
 
-    // testing, score fusion, normalization
-    size_t dimsProbes[2]{ nESVM, nPositives };
-    xstd::mvector<2, double> scores(dimsProbes, 0.0);
-    xstd::mvector<1, double> classificationScores(nPositives, 0.0);
-    for (size_t pos = 0; pos < nPositives; ++pos) {
-        for (size_t svm = 0; svm < nESVM; ++svm) {
-            scores[svm][pos] = EoESVM[svm][pos].predict(probeSampleTest[svm]);
-            #if   ESVM_SCORE_NORM_MODE == 3 || ESVM_SCORE_NORM_MODE == 5
-            scores[svm][pos] = normalize(MIN_MAX, scores[svm][pos], scoreMinSVM[svm],  scoreMaxSVM[svm],    ESVM_SCORE_NORM_CLIP);
-            #elif ESVM_SCORE_NORM_MODE == 4 || ESVM_SCORE_NORM_MODE == 6
-            scores[svm][pos] = normalize(Z_SCORE, scores[svm][pos], scoreMeanSVM[svm], scoreStdDevSVM[svm], ESVM_SCORE_NORM_CLIP);
-            #endif
-            classificationScores[pos] += scores[svm][pos];  // score accumulation for fusion
+            for (size_t svm = 0; svm < nESVM; ++svm)
+                for (size_t pos = 0; pos < nPositives; ++pos)
+                    scores[f][svm][pos] = models.EoESVM[svm][pos]->predict(probeSampleTest[svm]);
+        }
+    }
+
+    // score fusion, normalization
+    for (size_t f = 0; f < nFrames; ++f) {
+        for (size_t pos = 0; pos < nPositives; ++pos) {
+            for (size_t svm = 0; svm < nESVM && !isAccumulatedScores; ++svm)
+                classificationScores[f][pos] += normalizeScoreSVM(scores[f][svm][pos], svm);    // score accumulation for fusion
+            // average score fusion and normalization post-fusion
+            classificationScores[f][pos] = normalizeScoreFusion(classificationScores[f][pos] / (double)nESVM);
         }
-        classificationScores[pos] /= (double)nESVM;         // average score fusion and normalization post-fusion
-        #if   ESVM_SCORE_NORM_MODE == 1 || ESVM_SCORE_NORM_MODE == 5
-        classificationScores[pos] = normalize(MIN_MAX, classificationScores[pos], scoreMinFusion,  scoreMaxFusion,    ESVM_SCORE_NORM_CLIP);
-        #elif ESVM_SCORE_NORM_MODE == 2 || ESVM_SCORE_NORM_MODE == 6
-        classificationScores[pos] = normalize(Z_SCORE, classificationScores[pos], scoreMeanFusion, scoreStdDevFusion, ESVM_SCORE_NORM_CLIP);
-        #endif/*ESVM_SCORE_NORM_MODE*/
     }
     return classificationScores;
 }
@@ -440,18 +1239,20 @@ std::vector<double> esvmEnsemble::predict(const cv::Mat& roi)
 /*
     Saves to file each positive/patch ESVM model with trained parameters and support vectors.
 */
-bool esvmEnsemble::saveModels(const std::string& saveDirectory)
+bool esvmEnsemble::saveModels(const std::string& saveDirectory) const
 {
     if (!bfs::is_directory(saveDirectory))
         return false;
 
-    size_t nPositives = getPositiveCount();
+    std::shared_ptr<const Models> snapshot = getModels();
+    const Models& models = *snapshot;
+    size_t nPositives = models.enrolledPositiveIDs.size();
     size_t nPatches = getPatchCount();
     if (nPositives > 0 && nPatches > 0) {
         for (size_t pos = 0; pos < nPositives; ++pos) {
             for (size_t p = 0; p < nPatches; ++p) {
-                bfs::path file = bfs::path(saveDirectory) / (EoESVM[p][pos].ID + ".model");
-                EoESVM[p][pos].saveModelFile(file.string(), FileFormat::BINARY);
+                bfs::path file = bfs::path(saveDirectory) / (models.EoESVM[p][pos]->ID + ".model");
+                models.EoESVM[p][pos]->saveModelFile(file.string(), FileFormat::BINARY);
             }
         }
         return true;
@@ -459,4 +1260,341 @@ bool esvmEnsemble::saveModels(const std::string& saveDirectory)
     return false;
 }
 
+/* --- Ensemble archive value serialization helpers --- */
+
+static inline void writeArchiveInts(std::ofstream& file, const std::vector<int>& values)
+{
+    file.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(int));
+}
+static inline void writeNormValues(std::ofstream& file, const std::vector<FeatureVector>& values)
+{
+    int rows = (int)values.size();
+    int cols = rows > 0 ? (int)values[0].size() : 0;
+    writeArchiveInts(file, { rows, cols });
+    for (int r = 0; r < rows; ++r) {
+        ASSERT_THROW((int)values[r].size() == cols, "Normalization values must all have the same dimension to be archived");
+        file.write(reinterpret_cast<const char*>(values[r].data()), cols * sizeof(double));
+    }
+}
+static inline void writeNormValues(std::ofstream& file, const std::vector<double>& values)
+{
+    writeNormValues(file, std::vector<FeatureVector>{ values });
+}
+static inline void writeNormValues(std::ofstream& file, double value)
+{
+    writeNormValues(file, std::vector<FeatureVector>{ { value } });
+}
+
+template<typename T>
+static inline T readArchiveValue(const char*& cursor, const char* end)
+{
+    ASSERT_THROW(cursor + sizeof(T) <= end, "Unexpected end of ensemble archive file");
+    T value;
+    std::memcpy(&value, cursor, sizeof(T));
+    cursor += sizeof(T);
+    return value;
+}
+static inline void readNormValues(const char*& cursor, const char* end, std::vector<FeatureVector>& values)
+{
+    int rows = readArchiveValue<int>(cursor, end);
+    int cols = readArchiveValue<int>(cursor, end);
+    ASSERT_THROW(rows >= 0 && cols >= 0, "Invalid normalization values dimensions in ensemble archive file");
+    values = std::vector<FeatureVector>(rows, FeatureVector(cols));
+    for (int r = 0; r < rows; ++r)
+        for (int c = 0; c < cols; ++c)
+            values[r][c] = readArchiveValue<double>(cursor, end);
+}
+static inline void readNormValues(const char*& cursor, const char* end, std::vector<double>& values)
+{
+    std::vector<FeatureVector> rows;
+    readNormValues(cursor, end, rows);
+    ASSERT_THROW(rows.size() == 1, "Invalid normalization values dimensions in ensemble archive file");
+    values = rows[0];
+}
+static inline void readNormValues(const char*& cursor, const char* end, double& value)
+{
+    std::vector<double> values;
+    readNormValues(cursor, end, values);
+    ASSERT_THROW(values.size() == 1, "Invalid normalization values dimensions in ensemble archive file");
+    value = values[0];
+}
+
+/*
+    Saves the complete ensemble (constants, normalization values, RSM indexes, positive IDs and compiled models) to a single
+    BINARY archive file that can be memory-mapped with 'load' to restore the ensemble without retraining.
+
+    Expected data format and order:    <all reinterpreted as char*>
+
+        TYPE          QUANTITY                          VALUE
+        ========================================
+        (char)      | len(header)                     | 'ESVM_BINARY_HEADER_ENSEMBLE'
+        (int)       | 1                               | archive format version
+        (int)       | 11                              | image size, patch counts, HOG block size, block stride, cell size (w,h), HOG bins
+        (int)       | 5                               | feature norm mode, score norm mode, predict mode, RSM count, RSM features
+        (int)       | 4                               | feature norm clip, score norm clip, weights mode, ROI pre-process mode (v3)
+        (double)    | 1                               | ROI crop ratio (v3)
+        (int)       | 4                               | nESVM (patches x subspaces), nPositives, nFeatures, weights value size (4|8)
+        (int)       | 2 per container                 | rows, cols of each feature, pre-fusion then post-fusion score normalization container ...
+        (double)    | rows x cols per container       | ... followed by its values
+        (int)       | RSM count x RSM features        | random subspace feature indexes
+        (int)       | 1 per positive                  | length of positive ID ...
+        (char)      | len(ID) per positive            | ... followed by its characters
+        (int)       | nESVM x nPositives x 2          | class labels of each model as [svm][pos]
+        (double)    | nESVM x nPositives x 2          | probability parameters (probA, probB) of each model as [svm][pos]
+        (double)    | nESVM x nPositives              | compiled bias of each model as [svm][pos]
+        (char)      | [0, ESVM_ARCHIVE_ALIGNMENT[     | zero padding to align following weights
+        (esvmScalar)| nESVM x nPositives x nFeatures  | compiled weights of each model as rows [svm * nPositives + pos]
+*/
+bool esvmEnsemble::save(const std::string& filePath) const
+{
+    std::shared_ptr<const Models> snapshot = getModels();
+    const Models& models = *snapshot;
+    int nESVM = (int)models.EoESVM.size();
+    int nPositives = (int)models.enrolledPositiveIDs.size();
+    if (nESVM == 0 || nPositives == 0 || models.packedWeights.empty())
+        return false;
+
+    std::ofstream file(filePath, std::ios::out | std::ios::binary);
+    if (!file.is_open())
+        return false;
+
+    try
+    {
+        std::string headerStr = ESVM_BINARY_HEADER_ENSEMBLE;
+        file.write(headerStr.c_str(), headerStr.size());
+        writeArchiveInts(file, { ESVM_ARCHIVE_VERSION });
+        writeArchiveInts(file, { imageSize.width, imageSize.height, patchCounts.width, patchCounts.height,
+                                 blockSize.width, blockSize.height, blockStride.width, blockStride.height,
+                                 cellSize.width, cellSize.height, nBins });
+        writeArchiveInts(file, { config.featureNormMode, config.scoreNormMode, config.predictMode,
+                                 (int)config.rsmCount, (int)config.rsmFeatures });
+        writeArchiveInts(file, { (int)config.featureNormClip, (int)config.scoreNormClip, config.weightsMode, config.roiPreprocessMode });
+        file.write(reinterpret_cast<const char*>(&config.roiCropRatio), sizeof(double));
+        // compiled weights of each ESVM are archived in their own feature space (packed models may be scattered/folded subspaces)
+        size_t nFeatures = 0;
+        for (int svm = 0; svm < nESVM; ++svm)
+            for (int pos = 0; pos < nPositives; ++pos)
+                nFeatures = std::max(nFeatures, (size_t)models.EoESVM[svm][pos]->getWeights().cols);
+        writeArchiveInts(file, { nESVM, nPositives, (int)nFeatures, (int)sizeof(esvmScalar) });
+
+        if (config.featureNormMode != 0) {
+            writeNormValues(file, hogRefMinMean);
+            writeNormValues(file, hogRefMaxStdDev);
+        }
+        if (config.isScoreNormPreFusion()) {
+            writeNormValues(file, scoreRefMinMeanSVM);
+            writeNormValues(file, scoreRefMaxStdDevSVM);
+        }
+        if (config.isScoreNormPostFusion()) {
+            writeNormValues(file, scoreRefMinMeanFusion);
+            writeNormValues(file, scoreRefMaxStdDevFusion);
+        }
+
+        for (size_t rs = 0; rs < config.rsmCount; ++rs)
+            writeArchiveInts(file, std::vector<int>(rsmFeatureIndexes[rs].begin(), rsmFeatureIndexes[rs].end()));
+
+        for (int pos = 0; pos < nPositives; ++pos) {
+            writeArchiveInts(file, { (int)models.enrolledPositiveIDs[pos].size() });
+            file.write(models.enrolledPositiveIDs[pos].c_str(), models.enrolledPositiveIDs[pos].size());
+        }
+
+        std::vector<int> labels(nESVM * nPositives * 2);
+        std::vector<double> probability(nESVM * nPositives * 2);
+        std::vector<double> bias(nESVM * nPositives);
+        for (int svm = 0; svm < nESVM; ++svm) {
+            for (int pos = 0; pos < nPositives; ++pos) {
+                models.EoESVM[svm][pos]->getOutputParameters(&labels[(svm * nPositives + pos) * 2], &probability[(svm * nPositives + pos) * 2]);
+                bias[svm * nPositives + pos] = models.EoESVM[svm][pos]->getBias();
+            }
+        }
+        writeArchiveInts(file, labels);
+        file.write(reinterpret_cast<const char*>(probability.data()), probability.size() * sizeof(double));
+        file.write(reinterpret_cast<const char*>(bias.data()), bias.size() * sizeof(double));
+
+        size_t padding = (ESVM_ARCHIVE_ALIGNMENT - (size_t)file.tellp() % ESVM_ARCHIVE_ALIGNMENT) % ESVM_ARCHIVE_ALIGNMENT;
+        file.write(std::string(padding, '\0').c_str(), padding);
+        std::vector<esvmScalar> modelWeights(nFeatures);
+        for (int svm = 0; svm < nESVM; ++svm) {
+            for (int pos = 0; pos < nPositives; ++pos) {
+                // weights shorter than the feature count are zero-padded, as when packed
+                const cv::Mat& weights = models.EoESVM[svm][pos]->getWeights();
+                const esvmScalar* weightsRow = weights.ptr<esvmScalar>();
+                std::fill(std::copy(weightsRow, weightsRow + weights.cols, modelWeights.begin()), modelWeights.end(), (esvmScalar)0);
+                file.write(reinterpret_cast<const char*>(modelWeights.data()), nFeatures * sizeof(esvmScalar));
+            }
+        }
+        ASSERT_THROW(file.good(), "Invalid file stream status when writing ensemble archive");
+        file.close();
+    }
+    catch (std::exception& ex)
+    {
+        if (file.is_open())
+            file.close();
+        throw ex;
+    }
+    return true;
+}
+
+/*
+    Restores an ensemble saved with 'save' by memory-mapping the archive file.
+    Packed weights employed for scoring are directly viewed over the mapped file (zero-copy) when archived with the scoring
+    precision ('ESVM_USE_FLOAT32'), otherwise they are converted once. ESVM of the ensemble are compiled-only and refer to
+    their packed row (no SVM model nor weights copy, the archive mapping is kept valid as long as they refer to it).
+    Random subspace ESVM are repacked in their patch feature space after loading (no zero-copy view in that case).
+    Archived modes define the configuration of the loaded ensemble (version 2 archives keep default values for the others).
+*/
+esvmEnsemble esvmEnsemble::load(const std::string& filePath)
+{
+    namespace bip = boost::interprocess;
+    esvmEnsemble ensemble;
+    std::shared_ptr<Models> loadedModels = std::make_shared<Models>();
+    Models& models = *loadedModels;
+    try
+    {
+        models.archiveMapping = std::make_shared<bip::file_mapping>(filePath.c_str(), bip::read_only);
+        models.archiveRegion = std::make_shared<bip::mapped_region>(*models.archiveMapping, bip::read_only);
+    }
+    catch (bip::interprocess_exception& ex)
+    {
+        THROW("Failed to map the specified ensemble archive file: '" + filePath + "' [" + std::string(ex.what()) + "]");
+    }
+
+    const char* data = static_cast<const char*>(models.archiveRegion->get_address());
+    const char* end = data + models.archiveRegion->get_size();
+    const char* cursor = data;
+
+    std::string headerStr = ESVM_BINARY_HEADER_ENSEMBLE;
+    ASSERT_THROW(cursor + headerStr.size() <= end && std::memcmp(cursor, headerStr.c_str(), headerStr.size()) == 0,
+                 "Expected BINARY file header was not found");
+    cursor += headerStr.size();
+    int version = readArchiveValue<int>(cursor, end);
+    ASSERT_THROW(version == 2 || version == ESVM_ARCHIVE_VERSION, "Unsupported ensemble archive format version");
+
+    int dims[11];
+    for (int d = 0; d < 11; ++d)
+        dims[d] = readArchiveValue<int>(cursor, end);
+    ensemble.imageSize = cv::Size(dims[0], dims[1]);
+    ensemble.patchCounts = cv::Size(dims[2], dims[3]);
+    ensemble.blockSize = cv::Size(dims[4], dims[5]);
+    ensemble.blockStride = cv::Size(dims[6], dims[7]);
+    ensemble.cellSize = cv::Size(dims[8], dims[9]);
+    ensemble.nBins = dims[10];
+    ASSERT_THROW(ensemble.patchCounts.area() > 0, "Invalid patch counts in ensemble archive file");
+    ensemble.windowSize = cv::Size(ensemble.imageSize.width / ensemble.patchCounts.width, ensemble.imageSize.height / ensemble.patchCounts.height);
+
+    esvmConfig config;
+    config.featureNormMode = readArchiveValue<int>(cursor, end);
+    config.scoreNormMode = readArchiveValue<int>(cursor, end);
+    config.predictMode = readArchiveValue<int>(cursor, end);
+    int rsmCount = readArchiveValue<int>(cursor, end);
+    int rsmFeatures = readArchiveValue<int>(cursor, end);
+    ASSERT_THROW(rsmCount >= 0 && rsmFeatures >= 0, "Invalid RSM dimensions in ensemble archive file");
+    config.rsmCount = (size_t)rsmCount;
+    config.rsmFeatures = (size_t)rsmFeatures;
+    if (version > 2) {
+        config.featureNormClip = readArchiveValue<int>(cursor, end) != 0;
+        config.scoreNormClip = readArchiveValue<int>(cursor, end) != 0;
+        config.weightsMode = readArchiveValue<int>(cursor, end);
+        config.roiPreprocessMode = readArchiveValue<int>(cursor, end);
+        config.roiCropRatio = readArchiveValue<double>(cursor, end);
+    }
+    ensemble.setConfig(config);
+
+    int nESVM = readArchiveValue<int>(cursor, end);
+    int nPositives = readArchiveValue<int>(cursor, end);
+    int nFeatures = readArchiveValue<int>(cursor, end);
+    int weightSize = readArchiveValue<int>(cursor, end);
+    ASSERT_THROW((size_t)nESVM == (size_t)ensemble.patchCounts.area() * ensemble.getSubspaceCount(),
+                 "Ensemble archive ESVM count must match patches and subspaces");
+    ASSERT_THROW(nPositives > 0 && nFeatures > 0, "Ensemble archive must contain positives and features");
+    ASSERT_THROW(weightSize == sizeof(float) || weightSize == sizeof(double), "Invalid weights value size in ensemble archive file");
+
+    if (config.featureNormMode != 0) {
+        readNormValues(cursor, end, ensemble.hogRefMinMean);
+        readNormValues(cursor, end, ensemble.hogRefMaxStdDev);
+    }
+    if (config.isScoreNormPreFusion()) {
+        readNormValues(cursor, end, ensemble.scoreRefMinMeanSVM);
+        readNormValues(cursor, end, ensemble.scoreRefMaxStdDevSVM);
+    }
+    if (config.isScoreNormPostFusion()) {
+        readNormValues(cursor, end, ensemble.scoreRefMinMeanFusion);
+        readNormValues(cursor, end, ensemble.scoreRefMaxStdDevFusion);
+    }
+
+    if (config.useRandomSubspaces()) {
+        // subspace indexes are scattered into the patch feature space, they must refer to existing patch features
+        ASSERT_THROW((size_t)nFeatures <= config.rsmFeatures, "Ensemble archive subspace ESVM features exceed the RSM feature count");
+        int nPatchFeatures = (int)ensemble.getThreadHOG().getFeatureCount();
+        size_t dimsRSM[2]{ config.rsmCount, config.rsmFeatures };
+        ensemble.rsmFeatureIndexes = xstd::mvector<2, int>(dimsRSM, 0);
+        for (size_t rs = 0; rs < config.rsmCount; ++rs) {
+            for (size_t f = 0; f < config.rsmFeatures; ++f) {
+                int index = readArchiveValue<int>(cursor, end);
+                ASSERT_THROW(index >= 0 && index < nPatchFeatures, "Invalid RSM feature index in ensemble archive file");
+                ensemble.rsmFeatureIndexes[rs][f] = index;
+            }
+        }
+    }
+
+    models.enrolledPositiveIDs = std::vector<std::string>(nPositives);
+    for (int pos = 0; pos < nPositives; ++pos) {
+        int length = readArchiveValue<int>(cursor, end);
+        ASSERT_THROW(length >= 0 && cursor + length <= end, "Invalid positive ID in ensemble archive file");
+        models.enrolledPositiveIDs[pos] = std::string(cursor, length);
+        cursor += length;
+    }
+
+    size_t nModels = (size_t)nESVM * (size_t)nPositives;
+    std::vector<int> labels(nModels * 2);
+    std::vector<double> probability(nModels * 2);
+    for (size_t i = 0; i < labels.size(); ++i)
+        labels[i] = readArchiveValue<int>(cursor, end);
+    for (size_t i = 0; i < probability.size(); ++i)
+        probability[i] = readArchiveValue<double>(cursor, end);
+    models.packedBias = cv::Mat(nESVM, nPositives, CV_64F);
+    for (int svm = 0; svm < nESVM; ++svm)
+        for (int pos = 0; pos < nPositives; ++pos)
+            models.packedBias.at<double>(svm, pos) = readArchiveValue<double>(cursor, end);
+
+    // packed weights viewed directly over the aligned mapped memory, converted if archived with another precision
+    cursor += (ESVM_ARCHIVE_ALIGNMENT - (size_t)(cursor - data) % ESVM_ARCHIVE_ALIGNMENT) % ESVM_ARCHIVE_ALIGNMENT;
+    size_t packedSize = nModels * (size_t)nFeatures * (size_t)weightSize;
+    ASSERT_THROW(cursor <= end && (size_t)(end - cursor) == packedSize, "Ensemble archive file size does not match the expected packed models size");
+    cv::Mat archivedWeights((int)nModels, nFeatures, weightSize == sizeof(float) ? CV_32F : CV_64F, const_cast<char*>(cursor));
+    if (archivedWeights.type() == ESVM_CV_SCALAR)
+        models.packedWeights = archivedWeights;
+    else {
+        archivedWeights.convertTo(models.packedWeights, ESVM_CV_SCALAR);
+        models.archiveRegion.reset();
+        models.archiveMapping.reset();
+    }
+
+    // compiled-only ESVM viewing their packed row, the mapped archive (if still viewed) is kept valid by each of them
+    std::shared_ptr<const void> weightsOwner = models.archiveRegion;
+    size_t dimsESVM[2]{ (size_t)nESVM, (size_t)nPositives };
+    models.EoESVM = xstd::mvector<2, std::shared_ptr<const ESVM> >(dimsESVM);
+    for (int svm = 0; svm < nESVM; ++svm) {
+        for (int pos = 0; pos < nPositives; ++pos) {
+            size_t model = (size_t)svm * nPositives + pos;
+            std::string id = models.enrolledPositiveIDs[pos] + "-patch" + std::to_string(svm / ensemble.getSubspaceCount());
+            if (config.useRandomSubspaces())
+                id += "-rs" + std::to_string(svm % config.rsmCount);
+            models.EoESVM[svm][pos] = std::make_shared<ESVM>(models.packedWeights.row((int)model), models.packedBias.at<double>(svm, pos),
+                                                             &labels[model * 2], &probability[model * 2], weightsOwner, id, config);
+        }
+    }
+
+    // subspace models must be scattered/folded in their patch feature space for scoring (owned packing, archive unmapped)
+    if (config.useRandomSubspaces())
+        ensemble.packModels(models);
+    else
+        ensemble.boundPackedModels(models);
+    ensemble.publishModels(loadedModels);
+
+    ensemble.sampleFileExt = ".bin";
+    ensemble.sampleFileFormat = BINARY;
+    return ensemble;
+}
+
 //} // namespace esvm
@@ -0,0 +1,139 @@
+#include "esvmMappedSamples.h"
+
+#include "generic.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+//namespace esvm {
+
+/*
+    Maps the specified BINARY samples file and validates its content against the file size.
+
+    Expected data format and order:    <all reinterpreted as char*>
+
+        TYPE          QUANTITY                VALUE
+        ========================================
+        (char)      | len(header)           | 'header'
+        (int)       | 1                     | nSamples
+        (int)       | 1                     | nFeatures
+        (int)       | nSamples              | target outputs
+        (char)      | padding               | zeros up to the next 'ESVM_SAMPLES_FILE_ALIGNMENT' offset (aligned headers only)
+        (double)    | nSamples * nFeatures  | sample features (float if header is '*_FLOAT32')
+
+    Legacy files ('header', 'ESVM_BINARY_HEADER_SAMPLES_FLOAT32') have no padding, their features can be copied when unaligned.
+*/
+esvmMappedSamples::esvmMappedSamples(const std::string& filePath, const std::string& header)
+{
+    namespace bip = boost::interprocess;
+    try
+    {
+        fileMapping = std::make_shared<bip::file_mapping>(filePath.c_str(), bip::read_only);
+        mappedRegion = std::make_shared<bip::mapped_region>(*fileMapping, bip::read_only);
+    }
+    catch (bip::interprocess_exception& ex)
+    {
+        THROW("Failed to map the specified samples BINARY file: '" + filePath + "' [" + std::string(ex.what()) + "]");
+    }
+
+    const char* data = static_cast<const char*>(mappedRegion->get_address());
+    size_t fileSize = mappedRegion->get_size();
+    bool isFloat32 = false, isAligned = false;
+    size_t headerSize = matchHeader(data, fileSize, header, isFloat32, isAligned);
+    size_t featureSize = isFloat32 ? sizeof(float) : sizeof(double);
+    int featureType = isFloat32 ? CV_32F : CV_64F;
+    ASSERT_THROW(headerSize > 0, "Expected BINARY file header was not found");
+    ASSERT_THROW(fileSize >= headerSize + 2 * sizeof(int), "Samples BINARY file is too small to contain the expected header and counts");
+
+    int nSamples = 0, nFeatures = 0;
+    std::memcpy(&nSamples, data + headerSize, sizeof(int));
+    std::memcpy(&nFeatures, data + headerSize + sizeof(int), sizeof(int));
+    ASSERT_THROW(nSamples > 0, "Read number of samples should be greater than zero");
+    ASSERT_THROW(nFeatures > 0, "Read number of features should be greater than zero");
+
+    size_t targetsOffset = headerSize + 2 * sizeof(int);
+    size_t featuresOffset = getFeaturesOffset(headerSize, (size_t)nSamples, isAligned);
+    size_t expectedSize = featuresOffset + (size_t)nSamples * (size_t)nFeatures * featureSize;
+    ASSERT_THROW(fileSize == expectedSize, "Samples BINARY file size (" + std::to_string(fileSize) + " bytes) does not match " +
+                 "the expected size (" + std::to_string(expectedSize) + " bytes) for the read sample and feature counts");
+
+    // targets are few, always copied to avoid unaligned accesses
+    targetOutputs = std::vector<int>(nSamples);
+    std::memcpy(targetOutputs.data(), data + targetsOffset, (size_t)nSamples * sizeof(int));
+
+    // zero-copy view if features are aligned (always with aligned headers, mapped address is page aligned), otherwise single copy
+    const char* features = data + featuresOffset;
+    if (reinterpret_cast<uintptr_t>(features) % featureSize == 0)
+        samples = cv::Mat(nSamples, nFeatures, featureType, const_cast<char*>(features));
+    else {
+        samples = cv::Mat(nSamples, nFeatures, featureType);
+        std::memcpy(samples.data, features, (size_t)nSamples * (size_t)nFeatures * featureSize);
+        mappedRegion.reset();
+        fileMapping.reset();
+    }
+}
+
+/*
+    Matches the start of the data against the legacy 'header' and the other supported BINARY samples headers.
+    Returns the size of the matched header (zero if none matched) and the corresponding feature type and layout.
+*/
+size_t esvmMappedSamples::matchHeader(const char* data, size_t size, const std::string& header, bool& isFloat32, bool& isAligned)
+{
+    const std::string headers[] = { header, ESVM_BINARY_HEADER_SAMPLES_FLOAT32,
+                                    ESVM_BINARY_HEADER_SAMPLES_ALIGNED, ESVM_BINARY_HEADER_SAMPLES_ALIGNED_FLOAT32 };
+    for (size_t h = 0; h < sizeof(headers) / sizeof(headers[0]); ++h) {
+        if (size >= headers[h].size() && std::memcmp(data, headers[h].c_str(), headers[h].size()) == 0) {
+            isFloat32 = (h % 2 == 1);
+            isAligned = (h >= 2);
+            return headers[h].size();
+        }
+    }
+    return 0;
+}
+
+// Offset of the features block following the header, counts and targets (padded for aligned headers)
+size_t esvmMappedSamples::getFeaturesOffset(size_t headerSize, size_t nSamples, bool isAligned)
+{
+    size_t offset = headerSize + (2 + nSamples) * sizeof(int);
+    if (isAligned)
+        offset += (ESVM_SAMPLES_FILE_ALIGNMENT - offset % ESVM_SAMPLES_FILE_ALIGNMENT) % ESVM_SAMPLES_FILE_ALIGNMENT;
+    return offset;
+}
+
+// Verifies if the specified file starts with the expected BINARY header
+bool esvmMappedSamples::hasHeader(const std::string& filePath, const std::string& header)
+{
+    std::ifstream file(filePath, std::ios::in | std::ios::binary);
+    if (!file.is_open())
+        return false;
+    std::string fileHeader(header.size(), '\0');
+    file.read(&fileHeader[0], header.size());
+    return file.good() && fileHeader == header;
+}
+
+/*
+    Reads the sample and feature counts of a BINARY samples file and its feature value size (float32 or double) from its
+    header only, without mapping nor reading the samples (see the constructor for the expected formats).
+*/
+void esvmMappedSamples::readDimensions(const std::string& filePath, const std::string& header, size_t& nSamples, size_t& nFeatures,
+                                       size_t& featureSize)
+{
+    std::ifstream file(filePath, std::ios::in | std::ios::binary);
+    ASSERT_THROW(file.is_open(), "Failed to open the specified samples BINARY file: '" + filePath + "'");
+    std::string fileHeader(std::max(header.size(), std::string(ESVM_BINARY_HEADER_SAMPLES_ALIGNED_FLOAT32).size()), '\0');
+    file.read(&fileHeader[0], fileHeader.size());
+    bool isFloat32 = false, isAligned = false;
+    size_t headerSize = matchHeader(fileHeader.c_str(), (size_t)file.gcount(), header, isFloat32, isAligned);
+    ASSERT_THROW(headerSize > 0, "Expected BINARY file header was not found: '" + filePath + "'");
+    file.clear();
+    file.seekg(headerSize);
+    int counts[2] = { 0, 0 };
+    file.read(reinterpret_cast<char*>(counts), sizeof(counts));
+    ASSERT_THROW(file.good() && counts[0] > 0 && counts[1] > 0, "Invalid sample and feature counts in BINARY file: '" + filePath + "'");
+    nSamples = (size_t)counts[0];
+    nFeatures = (size_t)counts[1];
+    featureSize = isFloat32 ? sizeof(float) : sizeof(double);
+}
+
+//} // namespace esvm
@@ -0,0 +1,223 @@
+#include "esvmPipeline.h"
+
+#include "CommonCpp.h"
+
+#include <algorithm>
+
+//namespace esvm {
+
+/*
+    Starts the worker pools of each pipeline stage.
+    Feature extraction being the most expensive stage, it defaults ('nFeatureWorkers' = 0) to all remaining hardware threads.
+*/
+esvmPipeline::esvmPipeline(const esvmEnsemble& ensemble, size_t nPreprocessWorkers, size_t nFeatureWorkers, size_t nScoringWorkers,
+                           size_t queueCapacity)
+    : ensemble(ensemble), preprocessQueue(queueCapacity), featureQueue(queueCapacity), scoringQueue(queueCapacity),
+      accepting(true), running(true), pending(0)
+{
+    ASSERT_THROW(nPreprocessWorkers > 0 && nScoringWorkers > 0, "Pipeline requires at least one worker for each stage");
+    if (nFeatureWorkers == 0) {
+        size_t nThreads = (size_t)std::thread::hardware_concurrency();
+        nFeatureWorkers = std::max((size_t)1, nThreads > nPreprocessWorkers + nScoringWorkers
+                                            ? nThreads - nPreprocessWorkers - nScoringWorkers : (size_t)1);
+    }
+
+    for (size_t w = 0; w < nPreprocessWorkers; ++w)
+        workers.push_back(std::thread(&esvmPipeline::runPreprocess, this));
+    for (size_t w = 0; w < nFeatureWorkers; ++w)
+        workers.push_back(std::thread(&esvmPipeline::runFeatures, this));
+    for (size_t w = 0; w < nScoringWorkers; ++w)
+        workers.push_back(std::thread(&esvmPipeline::runScoring, this));
+}
+
+esvmPipeline::~esvmPipeline()
+{
+    stop();
+}
+
+/*
+    Stops accepting new ROIs, waits for all pending ROIs to be delivered and joins the workers.
+*/
+void esvmPipeline::stop()
+{
+    accepting = false;
+    for (int attempts = 0; pending.load() > 0; )
+        attempts = esvmQueueBackoff(attempts);
+    running = false;
+    for (size_t w = 0; w < workers.size(); ++w)
+        if (workers[w].joinable())
+            workers[w].join();
+    workers.clear();
+}
+
+/*
+    Submits a ROI for prediction, waiting while the pipeline is full. Scores against all positives are obtained from the future.
+*/
+std::future<std::vector<double> > esvmPipeline::submit(const cv::Mat& roi, int streamID)
+{
+    JobPtr job(new Job());
+    job->roi = roi;
+    job->streamID = streamID;
+    std::future<std::vector<double> > result = job->result.get_future();
+    enqueue(job, true);
+    return result;
+}
+
+/*
+    Submits a ROI for prediction, waiting while the pipeline is full. Scores are delivered to the callback from a scoring worker.
+*/
+void esvmPipeline::submit(const cv::Mat& roi, int streamID, const ResultCallback& callback)
+{
+    JobPtr job(new Job());
+    job->roi = roi;
+    job->streamID = streamID;
+    job->callback = callback;
+    enqueue(job, true);
+}
+
+/*
+    Submits a ROI for prediction only if the pipeline input queue is not full, returns false otherwise (ROI can be dropped).
+*/
+bool esvmPipeline::trySubmit(const cv::Mat& roi, int streamID, const ResultCallback& callback)
+{
+    JobPtr job(new Job());
+    job->roi = roi;
+    job->streamID = streamID;
+    job->callback = callback;
+    return enqueue(job, false);
+}
+
+/*
+    Pushes a submitted job to the preprocessing queue. The job is counted as pending before 'accepting' is checked so that
+    'stop' (which clears 'accepting' before waiting on 'pending') either waits for it or the submission is rolled back.
+*/
+bool esvmPipeline::enqueue(JobPtr& job, bool wait)
+{
+    ++pending;
+    if (!accepting.load()) {
+        --pending;
+        THROW("Pipeline is stopped and cannot accept new ROIs");
+    }
+    for (int attempts = 0; !preprocessQueue.tryPush(job); ) {
+        if (!wait) {
+            --pending;
+            return false;
+        }
+        attempts = esvmQueueBackoff(attempts);
+    }
+    return true;
+}
+
+// Pushes to the next stage queue, waiting for downstream workers as required (backpressure propagates to submissions)
+void esvmPipeline::push(esvmQueue<JobPtr>& queue, JobPtr& job)
+{
+    for (int attempts = 0; !queue.tryPush(job); )
+        attempts = esvmQueueBackoff(attempts);
+}
+
+void esvmPipeline::deliver(Job& job, const std::vector<double>& scores)
+{
+    if (job.callback) {
+        try {
+            job.callback(job.streamID, scores, job.error);
+        }
+        catch (std::exception& ex) {
+            logstream logger(LOGGER_FILE);
+            logger << "Pipeline result callback raised an exception: " << ex.what() << std::endl;
+        }
+    }
+    else if (job.error)
+        job.result.set_exception(job.error);
+    else
+        job.result.set_value(scores);
+    --pending;
+}
+
+void esvmPipeline::runPreprocess()
+{
+    JobPtr job;
+    for (int attempts = 0; running.load(); ) {
+        if (!preprocessQueue.tryPop(job)) {
+            attempts = esvmQueueBackoff(attempts);
+            continue;
+        }
+        attempts = 0;
+        try {
+            job->patches = ensemble.preprocessPatches(job->roi);
+        }
+        catch (...) {
+            job->error = std::current_exception();
+        }
+        job->roi.release();
+        push(featureQueue, job);
+    }
+}
+
+void esvmPipeline::runFeatures()
+{
+    JobPtr job;
+    for (int attempts = 0; running.load(); ) {
+        if (!featureQueue.tryPop(job)) {
+            attempts = esvmQueueBackoff(attempts);
+            continue;
+        }
+        attempts = 0;
+        if (!job->error) {
+            try {
+                job->features = ensemble.computePatchFeatures(job->patches, false);    // workers already use all cores
+            }
+            catch (...) {
+                job->error = std::current_exception();
+            }
+        }
+        job->patches.clear();
+        push(scoringQueue, job);
+    }
+}
+
+void esvmPipeline::runScoring()
+{
+    std::vector<JobPtr> batch;
+    std::vector<std::vector<FeatureVector> > probeSamples;
+    for (int attempts = 0; running.load(); ) {
+        // gather all probes already available (up to the batch size) to score them as a single probe matrix
+        JobPtr job;
+        while (batch.size() < ESVM_PIPELINE_SCORING_BATCH && scoringQueue.tryPop(job))
+            batch.push_back(std::move(job));
+        if (batch.empty()) {
+            attempts = esvmQueueBackoff(attempts);
+            continue;
+        }
+        attempts = 0;
+
+        probeSamples.clear();
+        for (size_t j = 0; j < batch.size(); ++j)
+            if (!batch[j]->error)
+                probeSamples.push_back(std::move(batch[j]->features));
+        std::vector<std::vector<double> > scores;
+        std::exception_ptr error;
+        try {
+            scores = ensemble.scoreFeatures(probeSamples);
+        }
+        catch (...) {
+            error = std::current_exception();
+        }
+
+        for (size_t j = 0, s = 0; j < batch.size(); ++j) {
+            if (batch[j]->error) {
+                deliver(*batch[j], std::vector<double>());
+                continue;
+            }
+            if (error) {
+                batch[j]->error = error;
+                deliver(*batch[j], std::vector<double>());
+            }
+            else
+                deliver(*batch[j], scores[s]);
+            ++s;
+        }
+        batch.clear();
+    }
+}
+
+//} // namespace esvm
@@ -6,6 +6,11 @@
 #include "esvmTypes.h"
 #include "esvmUtils.h"
 #include "esvm.h"
+#include "esvmEnsemble.h"
+#include "esvmPipeline.h"
+#include "esvmMappedSamples.h"
+#include "esvmDot.h"
+#include "esvmQueue.h"
 
 #include "feHOG.h"
 #if ESVM_HAS_FELBP
@@ -29,6 +34,11 @@ namespace bfs = boost::filesystem;
 #define DUMMY_SVM_MODEL_NCLASS 2
 #define DUMMY_SVM_MODEL_NFEATURES 3
 
+// parameters employed by 'dummy' ensemble builders for testing purposes (HOG parameters of 'esvmEnsemble::setConstants')
+#define DUMMY_ENSEMBLE_NNEGATIVES 40
+#define DUMMY_ENSEMBLE_RSM_FEATURES 32
+#define DUMMY_ENSEMBLE_ROI_SIZE 64
+
 // builds a dummy model with all valid parameters to test read/write procedures
 svm_model* buildDummyExemplarSvmModel(FreeModelState free_sv)
 {
@@ -194,6 +204,75 @@ bool generateDummySampleFile_binary(std::string filePath, size_t nSamples, size_
     return bfs::is_regular_file(filePath);
 }
 
+// configuration of a dummy ensemble without normalization, which only requires the files generated by 'generateDummyEnsembleFiles'
+esvmConfig buildDummyEnsembleConfig(size_t rsmCount, int predictMode)
+{
+    esvmConfig config;
+    config.predictMode = predictMode;
+    config.featureNormMode = 0;
+    config.scoreNormMode = 0;
+    config.rsmCount = rsmCount;
+    config.rsmFeatures = DUMMY_ENSEMBLE_RSM_FEATURES;
+    return config;
+}
+
+// generates negatives files of every patch (and random subspace indexes if required) expected by an ensemble in the directory
+// (only feature normalization modes with 'hardcoded' reference values are supported: raw or min-max overall)
+bool generateDummyEnsembleFiles(std::string directory, const esvmConfig& config, size_t nNegatives)
+{
+    if (config.featureNormMode > 1) return false;
+    std::string normName = config.featureNormMode == 0 ? "raw" : "normROI-minmax-overAll";
+    FeatureExtractorHOG hog(cv::Size(16, 16), cv::Size(2, 2), cv::Size(2, 2), cv::Size(2, 2), 3);
+    size_t nFeatures = (size_t)hog.getFeatureCount();
+    std::vector<FeatureVector> samples;
+    std::vector<int> outputs;
+    generateDummySamples(samples, outputs, nNegatives, nFeatures);
+    for (size_t p = 0; p < 9; ++p) {
+        std::string filePath = directory + "negatives-" + normName + "-patch" + std::to_string(p) + ".bin";
+        ESVM::writeSampleDataFile(filePath, samples, outputs, BINARY);
+        if (!bfs::is_regular_file(filePath)) return false;
+    }
+    if (!config.useRandomSubspaces()) return true;
+
+    // evenly spaced features with a distinct offset for each subspace, listed as non-zero values of dense LIBSVM samples
+    size_t step = nFeatures / config.rsmFeatures;
+    if (step < config.rsmCount) return false;
+    std::ofstream rsmFile(directory + "rsm-indexes.data");
+    if (!rsmFile) return false;
+    for (size_t rs = 0; rs < config.rsmCount; ++rs) {
+        rsmFile << std::to_string(ESVM_POSITIVE_CLASS);
+        for (size_t f = 0; f < nFeatures; ++f)
+            rsmFile << " " << f + 1 << ":" << (f % step == rs && f / step < config.rsmFeatures ? 1 : 0);
+        rsmFile << std::endl;
+    }
+    return true;
+}
+
+// generates random grayscale images employed as ROI of a dummy ensemble (distinct images on each call)
+std::vector<cv::Mat> generateDummyROIs(size_t nROIs)
+{
+    std::vector<cv::Mat> rois(nROIs);
+    for (size_t r = 0; r < nROIs; ++r) {
+        rois[r] = cv::Mat(DUMMY_ENSEMBLE_ROI_SIZE, DUMMY_ENSEMBLE_ROI_SIZE, CV_8UC1);
+        cv::randu(rois[r], 0, 256);
+    }
+    return rois;
+}
+
+// builds a dummy ensemble of single representation positives identified as 'ID<index>', trained against generated files
+esvmEnsemble buildDummyEnsemble(std::string directory, size_t nPositives, const esvmConfig& config)
+{
+    ASSERT_THROW(generateDummyEnsembleFiles(directory, config, DUMMY_ENSEMBLE_NNEGATIVES), "Failed to generate dummy ensemble files");
+    std::vector<cv::Mat> rois = generateDummyROIs(nPositives);
+    std::vector<std::vector<cv::Mat> > positiveROIs(nPositives);
+    std::vector<std::string> positiveIDs(nPositives);
+    for (size_t pos = 0; pos < nPositives; ++pos) {
+        positiveROIs[pos] = { rois[pos] };
+        positiveIDs[pos] = "ID" + std::to_string(pos);
+    }
+    return esvmEnsemble(positiveROIs, directory, positiveIDs, {}, config);
+}
+
 void displayHeader()
 {
     logstream logger(LOGGER_FILE);
@@ -223,6 +302,14 @@ void displayOptions()
            << tab << tab << "ESVM_ROI_CROP_RATIO:                             " << ESVM_ROI_CROP_RATIO << std::endl
            << tab << tab << "ESVM_ROI_PREPROCESS_MODE:                        " << ESVM_ROI_PREPROCESS_MODE << std::endl
            << tab << tab << "ESVM_WEIGHTS_MODE:                               " << ESVM_WEIGHTS_MODE << std::endl
+           << tab << tab << "ESVM_SOLVER_MODE:                                " << ESVM_SOLVER_MODE << std::endl
+           << tab << tab << "ESVM_WARM_START:                                 " << ESVM_WARM_START << std::endl
+           << tab << tab << "ESVM_HARD_NEGATIVE_MINING:                       " << ESVM_HARD_NEGATIVE_MINING << std::endl
+           << tab << tab << "ESVM_HARD_NEGATIVE_MINING_ITERATIONS:            " << ESVM_HARD_NEGATIVE_MINING_ITERATIONS << std::endl
+           << tab << tab << "ESVM_HARD_NEGATIVE_MINING_BATCH:                 " << ESVM_HARD_NEGATIVE_MINING_BATCH << std::endl
+           #if ESVM_USE_LIBLINEAR
+           << tab << tab << "ESVM_LIBLINEAR_BIAS:                             " << ESVM_LIBLINEAR_BIAS << std::endl
+           #endif/*ESVM_USE_LIBLINEAR*/
            << tab << tab << "ESVM_FEATURE_NORM_MODE:                          " << ESVM_FEATURE_NORM_MODE << std::endl
            << tab << tab << "ESVM_FEATURE_NORM_CLIP:                          " << ESVM_FEATURE_NORM_CLIP << std::endl
            << tab << tab << "ESVM_SCORE_NORM_MODE:                            " << ESVM_SCORE_NORM_MODE << std::endl
@@ -253,6 +340,26 @@ void displayOptions()
            << tab << tab << "TEST_ESVM_MODEL_STRUCT_SVM_PARAMS:               " << TEST_ESVM_MODEL_STRUCT_SVM_PARAMS << std::endl
            << tab << tab << "TEST_ESVM_MODEL_MEMORY_OPERATIONS:               " << TEST_ESVM_MODEL_MEMORY_OPERATIONS << std::endl
            << tab << tab << "TEST_ESVM_MODEL_MEMORY_PARAM_CHECK:              " << TEST_ESVM_MODEL_MEMORY_PARAM_CHECK << std::endl
+           << tab << tab << "TEST_ESVM_COMPILED_MODEL_PREDICT:                " << TEST_ESVM_COMPILED_MODEL_PREDICT << std::endl
+           << tab << tab << "TEST_ESVM_PREDICT_BATCH:                         " << TEST_ESVM_PREDICT_BATCH << std::endl
+           << tab << tab << "TEST_ESVM_PRECOMPUTED_KERNEL_TRAINING:           " << TEST_ESVM_PRECOMPUTED_KERNEL_TRAINING << std::endl
+           << tab << tab << "TEST_ESVM_SHARED_FEATURE_NODES_TRAINING:         " << TEST_ESVM_SHARED_FEATURE_NODES_TRAINING << std::endl
+           << tab << tab << "TEST_ESVM_READ_SAMPLES_FILE_MAPPED:              " << TEST_ESVM_READ_SAMPLES_FILE_MAPPED << std::endl
+           << tab << tab << "TEST_ESVM_FLOAT32_PRECISION:                     " << TEST_ESVM_FLOAT32_PRECISION << std::endl
+           << tab << tab << "TEST_ESVM_DOT_PRODUCT_KERNELS:                   " << TEST_ESVM_DOT_PRODUCT_KERNELS << std::endl
+           << tab << tab << "TEST_ESVM_PIPELINE_QUEUE:                        " << TEST_ESVM_PIPELINE_QUEUE << std::endl
+           << tab << tab << "TEST_ESVM_RUNTIME_CONFIG:                        " << TEST_ESVM_RUNTIME_CONFIG << std::endl
+           << tab << tab << "TEST_ESVM_SOLVER_BENCHMARK:                      " << TEST_ESVM_SOLVER_BENCHMARK << std::endl
+           << tab << tab << "TEST_ESVM_WARM_START_TRAINING:                   " << TEST_ESVM_WARM_START_TRAINING << std::endl
+           << tab << tab << "TEST_ESVM_HARD_NEGATIVE_MINING:                  " << TEST_ESVM_HARD_NEGATIVE_MINING << std::endl
+           << tab << tab << "TEST_ESVM_ENSEMBLE_ARCHIVE:                      " << TEST_ESVM_ENSEMBLE_ARCHIVE << std::endl
+           << tab << tab << "TEST_ESVM_ENSEMBLE_CASCADE:                      " << TEST_ESVM_ENSEMBLE_CASCADE << std::endl
+           << tab << tab << "TEST_ESVM_ENSEMBLE_TOP_K:                        " << TEST_ESVM_ENSEMBLE_TOP_K << std::endl
+           << tab << tab << "TEST_ESVM_ENSEMBLE_ENROLLMENT:                   " << TEST_ESVM_ENSEMBLE_ENROLLMENT << std::endl
+           << tab << tab << "TEST_ESVM_ENSEMBLE_CONCURRENT_UPDATES:           " << TEST_ESVM_ENSEMBLE_CONCURRENT_UPDATES << std::endl
+           << tab << tab << "TEST_ESVM_ENSEMBLE_PACKED_SCORING:               " << TEST_ESVM_ENSEMBLE_PACKED_SCORING << std::endl
+           << tab << tab << "TEST_ESVM_ENSEMBLE_TRACK_PREDICT:                " << TEST_ESVM_ENSEMBLE_TRACK_PREDICT << std::endl
+           << tab << tab << "TEST_ESVM_ENSEMBLE_PIPELINE:                     " << TEST_ESVM_ENSEMBLE_PIPELINE << std::endl
            << tab << "PROCEDURES:" << std::endl
            << tab << tab << "PROC_READ_DATA_FILES:                            " << displayAsBinary<8>(PROC_READ_DATA_FILES, true) << std::endl
            << tab << tab << "PROC_WRITE_DATA_FILES:                           " << PROC_WRITE_DATA_FILES << std::endl
@@ -1708,12 +1815,15 @@ int test_ESVM_SaveLoadModelFile_binary()
     std::string wrongModelFileName = testDir + "test_wrong-model-binary.model";
     svm_model* validModel;
     FeatureVector validSample({ 0.55, 0.70, 0.22 });
+    double validScore = 0;
+    double tolerance = ESVM_USE_FLOAT32 ? 0.0001 : 0.000001;    // weights are stored as 'esvmScalar'
 
     try
     {
         logger << "Generating dummy test model file (BINARY) for functionality evaluation..." << std::endl;
         validModel = buildDummyExemplarSvmModel();
         ESVM esvmValid(validModel, "TEST-VALID");
+        validScore = esvmValid.predict(validSample);
         ASSERT_LOG(esvmValid.saveModelFile(validModelFileName, BINARY),
                    "Valid BINARY pre-trained model file loading should not have returned a failure status");
     }
@@ -1769,7 +1879,18 @@ int test_ESVM_SaveLoadModelFile_binary()
 
     try
     {
-        esvmLoaded.predict(validSample);  // call test to ensure file loading provided a working model
+        // call test to ensure file loading provided a working model, identical to the saved one
+        double loadedScore = esvmLoaded.predict(validSample);
+        ASSERT_LOG(doubleAlmostEquals(loadedScore, validScore, tolerance), "Model loaded from BINARY file should predict as the saved model (expected: " +
+                   std::to_string(validScore) + ", obtained: " + std::to_string(loadedScore) + ")");
+
+        // weights value size field follows the header and 5 'int' fields (see 'saveModelFile_binary')
+        std::ifstream validFile(validModelFileName, std::ios::in | std::ios::binary);
+        int valueSize = 0;
+        validFile.seekg(std::string(ESVM_BINARY_HEADER_MODEL).size() + 5 * sizeof(int));
+        validFile.read(reinterpret_cast<char*>(&valueSize), sizeof(int));
+        ASSERT_LOG(validFile.good() && valueSize == (int)sizeof(esvmScalar), "BINARY model file weights should be stored as 'esvmScalar' (value size: " +
+                   std::to_string(valueSize) + ")");
     }
     catch (std::exception& ex)
     {
@@ -1779,6 +1900,71 @@ int test_ESVM_SaveLoadModelFile_binary()
         return passThroughDisplayTestStatus(__func__, -5);
     }
 
+    // corrupted (changed weight byte) and incomplete (truncated) model files must be rejected by the checksum or size checks
+    std::string corruptModelFileName = testDir + "test_corrupt-model-binary.model";
+    std::string truncatedModelFileName = testDir + "test_truncated-model-binary.model";
+    {
+        std::ifstream validFile(validModelFileName, std::ios::in | std::ios::binary);
+        std::string content((std::istreambuf_iterator<char>(validFile)), std::istreambuf_iterator<char>());
+        std::string corruptContent = content;
+        corruptContent[corruptContent.size() - sizeof(uint32_t) - 1] ^= 0x10;
+        std::ofstream(corruptModelFileName, std::ios::out | std::ios::binary) << corruptContent;
+        std::ofstream(truncatedModelFileName, std::ios::out | std::ios::binary) << content.substr(0, content.size() / 2);
+    }
+    for (std::string invalidModelFileName : { corruptModelFileName, truncatedModelFileName }) {
+        try
+        {
+            ESVM esvmInvalid;
+            esvmInvalid.loadModelFile(invalidModelFileName, BINARY);
+            logger << "Loading an invalid BINARY model file should have raised an exception: '" << invalidModelFileName << "'" << std::endl;
+            bfs::remove_all(testDir);
+            return passThroughDisplayTestStatus(__func__, -6);
+        }
+        catch (...) {}  // expected exception
+    }
+
+    // legacy model files of raw LIBSVM support vector nodes (previous BINARY format) must load the same decision function
+    #if ESVM_USE_LIBSVM
+    std::string legacyModelFileName = testDir + "test_legacy-model-binary.model";
+    try
+    {
+        double rho = 0.25;
+        int labels[2]{ ESVM_POSITIVE_CLASS, ESVM_NEGATIVE_CLASS };
+        int nSV[2]{ 1, 1 };
+        int nFeatures = 3;
+        double coefficients[2]{ 1.0, -0.5 };
+        svm_node nodesSV[2][3]{ { { 1, 0.50 }, { 2, 0.75 }, { 3, 0.25 } }, { { 1, 0.20 }, { 2, 0.75 }, { 3, 0.10 } } };
+        std::string headerStr = ESVM_BINARY_HEADER_MODEL_LIBSVM;
+        std::ofstream legacyFile(legacyModelFileName, std::ios::out | std::ios::binary);
+        legacyFile.write(headerStr.c_str(), headerStr.size());
+        legacyFile.write(reinterpret_cast<const char*>(&rho), sizeof(rho));
+        legacyFile.write(reinterpret_cast<const char*>(labels), sizeof(labels));
+        legacyFile.write(reinterpret_cast<const char*>(nSV), sizeof(nSV));
+        legacyFile.write(reinterpret_cast<const char*>(&nFeatures), sizeof(nFeatures));
+        legacyFile.write(reinterpret_cast<const char*>(coefficients), sizeof(coefficients));
+        legacyFile.write(reinterpret_cast<const char*>(nodesSV), sizeof(nodesSV));
+        legacyFile.close();
+
+        FeatureVector legacyWeights(nFeatures);
+        for (int f = 0; f < nFeatures; ++f)
+            legacyWeights[f] = coefficients[0] * nodesSV[0][f].value + coefficients[1] * nodesSV[1][f].value;
+        ESVM esvmExpected(legacyWeights.data(), legacyWeights.size(), -rho, labels, nullptr, "TEST-LEGACY-EXPECTED");
+        ESVM esvmLegacy;
+        ASSERT_LOG(esvmLegacy.loadModelFile(legacyModelFileName, BINARY), "Loading legacy BINARY model file should have returned a success");
+        double legacyScore = esvmLegacy.predict(validSample);
+        double expectedScore = esvmExpected.predict(validSample);
+        ASSERT_LOG(doubleAlmostEquals(legacyScore, expectedScore, tolerance), "Model loaded from legacy BINARY file should predict its "
+                   "support vectors decision function (expected: " + std::to_string(expectedScore) + ", obtained: " + std::to_string(legacyScore) + ")");
+    }
+    catch (std::exception& ex)
+    {
+        logger << "Valid legacy BINARY formatted model file should not have raised an exception." << std::endl
+               << "Exception: [" << ex.what() << "]" << std::endl;
+        bfs::remove_all(testDir);
+        return passThroughDisplayTestStatus(__func__, -7);
+    }
+    #endif/*ESVM_USE_LIBSVM*/
+
     bfs::remove_all(testDir);
 
     #else/*TEST_ESVM_SAVE_LOAD_MODEL_FILE_PARSER*/
@@ -1809,6 +1995,7 @@ int test_ESVM_SaveLoadModelFile_compare()
         FeatureVector{ 0.15, 0.30, 0.75, 0.10, 0.20 }
     };
     std::vector<int> trainingLabels{ ESVM_POSITIVE_CLASS, ESVM_NEGATIVE_CLASS, ESVM_NEGATIVE_CLASS, ESVM_NEGATIVE_CLASS, ESVM_NEGATIVE_CLASS };
+    double binaryTolerance = ESVM_USE_FLOAT32 ? 0.0001 : 0.000001;     // BINARY weights are stored as 'esvmScalar'
 
     try
     {
@@ -1829,13 +2016,13 @@ int test_ESVM_SaveLoadModelFile_compare()
                    std::to_string(scoreRef) + ", score_libsvm: " + std::to_string(score_libsvm) + ")");
         esvmLoad_binary.loadModelFile(validModelFileName_binary, BINARY);
         double score_binary = esvmLoad_binary.predict(probe);
-        ASSERT_LOG(doubleAlmostEquals(scoreRef, score_binary, 0.000001),
+        ASSERT_LOG(doubleAlmostEquals(scoreRef, score_binary, binaryTolerance),
                    "Loaded BINARY format model file should result in same score as reference model trained from samples (scoreRef: " +
                    std::to_string(scoreRef) + ", score_libsvm: " + std::to_string(score_binary) + ")");
         // re-load already trained model with swapped formats and compare results
         esvmLoad_libsvm.loadModelFile(validModelFileName_binary, BINARY);
         double score_libsvm_swap = esvmLoad_libsvm.predict(probe);
-        ASSERT_LOG(doubleAlmostEquals(scoreRef, score_libsvm_swap, 0.000001),
+        ASSERT_LOG(doubleAlmostEquals(scoreRef, score_libsvm_swap, binaryTolerance),
                    "Re-loaded model file from different BINARY format should still result in same reference score (scoreRef: " +
                    std::to_string(scoreRef) + ", score_libsvm_swap: " + std::to_string(score_libsvm_swap) + ")");
         esvmLoad_binary.loadModelFile(validModelFileName_libsvm, LIBSVM);
@@ -2271,6 +2458,1506 @@ int test_ESVM_ModelMemoryParamCheck()
     return passThroughDisplayTestStatus(__func__, PASSED);
 }
 
+// Test equivalence of predictions between the compiled linear model and the SVM library decision function
+int test_ESVM_CompiledModelPredict()
+{
+    #if TEST_ESVM_COMPILED_MODEL_PREDICT
+    logstream logger(LOGGER_FILE);
+    logger << "Running '" << __func__ << "' test..." << std::endl;
+
+    #if !ESVM_USE_COMPILED_MODEL
+    logger << "Warning: '" << __func__ << "' disabled because 'ESVM_USE_COMPILED_MODEL' is not enabled..." << std::endl;
+    #else/*ESVM_USE_COMPILED_MODEL*/
+
+    std::vector<FeatureVector> probes{ { 0.55, 0.70, 0.22 }, { 0.10, 0.90, 0.80 }, { 0.00, 0.00, 0.00 }, { 1.00, 0.25, 0.50 } };
+    svm_model* model = buildDummyExemplarSvmModel();
+    try
+    {
+        ESVM esvm(model, "TEST-COMPILED");
+        ASSERT_LOG(esvm.isModelCompiled(), "Pre-trained LINEAR model should have been compiled to a single weight vector");
+        ASSERT_LOG(doubleAlmostEquals(esvm.getBias(), -model->rho[0]), "Compiled model bias should be the negated decision function constant");
+
+        for (size_t p = 0; p < probes.size(); ++p) {
+            // reference decision function evaluated by the SVM library over all support vectors
+            std::vector<svm_node> nodes(probes[p].size() + 1);
+            for (size_t f = 0; f < probes[p].size(); ++f) {
+                nodes[f].index = (int)f + 1;
+                nodes[f].value = probes[p][f];
+            }
+            nodes[probes[p].size()].index = -1;
+            double decision = 0;
+            double label = svm_predict_values(model, nodes.data(), &decision);
+
+            #if   ESVM_PREDICT_MODE == 0
+            double expected = decision;
+            #elif ESVM_PREDICT_MODE == 1
+            double expected = label;
+            #elif ESVM_PREDICT_MODE == 2
+            double expected = 0;
+            svm_predict_probability(model, nodes.data(), &expected);
+            #endif/*ESVM_PREDICT_MODE*/
+
+            double score = esvm.predict(probes[p]);
+            ASSERT_LOG(doubleAlmostEquals(score, expected, 0.000001), "Compiled model prediction should match the SVM library prediction (probe: " +
+                       std::to_string(p) + ", expected: " + std::to_string(expected) + ", obtained: " + std::to_string(score) + ")");
+        }
+
+        // copy must preserve the compiled weights
+        ESVM esvmCopy(esvm);
+        ASSERT_LOG(esvmCopy.isModelCompiled(), "Copied ESVM should preserve the compiled model");
+        const cv::Mat& weights = esvm.getWeights();
+        ASSERT_LOG(esvmCopy.getWeights().cols == weights.cols &&
+                   std::equal(weights.ptr<esvmScalar>(), weights.ptr<esvmScalar>() + weights.cols, esvmCopy.getWeights().ptr<esvmScalar>()),
+                   "Copied ESVM should have identical compiled weights");
+
+        // ESVM built from compiled weights have support vectors of distinct lengths, deep copy must follow each of them
+        std::vector<double> compiledWeights(weights.ptr<esvmScalar>(), weights.ptr<esvmScalar>() + weights.cols);
+        int labels[2];
+        double probability[2];
+        esvm.getOutputParameters(labels, probability);
+        ESVM esvmWeights(compiledWeights.data(), compiledWeights.size(), esvm.getBias(), labels, probability, "TEST-COMPILED-WEIGHTS");
+        ESVM esvmWeightsCopy(esvmWeights);
+        for (size_t p = 0; p < probes.size(); ++p)
+            ASSERT_LOG(doubleAlmostEquals(esvmWeightsCopy.predict(probes[p]), esvmWeights.predict(probes[p])),
+                       "Copied ESVM built from compiled weights should predict identically (probe: " + std::to_string(p) + ")");
+
+        // compiled-only ESVM refer to the weights without SVM model, predictions and solution must remain identical
+        ESVM esvmCompiledOnly(weights, esvm.getBias(), labels, probability, nullptr, "TEST-COMPILED-ONLY");
+        ASSERT_LOG(esvmCompiledOnly.isModelTrained() && esvmCompiledOnly.isModelCompiled(), "Compiled-only ESVM should be usable for prediction");
+        ASSERT_LOG(esvmCompiledOnly.getWeights().data == weights.data, "Compiled-only ESVM should refer to the specified weights without copy");
+        ASSERT_LOG(esvmCompiledOnly.getSolution().size() == (size_t)weights.cols + 1, "Compiled-only ESVM solution should contain weights and bias");
+        for (size_t p = 0; p < probes.size(); ++p)
+            ASSERT_LOG(doubleAlmostEquals(esvmCompiledOnly.predict(probes[p]), esvm.predict(probes[p])),
+                       "Compiled-only ESVM should predict identically (probe: " + std::to_string(p) + ")");
+    }
+    catch (std::exception& ex)
+    {
+        logger << "Valid test procedures should not have raised an exception." << std::endl
+               << "Exception: [" << ex.what() << "]" << std::endl;
+        ESVM::destroyModel(&model);
+        return passThroughDisplayTestStatus(__func__, -1);
+    }
+    ESVM::destroyModel(&model);
+
+    #endif/*ESVM_USE_COMPILED_MODEL*/
+    #else/*TEST_ESVM_COMPILED_MODEL_PREDICT*/
+    return passThroughDisplayTestStatus(__func__, SKIPPED);
+    #endif/*TEST_ESVM_COMPILED_MODEL_PREDICT*/
+    return passThroughDisplayTestStatus(__func__, PASSED);
+}
+
+// Test equivalence of batch predictions (matrix/vector of probes, sequential/parallel) against single probe predictions
+int test_ESVM_PredictBatch(size_t nSamples)
+{
+    #if TEST_ESVM_PREDICT_BATCH
+    logstream logger(LOGGER_FILE);
+    logger << "Running '" << __func__ << "' test..." << std::endl;
+
+    std::vector<FeatureVector> probes;
+    std::vector<int> probeTargets;
+    generateDummySamples(probes, probeTargets, nSamples, DUMMY_SVM_MODEL_NFEATURES);
+    svm_model* model = buildDummyExemplarSvmModel();
+    try
+    {
+        ESVM esvm(model, "TEST-BATCH");
+        cv::Mat probes64F((int)nSamples, DUMMY_SVM_MODEL_NFEATURES, CV_64F), probes32F;
+        for (size_t p = 0; p < nSamples; ++p)
+            for (int f = 0; f < DUMMY_SVM_MODEL_NFEATURES; ++f)
+                probes64F.at<double>((int)p, f) = probes[p][f];
+        probes64F.convertTo(probes32F, CV_32F);
+
+        std::vector<double> scores64F(nSamples), scores32F(nSamples);
+        esvm.predictBatch(probes64F, scores64F.data());
+        esvm.predictBatch(probes32F, scores32F.data());
+        std::vector<double> scoresVector = esvm.predict(probes);
+        for (size_t p = 0; p < nSamples; ++p) {
+            double score = esvm.predict(probes[p]);
+            ASSERT_LOG(doubleAlmostEquals(score, scores64F[p]), "Batch prediction (CV_64F) should match single probe prediction (probe: " + std::to_string(p) + ")");
+            ASSERT_LOG(doubleAlmostEquals(score, scoresVector[p]), "Vector prediction should match single probe prediction (probe: " + std::to_string(p) + ")");
+            ASSERT_LOG(doubleAlmostEquals(score, scores32F[p], 0.0001), "Batch prediction (CV_32F) should match single probe prediction (probe: " + std::to_string(p) + ")");
+        }
+    }
+    catch (std::exception& ex)
+    {
+        logger << "Valid test procedures should not have raised an exception." << std::endl
+               << "Exception: [" << ex.what() << "]" << std::endl;
+        ESVM::destroyModel(&model);
+        return passThroughDisplayTestStatus(__func__, -1);
+    }
+    ESVM::destroyModel(&model);
+    try
+    {
+        // invalid batch predictions must fail before their parallel region (exceptions cannot propagate out of it)
+        ESVM untrainedESVM;
+        std::vector<double> scores(nSamples);
+        untrainedESVM.predictBatch(cv::Mat((int)nSamples, DUMMY_SVM_MODEL_NFEATURES, CV_64F, 0.0), scores.data());
+        logger << "Error: Batch prediction with an untrained ESVM should have generated an exception." << std::endl;
+        return passThroughDisplayTestStatus(__func__, -2);
+    }
+    catch (...) {}
+    try
+    {
+        ESVM untrainedESVM;
+        untrainedESVM.predict(probes);
+        logger << "Error: Vector prediction with an untrained ESVM should have generated an exception." << std::endl;
+        return passThroughDisplayTestStatus(__func__, -3);
+    }
+    catch (...) {}
+
+    #else/*TEST_ESVM_PREDICT_BATCH*/
+    return passThroughDisplayTestStatus(__func__, SKIPPED);
+    #endif/*TEST_ESVM_PREDICT_BATCH*/
+    return passThroughDisplayTestStatus(__func__, PASSED);
+}
+
+// Test equivalence of ESVM trained with a shared precomputed kernel and ESVM trained directly from feature vectors
+int test_ESVM_PrecomputedKernelTraining()
+{
+    #if TEST_ESVM_PRECOMPUTED_KERNEL_TRAINING
+    logstream logger(LOGGER_FILE);
+    logger << "Running '" << __func__ << "' test..." << std::endl;
+
+    #if !ESVM_USE_LIBSVM
+    logger << "Warning: '" << __func__ << "' disabled because precomputed kernel training is only available with LIBSVM..." << std::endl;
+    #else/*ESVM_USE_LIBSVM*/
+
+    // two exemplars sharing the kernel rows of the same negatives, each with one additional negative in its own exemplar columns
+    size_t nNegatives = 50, nFeatures = 16;
+    std::vector<FeatureVector> samples;
+    std::vector<int> targets;
+    generateDummySamples(samples, targets, nNegatives + 4, nFeatures);
+    cv::Mat negatives((int)nNegatives, (int)nFeatures, CV_64F);
+    for (size_t neg = 0; neg < nNegatives; ++neg)
+        std::copy(samples[neg].begin(), samples[neg].end(), negatives.ptr<double>((int)neg));
+
+    svmFeature** kernelRows = ESVM::makePrecomputedKernel(negatives, 4);
+    try
+    {
+        for (size_t pos = 0; pos < 2; ++pos) {
+            std::vector<FeatureVector> positives{ samples[nNegatives + pos] };
+            std::vector<FeatureVector> additionalNegatives{ samples[nNegatives + 2 + pos] };
+            std::vector<FeatureVector> directNegatives(samples.begin(), samples.begin() + nNegatives);
+            directNegatives.push_back(additionalNegatives[0]);
+            ESVM esvmDirect(positives, directNegatives, "TEST-DIRECT");
+            ESVM esvmKernel(negatives, kernelRows, pos * 2, positives, additionalNegatives, "TEST-KERNEL");
+            ASSERT_LOG(esvmKernel.isModelTrained(), "ESVM trained with precomputed kernel should be trained");
+            for (size_t s = 0; s < samples.size(); ++s)
+                ASSERT_LOG(doubleAlmostEquals(esvmDirect.predict(samples[s]), esvmKernel.predict(samples[s]), 0.0001),
+                           "Predictions of ESVM trained with precomputed kernel should match direct training (exemplar: " +
+                           std::to_string(pos) + ", probe: " + std::to_string(s) + ")");
+        }
+    }
+    catch (std::exception& ex)
+    {
+        logger << "Valid test procedures should not have raised an exception." << std::endl
+               << "Exception: [" << ex.what() << "]" << std::endl;
+        ESVM::destroyFeatureNodes(&kernelRows);
+        return passThroughDisplayTestStatus(__func__, -1);
+    }
+    ESVM::destroyFeatureNodes(&kernelRows);
+
+    #endif/*ESVM_USE_LIBSVM*/
+    #else/*TEST_ESVM_PRECOMPUTED_KERNEL_TRAINING*/
+    return passThroughDisplayTestStatus(__func__, SKIPPED);
+    #endif/*TEST_ESVM_PRECOMPUTED_KERNEL_TRAINING*/
+    return passThroughDisplayTestStatus(__func__, PASSED);
+}
+
+// Test equivalence of ESVM trained over shared negative feature nodes and ESVM trained from feature vectors
+int test_ESVM_SharedFeatureNodesTraining()
+{
+    #if TEST_ESVM_SHARED_FEATURE_NODES_TRAINING
+    logstream logger(LOGGER_FILE);
+    logger << "Running '" << __func__ << "' test..." << std::endl;
+
+    size_t nNegatives = 50, nFeatures = 16;
+    std::vector<FeatureVector> samples;
+    std::vector<int> targets;
+    generateDummySamples(samples, targets, nNegatives + 2, nFeatures);
+    std::vector<FeatureVector> negatives(samples.begin(), samples.begin() + nNegatives);
+    std::vector<FeatureVector> positives(samples.begin() + nNegatives, samples.end());
+
+    svmFeature** negNodes = ESVM::makeFeatureNodes(negatives);
+    svmFeature** posNodes = ESVM::makeFeatureNodes(positives);
+    try
+    {
+        std::vector<svmFeature*> sharedNegatives(negNodes, negNodes + nNegatives);
+        for (size_t pos = 0; pos < positives.size(); ++pos) {
+            ESVM esvmVectors(std::vector<FeatureVector>{ positives[pos] }, negatives, "TEST-VECTORS");
+            ESVM esvmNodes(std::vector<svmFeature*>{ posNodes[pos] }, sharedNegatives, "TEST-NODES");
+            for (size_t s = 0; s < samples.size(); ++s)
+                ASSERT_LOG(doubleAlmostEquals(esvmVectors.predict(samples[s]), esvmNodes.predict(samples[s])),
+                           "Predictions of ESVM trained over shared feature nodes should match training from feature vectors (exemplar: " +
+                           std::to_string(pos) + ", probe: " + std::to_string(s) + ")");
+        }
+        // shared nodes must remain valid and unmodified after destruction of trained models
+        for (size_t neg = 0; neg < nNegatives; ++neg)
+            for (size_t f = 0; f < nFeatures; ++f)
+                ASSERT_LOG(negNodes[neg][f].value == negatives[neg][f], "Shared feature nodes should not be modified by training");
+    }
+    catch (std::exception& ex)
+    {
+        logger << "Valid test procedures should not have raised an exception." << std::endl
+               << "Exception: [" << ex.what() << "]" << std::endl;
+        ESVM::destroyFeatureNodes(&negNodes);
+        ESVM::destroyFeatureNodes(&posNodes);
+        return passThroughDisplayTestStatus(__func__, -1);
+    }
+    ESVM::destroyFeatureNodes(&negNodes);
+    ESVM::destroyFeatureNodes(&posNodes);
+
+    #else/*TEST_ESVM_SHARED_FEATURE_NODES_TRAINING*/
+    return passThroughDisplayTestStatus(__func__, SKIPPED);
+    #endif/*TEST_ESVM_SHARED_FEATURE_NODES_TRAINING*/
+    return passThroughDisplayTestStatus(__func__, PASSED);
+}
+
+// Test equivalence of memory-mapped BINARY samples against samples read by the standard BINARY parser
+int test_ESVM_ReadSampleFile_mapped(size_t nSamples, size_t nFeatures)
+{
+    #if TEST_ESVM_READ_SAMPLES_FILE_MAPPED
+    logstream logger(LOGGER_FILE);
+    logger << "Running '" << __func__ << "' test..." << std::endl;
+
+    std::string testDir = "test_sample-read-mapped-file/";
+    bfs::create_directory(testDir);
+    std::string sampleFileName = testDir + "test_mapped-samples.bin";
+    std::string legacyFileName = testDir + "test_legacy-samples.bin";
+    std::string truncatedFileName = testDir + "test_truncated-samples.bin";
+    ASSERT_LOG(generateDummySampleFile_binary(sampleFileName, nSamples, nFeatures), "Failed to generate dummy BINARY sample file");
+
+    try
+    {
+        std::vector<FeatureVector> readSamples;
+        std::vector<int> readTargetOutputs;
+        ESVM::readSampleDataFile(sampleFileName, readSamples, readTargetOutputs, BINARY);
+        esvmMappedSamples mappedSamples(sampleFileName);
+        ASSERT_LOG(mappedSamples.isMapped(), "Samples of the aligned BINARY layout should be mapped without copy");
+        ASSERT_LOG(mappedSamples.getSampleCount() == readSamples.size(), "Number of mapped samples should match read samples");
+        ASSERT_LOG(mappedSamples.getFeatureCount() == readSamples[0].size(), "Number of mapped features should match read features");
+        ASSERT_LOG(mappedSamples.getTargetOutputs() == readTargetOutputs, "Mapped target outputs should match read target outputs");
+        for (size_t s = 0; s < nSamples; ++s)
+            ASSERT_LOG(std::equal(readSamples[s].begin(), readSamples[s].end(), mappedSamples.getSample(s)),
+                       "Mapped sample features should match read sample features (sample: " + std::to_string(s) + ")");
+
+        // legacy layout without padding must still be read (copied if its features are unaligned)
+        DataFile::writeSampleDataFile(legacyFileName, readSamples, readTargetOutputs, BINARY, ESVM_BINARY_HEADER_SAMPLES);
+        std::vector<FeatureVector> legacySamples;
+        std::vector<int> legacyTargetOutputs;
+        ESVM::readSampleDataFile(legacyFileName, legacySamples, legacyTargetOutputs, BINARY);
+        esvmMappedSamples legacyMappedSamples(legacyFileName);
+        ASSERT_LOG(legacySamples == readSamples && legacyTargetOutputs == readTargetOutputs,
+                   "Samples read from the legacy BINARY layout should match samples read from the aligned layout");
+        ASSERT_LOG(legacyMappedSamples.getSampleCount() == nSamples && legacyMappedSamples.getTargetOutputs() == readTargetOutputs,
+                   "Legacy BINARY layout mapped samples and target outputs should match the aligned layout");
+        for (size_t s = 0; s < nSamples; ++s)
+            ASSERT_LOG(std::equal(readSamples[s].begin(), readSamples[s].end(), legacyMappedSamples.getSample(s)),
+                       "Legacy mapped sample features should match read sample features (sample: " + std::to_string(s) + ")");
+    }
+    catch (std::exception& ex)
+    {
+        logger << "Error: Valid BINARY samples file mapping should not have generated an exception." << std::endl
+               << "Exception: [" << ex.what() << "]" << std::endl;
+        bfs::remove_all(testDir);
+        return passThroughDisplayTestStatus(__func__, -1);
+    }
+    try
+    {
+        // test file size validation with missing samples
+        bfs::copy_file(sampleFileName, truncatedFileName);
+        bfs::resize_file(truncatedFileName, bfs::file_size(sampleFileName) - sizeof(double));
+        esvmMappedSamples truncatedSamples(truncatedFileName);
+        logger << "Error: Mapping a truncated BINARY samples file should result in size validation failure." << std::endl;
+        bfs::remove_all(testDir);
+        return passThroughDisplayTestStatus(__func__, -2);
+    }
+    catch (...) {}
+
+    bfs::remove_all(testDir);
+
+    #else/*TEST_ESVM_READ_SAMPLES_FILE_MAPPED*/
+    return passThroughDisplayTestStatus(__func__, SKIPPED);
+    #endif/*TEST_ESVM_READ_SAMPLES_FILE_MAPPED*/
+    return passThroughDisplayTestStatus(__func__, PASSED);
+}
+
+// Test accuracy of float32 BINARY samples files and float32 scoring against the double precision path
+int test_ESVM_Float32Precision(size_t nSamples, size_t nFeatures)
+{
+    #if TEST_ESVM_FLOAT32_PRECISION
+    logstream logger(LOGGER_FILE);
+    logger << "Running '" << __func__ << "' test..." << std::endl;
+
+    std::string testDir = "test_float32-precision/";
+    bfs::create_directory(testDir);
+    std::string sampleFileName = testDir + "test_float32-samples.bin";
+
+    std::vector<FeatureVector> samples;
+    std::vector<int> targetOutputs;
+    generateDummySamples(samples, targetOutputs, nSamples, nFeatures);
+    try
+    {
+        // float32 samples file must store single precision features, read back exactly as their narrowed values
+        ESVM::writeSampleDataFile(sampleFileName, samples, targetOutputs, BINARY, true);
+        size_t featuresOffset = std::string(ESVM_BINARY_HEADER_SAMPLES_ALIGNED_FLOAT32).size() + (2 + nSamples) * sizeof(int);
+        featuresOffset += (ESVM_SAMPLES_FILE_ALIGNMENT - featuresOffset % ESVM_SAMPLES_FILE_ALIGNMENT) % ESVM_SAMPLES_FILE_ALIGNMENT;
+        size_t expectedSize = featuresOffset + nSamples * nFeatures * sizeof(float);
+        ASSERT_LOG(bfs::file_size(sampleFileName) == expectedSize, "Float32 BINARY samples file should store features in single precision");
+
+        std::vector<FeatureVector> readSamples;
+        std::vector<int> readTargetOutputs;
+        ESVM::readSampleDataFile(sampleFileName, readSamples, readTargetOutputs, BINARY);
+        esvmMappedSamples mappedSamples(sampleFileName);
+        ASSERT_LOG(mappedSamples.getSampleType() == CV_32F, "Mapped float32 BINARY samples should be of type 'CV_32F'");
+        ASSERT_LOG(readSamples.size() == nSamples && mappedSamples.getSampleCount() == nSamples, "Number of read samples should match written samples");
+        ASSERT_LOG(readTargetOutputs == targetOutputs && mappedSamples.getTargetOutputs() == targetOutputs,
+                   "Read target outputs should match written target outputs");
+        const cv::Mat& probes32F = mappedSamples.getSamples();
+        for (size_t s = 0; s < nSamples; ++s)
+            for (size_t f = 0; f < nFeatures; ++f)
+                ASSERT_LOG(readSamples[s][f] == (double)(float)samples[s][f] && probes32F.at<float>((int)s, (int)f) == (float)samples[s][f],
+                           "Read float32 features should match written features narrowed to single precision (sample: " + std::to_string(s) + ")");
+
+        // float32 scoring against double precision scoring of the same trained model
+        std::vector<FeatureVector> positives{ samples[0] };
+        std::vector<FeatureVector> negatives(samples.begin() + 1, samples.end());
+        ESVM esvm(positives, negatives, "TEST-FLOAT32");
+        std::vector<double> scores32F(nSamples);
+        esvm.predictBatch(probes32F, scores32F.data());
+        size_t nMismatch = 0;
+        for (size_t s = 0; s < nSamples; ++s) {
+            double score = esvm.predict(samples[s]);
+            #if ESVM_PREDICT_MODE == 1
+            // labels can only differ for probes within the single precision error of the decision boundary
+            if (score != scores32F[s])
+                ++nMismatch;
+            #else/*ESVM_PREDICT_MODE*/
+            ASSERT_LOG(doubleAlmostEquals(score, scores32F[s], 0.0001 * std::max(1.0, std::abs(score))),
+                       "Float32 prediction should match double prediction (sample: " + std::to_string(s) + ", expected: " +
+                       std::to_string(score) + ", obtained: " + std::to_string(scores32F[s]) + ")");
+            #endif/*ESVM_PREDICT_MODE*/
+        }
+        ASSERT_LOG(nMismatch <= nSamples / 1000, "Float32 predicted labels should match double predicted labels (mismatches: " +
+                   std::to_string(nMismatch) + "/" + std::to_string(nSamples) + ")");
+    }
+    catch (std::exception& ex)
+    {
+        logger << "Valid test procedures should not have raised an exception." << std::endl
+               << "Exception: [" << ex.what() << "]" << std::endl;
+        bfs::remove_all(testDir);
+        return passThroughDisplayTestStatus(__func__, -1);
+    }
+    bfs::remove_all(testDir);
+
+    #else/*TEST_ESVM_FLOAT32_PRECISION*/
+    return passThroughDisplayTestStatus(__func__, SKIPPED);
+    #endif/*TEST_ESVM_FLOAT32_PRECISION*/
+    return passThroughDisplayTestStatus(__func__, PASSED);
+}
+
+// Test equivalence of all SIMD dot product kernels supported by the running CPU against the scalar kernel
+int test_ESVM_DotProductKernels()
+{
+    #if TEST_ESVM_DOT_PRODUCT_KERNELS
+    logstream logger(LOGGER_FILE);
+    logger << "Running '" << __func__ << "' test..." << std::endl;
+    logger << "Dot product kernel selected at runtime: " << getDotKernelName(getDotKernel()) << std::endl;
+
+    // lengths around the vector widths of every kernel to validate remainders, and typical RSM/patch feature counts
+    std::vector<size_t> lengths{ 0, 1, 3, 4, 7, 8, 15, 16, 17, 31, 32, 33, 128, 588 };
+    std::srand(0);
+    for (size_t n : lengths) {
+        std::vector<double> a64(n), b64(n);
+        std::vector<float> a32(n), b32(n);
+        for (size_t i = 0; i < n; ++i) {
+            a64[i] = (double)std::rand() / RAND_MAX - 0.5;
+            b64[i] = (double)std::rand() / RAND_MAX;
+            a32[i] = (float)a64[i];
+            b32[i] = (float)b64[i];
+        }
+        double expected64 = dotProduct(a64.data(), b64.data(), n, DOT_SCALAR);
+        float expected32 = dotProduct(a32.data(), b32.data(), n, DOT_SCALAR);
+        for (DotKernel kernel : { DOT_SSE2, DOT_AVX2, DOT_AVX512 }) {
+            if (!isDotKernelSupported(kernel))
+                continue;
+            std::string kernelInfo = " (kernel: " + getDotKernelName(kernel) + ", length: " + std::to_string(n) + ")";
+            ASSERT_LOG(doubleAlmostEquals(dotProduct(a64.data(), b64.data(), n, kernel), expected64, 0.0000000001),
+                       "Double precision dot product should match the scalar kernel" + kernelInfo);
+            ASSERT_LOG(doubleAlmostEquals(dotProduct(a32.data(), b32.data(), n, kernel), expected32, 0.0001),
+                       "Single precision dot product should match the scalar kernel" + kernelInfo);
+        }
+    }
+
+    #else/*TEST_ESVM_DOT_PRODUCT_KERNELS*/
+    return passThroughDisplayTestStatus(__func__, SKIPPED);
+    #endif/*TEST_ESVM_DOT_PRODUCT_KERNELS*/
+    return passThroughDisplayTestStatus(__func__, PASSED);
+}
+
+int test_ESVM_PipelineQueue(size_t nProducers, size_t nConsumers, size_t nItems)
+{
+    #if TEST_ESVM_PIPELINE_QUEUE
+    logstream logger(LOGGER_FILE);
+    logger << "Running '" << __func__ << "' test..." << std::endl;
+
+    // small capacity to force producers and consumers to contend on full/empty queue, every item must be popped exactly once
+    esvmQueue<std::unique_ptr<size_t> > queue(4);
+    ASSERT_LOG(queue.getCapacity() == 4, "Queue capacity should be rounded to a power of 2");
+    std::vector<std::atomic<int> > poppedCounts(nProducers * nItems);
+    for (size_t i = 0; i < poppedCounts.size(); ++i)
+        poppedCounts[i] = 0;
+    std::atomic<size_t> nPopped(0);
+    std::vector<std::thread> threads;
+    for (size_t p = 0; p < nProducers; ++p)
+        threads.push_back(std::thread([&, p]() {
+            for (size_t i = 0; i < nItems; ++i) {
+                std::unique_ptr<size_t> item(new size_t(p * nItems + i));
+                for (int attempts = 0; !queue.tryPush(item); )
+                    attempts = esvmQueueBackoff(attempts);
+            }
+        }));
+    for (size_t c = 0; c < nConsumers; ++c)
+        threads.push_back(std::thread([&]() {
+            std::unique_ptr<size_t> item;
+            for (int attempts = 0; nPopped.load() < nProducers * nItems; ) {
+                if (!queue.tryPop(item)) {
+                    attempts = esvmQueueBackoff(attempts);
+                    continue;
+                }
+                ++poppedCounts[*item];
+                ++nPopped;
+            }
+        }));
+    for (size_t t = 0; t < threads.size(); ++t)
+        threads[t].join();
+
+    std::unique_ptr<size_t> item;
+    ASSERT_LOG(!queue.tryPop(item), "Queue should be empty after all items were popped");
+    for (size_t i = 0; i < poppedCounts.size(); ++i)
+        ASSERT_LOG(poppedCounts[i] == 1, "Item " + std::to_string(i) + " should be popped exactly once");
+
+    #else/*TEST_ESVM_PIPELINE_QUEUE*/
+    return passThroughDisplayTestStatus(__func__, SKIPPED);
+    #endif/*TEST_ESVM_PIPELINE_QUEUE*/
+    return passThroughDisplayTestStatus(__func__, PASSED);
+}
+
+// Test ESVM employing distinct runtime prediction modes from the same model and rejection of unsupported configurations
+int test_ESVM_RuntimeConfig()
+{
+    #if TEST_ESVM_RUNTIME_CONFIG
+    logstream logger(LOGGER_FILE);
+    logger << "Running '" << __func__ << "' test..." << std::endl;
+
+    std::vector<FeatureVector> probes{ { 0.55, 0.70, 0.22 }, { 0.10, 0.90, 0.80 }, { 0.00, 0.00, 0.00 }, { 1.00, 0.25, 0.50 } };
+    svm_model* model = buildDummyExemplarSvmModel();
+    try
+    {
+        esvmConfig configValues, configLabels;
+        configValues.predictMode = 0;
+        configLabels.predictMode = 1;
+        ESVM esvmValues(model, "TEST-CONFIG-VALUES", configValues);
+        ESVM esvmLabels(model, "TEST-CONFIG-LABELS", configLabels);
+        ASSERT_LOG(esvmValues.getConfig().predictMode == 0 && esvmLabels.getConfig().predictMode == 1,
+                   "ESVM should keep the prediction mode of their own configuration");
+
+        for (size_t p = 0; p < probes.size(); ++p) {
+            // reference decision function evaluated by the SVM library over all support vectors
+            std::vector<svm_node> nodes(probes[p].size() + 1);
+            for (size_t f = 0; f < probes[p].size(); ++f) {
+                nodes[f].index = (int)f + 1;
+                nodes[f].value = probes[p][f];
+            }
+            nodes[probes[p].size()].index = -1;
+            double decision = 0;
+            double label = svm_predict_values(model, nodes.data(), &decision);
+
+            std::string probeInfo = " (probe: " + std::to_string(p) + ")";
+            ASSERT_LOG(doubleAlmostEquals(esvmValues.predict(probes[p]), decision, 0.000001), "Values prediction mode should return the decision value" + probeInfo);
+            ASSERT_LOG(doubleAlmostEquals(esvmLabels.predict(probes[p]), label), "Labels prediction mode should return the predicted label" + probeInfo);
+        }
+    }
+    catch (std::exception& ex)
+    {
+        logger << "Valid test procedures should not have raised an exception." << std::endl
+               << "Exception: [" << ex.what() << "]" << std::endl;
+        ESVM::destroyModel(&model);
+        return passThroughDisplayTestStatus(__func__, -1);
+    }
+    ESVM::destroyModel(&model);
+
+    // unsupported modes must be rejected
+    std::vector<esvmConfig> invalidConfigs(4);
+    invalidConfigs[0].predictMode = 3;
+    invalidConfigs[1].featureNormMode = 9;
+    invalidConfigs[2].scoreNormMode = -1;
+    invalidConfigs[3].roiCropRatio = 0;
+    for (size_t c = 0; c < invalidConfigs.size(); ++c) {
+        bool isRejected = false;
+        try { invalidConfigs[c].validate(); }
+        catch (std::exception&) { isRejected = true; }
+        ASSERT_LOG(isRejected, "Unsupported configuration should have been rejected (config: " + std::to_string(c) + ")");
+    }
+
+    #else/*TEST_ESVM_RUNTIME_CONFIG*/
+    return passThroughDisplayTestStatus(__func__, SKIPPED);
+    #endif/*TEST_ESVM_RUNTIME_CONFIG*/
+    return passThroughDisplayTestStatus(__func__, PASSED);
+}
+
+/*
+    Benchmark of training time and scores of each training solver available with the employed SVM library, for the
+    exemplars of an ensemble trained against the same shared negatives.
+    Dummy samples are deterministic, scores of the LIBSVM build are saved so that a LIBLINEAR build run afterwards from the
+    same directory also reports their differences against LIBSVM (library is selected at compile time).
+*/
+int test_ESVM_SolverBenchmark(size_t nPositives, size_t nNegatives, size_t nFeatures)
+{
+    #if TEST_ESVM_SOLVER_BENCHMARK
+    logstream logger(LOGGER_FILE);
+    logger << "Running '" << __func__ << "' test..." << std::endl;
+
+    std::vector<FeatureVector> samples;
+    std::vector<int> targets;
+    generateDummySamples(samples, targets, nNegatives + nPositives, nFeatures);
+    std::vector<FeatureVector> negatives(samples.begin(), samples.begin() + nNegatives);
+    std::vector<FeatureVector> positives(samples.begin() + nNegatives, samples.end());
+
+    #if ESVM_USE_LIBSVM
+    std::vector<int> solverModes{ 0 };
+    #elif ESVM_USE_LIBLINEAR
+    std::vector<int> solverModes{ 0, 1 };
+    #endif/*ESVM_USE_LIBSVM | ESVM_USE_LIBLINEAR*/
+    std::vector<std::string> solverNames{ "dual", "primal" };
+    std::string libsvmScoresFileName = "test_solver-benchmark-scores_LIBSVM.txt";
+
+    svmFeature** negNodes = ESVM::makeFeatureNodes(negatives);
+    svmFeature** posNodes = ESVM::makeFeatureNodes(positives);
+    try
+    {
+        std::vector<svmFeature*> sharedNegatives(negNodes, negNodes + nNegatives);
+        std::vector<std::vector<double> > solverScores(solverModes.size());     // scores of every exemplar against all samples
+        for (size_t m = 0; m < solverModes.size(); ++m) {
+            esvmConfig config;
+            config.predictMode = 0;
+            config.solverMode = solverModes[m];
+            std::vector<ESVM> esvms;
+            esvms.reserve(nPositives);
+            TP t0 = getTimeNowPrecise();
+            for (size_t pos = 0; pos < nPositives; ++pos)
+                esvms.push_back(ESVM(std::vector<svmFeature*>{ posNodes[pos] }, sharedNegatives, "TEST-SOLVER-" + std::to_string(pos), config));
+            double dt = getDeltaTimePrecise(t0, MILLISECONDS);
+            logger << "Elapsed time to train " << nPositives << " exemplars against " << nNegatives << " negatives of " << nFeatures
+                   << " features (" << ESVM_BASE << ", " << solverNames[solverModes[m]] << " solver): " << std::setprecision(12) << dt << "ms" << std::endl;
+
+            // each exemplar must score its own positive above all negatives
+            for (size_t pos = 0; pos < nPositives; ++pos) {
+                double positiveScore = esvms[pos].predict(positives[pos]);
+                for (size_t s = 0; s < samples.size(); ++s)
+                    solverScores[m].push_back(s < nNegatives ? esvms[pos].predict(negatives[s]) : esvms[pos].predict(positives[s - nNegatives]));
+                for (size_t neg = 0; neg < nNegatives; ++neg)
+                    ASSERT_LOG(positiveScore > solverScores[m][pos * samples.size() + neg],
+                               "Exemplar should score its positive above all negatives (" + solverNames[solverModes[m]] +
+                               " solver, exemplar: " + std::to_string(pos) + ", negative: " + std::to_string(neg) + ")");
+            }
+        }
+
+        // solvers minimize the same strictly convex objective of the library, up to their stopping criterion
+        for (size_t m = 1; m < solverModes.size(); ++m) {
+            double maxDiff = 0;
+            for (size_t s = 0; s < solverScores[0].size(); ++s)
+                maxDiff = std::max(maxDiff, std::abs(solverScores[m][s] - solverScores[0][s]));
+            logger << "Maximum score difference of " << solverNames[solverModes[m]] << " solver against "
+                   << solverNames[solverModes[0]] << " solver: " << maxDiff << std::endl;
+        }
+
+        #if ESVM_USE_LIBSVM
+        std::ofstream scoresFile(libsvmScoresFileName);
+        ASSERT_LOG(scoresFile.is_open(), "Failed to save LIBSVM scores for comparison with LIBLINEAR");
+        scoresFile << std::setprecision(17);
+        for (size_t s = 0; s < solverScores[0].size(); ++s)
+            scoresFile << solverScores[0][s] << std::endl;
+        #elif ESVM_USE_LIBLINEAR
+        // LIBSVM minimizes the hinge loss instead of the squared hinge loss, scores differ but should rank samples similarly
+        std::ifstream scoresFile(libsvmScoresFileName);
+        std::vector<double> libsvmScores;
+        for (double score; scoresFile >> score; )
+            libsvmScores.push_back(score);
+        if (libsvmScores.size() != solverScores[0].size())
+            logger << "LIBSVM scores unavailable for comparison, run the benchmark with a LIBSVM build first" << std::endl;
+        else {
+            for (size_t m = 0; m < solverModes.size(); ++m) {
+                double sumDiff = 0;
+                size_t nRankAgree = 0, nPairs = 0;
+                for (size_t pos = 0; pos < nPositives; ++pos) {
+                    size_t offset = pos * samples.size();
+                    for (size_t s = 0; s < samples.size(); ++s) {
+                        sumDiff += std::abs(solverScores[m][offset + s] - libsvmScores[offset + s]);
+                        if (s == 0) continue;
+                        nRankAgree += (solverScores[m][offset + s] > solverScores[m][offset + s - 1]) ==
+                                      (libsvmScores[offset + s] > libsvmScores[offset + s - 1]) ? 1 : 0;
+                        nPairs++;
+                    }
+                }
+                logger << "Scores of LIBLINEAR " << solverNames[solverModes[m]] << " solver against LIBSVM: mean absolute difference "
+                       << sumDiff / (double)solverScores[m].size() << ", ordering agreement of consecutive samples "
+                       << (double)nRankAgree / (double)nPairs << std::endl;
+            }
+        }
+        #endif/*ESVM_USE_LIBSVM | ESVM_USE_LIBLINEAR*/
+    }
+    catch (std::exception& ex)
+    {
+        logger << "Valid test procedures should not have raised an exception." << std::endl
+               << "Exception: [" << ex.what() << "]" << std::endl;
+        ESVM::destroyFeatureNodes(&negNodes);
+        ESVM::destroyFeatureNodes(&posNodes);
+        return passThroughDisplayTestStatus(__func__, -1);
+    }
+    ESVM::destroyFeatureNodes(&negNodes);
+    ESVM::destroyFeatureNodes(&posNodes);
+
+    #else/*TEST_ESVM_SOLVER_BENCHMARK*/
+    return passThroughDisplayTestStatus(__func__, SKIPPED);
+    #endif/*TEST_ESVM_SOLVER_BENCHMARK*/
+    return passThroughDisplayTestStatus(__func__, PASSED);
+}
+
+/*
+    Test warm started training of exemplars from the solution of a prior exemplar trained against the same negatives.
+    Warm started and cold started training minimize the same objective and must obtain equivalent ESVM (LIBLINEAR primal
+    solver), other solvers must refuse warm start.
+*/
+int test_ESVM_WarmStartTraining(size_t nNegatives, size_t nFeatures)
+{
+    #if TEST_ESVM_WARM_START_TRAINING
+    logstream logger(LOGGER_FILE);
+    logger << "Running '" << __func__ << "' test..." << std::endl;
+
+    size_t nPositives = 2;
+    std::vector<FeatureVector> samples;
+    std::vector<int> targets;
+    generateDummySamples(samples, targets, nNegatives + nPositives, nFeatures);
+    std::vector<FeatureVector> negatives(samples.begin(), samples.begin() + nNegatives);
+    std::vector<FeatureVector> positives(samples.begin() + nNegatives, samples.end());
+
+    svmFeature** negNodes = ESVM::makeFeatureNodes(negatives);
+    svmFeature** posNodes = ESVM::makeFeatureNodes(positives);
+    std::vector<svmFeature*> sharedNegatives(negNodes, negNodes + nNegatives);
+    esvmConfig config;
+    config.predictMode = 0;
+
+    #if ESVM_USE_LIBLINEAR
+    try
+    {
+        config.solverMode = 1;
+        config.warmStart = true;
+        config.validate();
+        ESVM esvmPrior(std::vector<svmFeature*>{ posNodes[0] }, sharedNegatives, "TEST-PRIOR", config);
+        FeatureVector priorSolution = esvmPrior.getSolution();
+        ASSERT_LOG(priorSolution.size() == nFeatures + 1, "Solution should contain the weights of all features followed by the bias");
+
+        TP t0 = getTimeNowPrecise();
+        ESVM esvmCold(std::vector<svmFeature*>{ posNodes[1] }, sharedNegatives, "TEST-COLD", config);
+        double dtCold = getDeltaTimePrecise(t0, MILLISECONDS);
+        TP t1 = getTimeNowPrecise();
+        ESVM esvmWarm(std::vector<svmFeature*>{ posNodes[1] }, sharedNegatives, "TEST-WARM", config, priorSolution);
+        double dtWarm = getDeltaTimePrecise(t1, MILLISECONDS);
+        logger << "Elapsed time to train exemplar against " << nNegatives << " negatives of " << nFeatures << " features: "
+               << std::setprecision(12) << dtCold << "ms (cold start), " << dtWarm << "ms (warm start)" << std::endl;
+
+        double maxDiff = 0;
+        double positiveScore = esvmWarm.predict(positives[1]);
+        for (size_t neg = 0; neg < nNegatives; ++neg) {
+            double negativeScore = esvmWarm.predict(negatives[neg]);
+            maxDiff = std::max(maxDiff, std::abs(negativeScore - esvmCold.predict(negatives[neg])));
+            ASSERT_LOG(positiveScore > negativeScore, "Warm started exemplar should score its positive above all negatives (negative: " +
+                       std::to_string(neg) + ")");
+        }
+        logger << "Maximum score difference of warm started against cold started exemplar: " << maxDiff << std::endl;
+    }
+    catch (std::exception& ex)
+    {
+        logger << "Valid test procedures should not have raised an exception." << std::endl
+               << "Exception: [" << ex.what() << "]" << std::endl;
+        ESVM::destroyFeatureNodes(&negNodes);
+        ESVM::destroyFeatureNodes(&posNodes);
+        return passThroughDisplayTestStatus(__func__, -1);
+    }
+    config.solverMode = 0;
+    #endif/*ESVM_USE_LIBLINEAR*/
+
+    // dual solvers cannot start from an initial solution
+    bool refusedConfig = false, refusedTraining = false;
+    try
+    {
+        config.warmStart = true;
+        config.validate();
+    }
+    catch (std::exception&) { refusedConfig = true; }
+    try
+    {
+        config.warmStart = false;
+        FeatureVector initialSolution(nFeatures + 1, 0.0);
+        ESVM esvmDual(std::vector<svmFeature*>{ posNodes[0] }, sharedNegatives, "TEST-DUAL", config, initialSolution);
+    }
+    catch (std::exception&) { refusedTraining = true; }
+    ESVM::destroyFeatureNodes(&negNodes);
+    ESVM::destroyFeatureNodes(&posNodes);
+    ASSERT_LOG(refusedConfig, "Warm start configuration should be refused by dual solvers");
+    ASSERT_LOG(refusedTraining, "Training from an initial solution should be refused by dual solvers");
+
+    #else/*TEST_ESVM_WARM_START_TRAINING*/
+    return passThroughDisplayTestStatus(__func__, SKIPPED);
+    #endif/*TEST_ESVM_WARM_START_TRAINING*/
+    return passThroughDisplayTestStatus(__func__, PASSED);
+}
+
+/*
+    Test ESVM trained with hard negative mining over a pool of negatives against training with all negatives at once.
+    Without mining, the whole pool must be employed directly (identical model). With mining, the ESVM must still separate
+    its positive from all negatives of the pool.
+*/
+int test_ESVM_HardNegativeMining(size_t nNegatives, size_t nFeatures)
+{
+    #if TEST_ESVM_HARD_NEGATIVE_MINING
+    logstream logger(LOGGER_FILE);
+    logger << "Running '" << __func__ << "' test..." << std::endl;
+
+    std::vector<FeatureVector> samples;
+    std::vector<int> targets;
+    generateDummySamples(samples, targets, nNegatives + 1, nFeatures);
+    std::vector<FeatureVector> negatives(samples.begin(), samples.begin() + nNegatives);
+    std::vector<FeatureVector> positives(samples.begin() + nNegatives, samples.end());
+    svmFeature** negNodes = ESVM::makeFeatureNodes(negatives);
+    svmFeature** posNodes = ESVM::makeFeatureNodes(positives);
+    try
+    {
+        std::vector<svmFeature*> positiveNodes{ posNodes[0] };
+        std::vector<svmFeature*> allNegatives(negNodes, negNodes + nNegatives);
+        esvmConfig config;
+        config.predictMode = 0;
+
+        TP t0 = getTimeNowPrecise();
+        ESVM esvmAll(positiveNodes, allNegatives, "TEST-ALL", config);
+        double dtAll = getDeltaTimePrecise(t0, MILLISECONDS);
+        config.miningNegatives = 0;
+        ESVM esvmPool(positiveNodes, std::vector<svmFeature*>(), negNodes, nNegatives, "TEST-POOL", config);
+
+        config.miningNegatives = nNegatives / 10;
+        config.miningIterations = 10;
+        config.miningBatch = nNegatives / 10;
+        TP t1 = getTimeNowPrecise();
+        ESVM esvmMined(positiveNodes, std::vector<svmFeature*>(), negNodes, nNegatives, "TEST-MINED", config);
+        double dtMined = getDeltaTimePrecise(t1, MILLISECONDS);
+        logger << "Elapsed time to train exemplar against pool of " << nNegatives << " negatives of " << nFeatures << " features: "
+               << std::setprecision(12) << dtAll << "ms (all negatives), " << dtMined << "ms (hard negative mining)" << std::endl;
+
+        double maxDiff = 0;
+        double positiveScore = esvmMined.predict(positives[0]);
+        for (size_t neg = 0; neg < nNegatives; ++neg) {
+            double negativeScore = esvmMined.predict(negatives[neg]);
+            ASSERT_LOG(doubleAlmostEquals(esvmPool.predict(negatives[neg]), esvmAll.predict(negatives[neg])),
+                       "ESVM trained against the whole pool without mining should match training with all negatives (negative: " +
+                       std::to_string(neg) + ")");
+            ASSERT_LOG(positiveScore > negativeScore, "Mined exemplar should score its positive above all pool negatives (negative: " +
+                       std::to_string(neg) + ")");
+            maxDiff = std::max(maxDiff, std::abs(negativeScore - esvmAll.predict(negatives[neg])));
+        }
+        logger << "Maximum score difference of mined exemplar against exemplar trained with all negatives: " << maxDiff << std::endl;
+    }
+    catch (std::exception& ex)
+    {
+        logger << "Valid test procedures should not have raised an exception." << std::endl
+               << "Exception: [" << ex.what() << "]" << std::endl;
+        ESVM::destroyFeatureNodes(&negNodes);
+        ESVM::destroyFeatureNodes(&posNodes);
+        return passThroughDisplayTestStatus(__func__, -1);
+    }
+    ESVM::destroyFeatureNodes(&negNodes);
+    ESVM::destroyFeatureNodes(&posNodes);
+
+    #else/*TEST_ESVM_HARD_NEGATIVE_MINING*/
+    return passThroughDisplayTestStatus(__func__, SKIPPED);
+    #endif/*TEST_ESVM_HARD_NEGATIVE_MINING*/
+    return passThroughDisplayTestStatus(__func__, PASSED);
+}
+
+// Test equivalence of ensemble predictions after saving/loading its archive (with and without random subspaces), predictions of
+// an archive converted to the other weights precision, and rejection of truncated or mismatching archives
+int test_ESVM_EnsembleArchive(size_t nPositives, size_t nProbes)
+{
+    #if TEST_ESVM_ENSEMBLE_ARCHIVE
+    logstream logger(LOGGER_FILE);
+    logger << "Running '" << __func__ << "' test..." << std::endl;
+
+    std::string testDir = "test_ensemble-archive/";
+    bfs::create_directory(testDir);
+    std::string convertedFileName = testDir + "test_ensemble-converted.bin";
+    std::string corruptedFileName = testDir + "test_ensemble-corrupted.bin";
+    std::vector<std::string> archiveFileNames{ testDir + "test_ensemble.bin", testDir + "test_ensemble-rsm.bin" };
+    std::vector<esvmConfig> configs{ buildDummyEnsembleConfig(0), buildDummyEnsembleConfig(3) };
+
+    // archive offsets of the version and of the counts (nESVM, nPositives, nFeatures, weightSize) following the header
+    // version, dimensions, modes and ROI crop ratio, RSM indexes follow the counts without normalization values
+    size_t versionOffset = std::string(ESVM_BINARY_HEADER_ENSEMBLE).size();
+    size_t countsOffset = versionOffset + 21 * sizeof(int) + sizeof(double);
+    size_t rsmOffset = countsOffset + 4 * sizeof(int);
+    auto readArchive = [](const std::string& filePath) {
+        std::ifstream file(filePath, std::ios::in | std::ios::binary);
+        return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    };
+    auto writeArchive = [](const std::string& filePath, const std::string& content) {
+        std::ofstream file(filePath, std::ios::out | std::ios::binary | std::ios::trunc);
+        file.write(content.data(), content.size());
+    };
+    auto writeArchiveInt = [](std::string& content, size_t offset, int value) {
+        std::memcpy(&content[offset], &value, sizeof(int));
+    };
+
+    std::vector<cv::Mat> probes = generateDummyROIs(nProbes);
+    try
+    {
+        for (size_t c = 0; c < configs.size(); ++c) {
+            esvmEnsemble ensemble = buildDummyEnsemble(testDir, nPositives, configs[c]);
+            ASSERT_LOG(ensemble.save(archiveFileNames[c]), "Ensemble archive should have been saved (config: " + std::to_string(c) + ")");
+            esvmEnsemble loaded = esvmEnsemble::load(archiveFileNames[c]);
+            ASSERT_LOG(loaded.getPositiveCount() == nPositives, "Loaded ensemble should contain all saved positives");
+            ASSERT_LOG(loaded.getConfig().rsmCount == configs[c].rsmCount, "Loaded ensemble should restore the archived RSM count");
+            for (size_t pos = 0; pos < nPositives; ++pos)
+                ASSERT_LOG(loaded.getPositiveID((int)pos) == ensemble.getPositiveID((int)pos), "Loaded positive IDs should match saved IDs");
+
+            // weights converted to the other precision than the scoring one are loaded by copy instead of being mapped
+            std::string content = readArchive(archiveFileNames[c]);
+            int counts[4];
+            std::memcpy(counts, &content[countsOffset], sizeof(counts));
+            size_t nWeights = (size_t)counts[0] * (size_t)counts[1] * (size_t)counts[2];
+            ASSERT_LOG(counts[3] == sizeof(esvmScalar) && nWeights * sizeof(esvmScalar) < content.size(),
+                       "Saved ensemble archive weights should be of the scoring precision");
+            size_t weightsOffset = content.size() - nWeights * sizeof(esvmScalar);
+            std::string converted = content.substr(0, weightsOffset);
+            writeArchiveInt(converted, countsOffset + 3 * sizeof(int), sizeof(esvmScalar) == sizeof(double) ? sizeof(float) : sizeof(double));
+            for (size_t w = 0; w < nWeights; ++w) {
+                esvmScalar weight;
+                std::memcpy(&weight, &content[weightsOffset + w * sizeof(esvmScalar)], sizeof(esvmScalar));
+                if (sizeof(esvmScalar) == sizeof(double)) {
+                    float value = (float)weight;
+                    converted.append(reinterpret_cast<const char*>(&value), sizeof(float));
+                }
+                else {
+                    double value = (double)weight;
+                    converted.append(reinterpret_cast<const char*>(&value), sizeof(double));
+                }
+            }
+            writeArchive(convertedFileName, converted);
+            esvmEnsemble loadedConverted = esvmEnsemble::load(convertedFileName);
+
+            for (size_t probe = 0; probe < nProbes; ++probe) {
+                std::vector<double> scores = ensemble.predict(probes[probe]);
+                std::vector<double> loadedScores = loaded.predict(probes[probe]);
+                std::vector<double> convertedScores = loadedConverted.predict(probes[probe]);
+                ASSERT_LOG(scores.size() == nPositives && loadedScores.size() == nPositives && convertedScores.size() == nPositives,
+                           "Ensemble predictions should provide a score for each positive");
+                for (size_t pos = 0; pos < nPositives; ++pos) {
+                    ASSERT_LOG(doubleAlmostEquals(loadedScores[pos], scores[pos], 1e-9),
+                               "Loaded ensemble score should match the saved ensemble score (config: " + std::to_string(c) +
+                               ", probe: " + std::to_string(probe) + ", positive: " + std::to_string(pos) + ")");
+                    ASSERT_LOG(doubleAlmostEquals(convertedScores[pos], scores[pos], 1e-4),
+                               "Converted precision archive score should match the saved ensemble score (config: " + std::to_string(c) +
+                               ", probe: " + std::to_string(probe) + ", positive: " + std::to_string(pos) + ")");
+                }
+            }
+        }
+    }
+    catch (std::exception& ex)
+    {
+        logger << "Error: Valid ensemble archive save/load should not have generated an exception." << std::endl
+               << "Exception: [" << ex.what() << "]" << std::endl;
+        bfs::remove_all(testDir);
+        return passThroughDisplayTestStatus(__func__, -1);
+    }
+
+    // test archive validation with truncated or mismatching content
+    std::string content = readArchive(archiveFileNames[0]);
+    std::string contentRSM = readArchive(archiveFileNames[1]);
+    std::vector<std::pair<std::string, std::string> > corruptedArchives;
+    corruptedArchives.push_back({ "truncated", content.substr(0, content.size() - 1) });
+    corruptedArchives.push_back({ "wrong header", "X" + content.substr(1) });
+    corruptedArchives.push_back({ "unsupported version", content });
+    writeArchiveInt(corruptedArchives.back().second, versionOffset, ESVM_ARCHIVE_VERSION + 1);
+    corruptedArchives.push_back({ "mismatching ESVM count", content });
+    writeArchiveInt(corruptedArchives.back().second, countsOffset, 1);
+    corruptedArchives.push_back({ "mismatching feature count", content });
+    writeArchiveInt(corruptedArchives.back().second, countsOffset + 2 * sizeof(int), 1);
+    corruptedArchives.push_back({ "invalid RSM feature index", contentRSM });
+    writeArchiveInt(corruptedArchives.back().second, rsmOffset, -1);
+    for (size_t i = 0; i < corruptedArchives.size(); ++i) {
+        writeArchive(corruptedFileName, corruptedArchives[i].second);
+        try
+        {
+            esvmEnsemble::load(corruptedFileName);
+            logger << "Error: Loading an ensemble archive with " << corruptedArchives[i].first
+                   << " should result in validation failure." << std::endl;
+            bfs::remove_all(testDir);
+            return passThroughDisplayTestStatus(__func__, -2);
+        }
+        catch (...) {}
+    }
+
+    bfs::remove_all(testDir);
+
+    #else/*TEST_ESVM_ENSEMBLE_ARCHIVE*/
+    return passThroughDisplayTestStatus(__func__, SKIPPED);
+    #endif/*TEST_ESVM_ENSEMBLE_ARCHIVE*/
+    return passThroughDisplayTestStatus(__func__, PASSED);
+}
+
+// Test cascaded ensemble predictions against full predictions: non-rejected positives must obtain their full score and
+// rejected positives must have a full score below the threshold, or no rejection at all with unbounded score terms
+int test_ESVM_EnsembleCascade(size_t nPositives, size_t nProbes)
+{
+    #if TEST_ESVM_ENSEMBLE_CASCADE
+    logstream logger(LOGGER_FILE);
+    logger << "Running '" << __func__ << "' test..." << std::endl;
+
+    std::string testDir = "test_ensemble-cascade/";
+    bfs::create_directory(testDir);
+
+    // bounded configurations (raw features with decision values, folded subspaces or class labels) and unbounded configuration
+    // (unclipped feature normalization with decision values)
+    std::vector<esvmConfig> configs{ buildDummyEnsembleConfig(0, 0), buildDummyEnsembleConfig(3, 0), buildDummyEnsembleConfig(0, 1) };
+    esvmConfig unboundedConfig = buildDummyEnsembleConfig(0, 0);
+    unboundedConfig.featureNormMode = 1;
+    unboundedConfig.featureNormClip = false;
+    configs.push_back(unboundedConfig);
+    size_t unboundedIndex = configs.size() - 1;
+
+    std::vector<cv::Mat> probes = generateDummyROIs(nProbes);
+    try
+    {
+        for (size_t c = 0; c < configs.size(); ++c) {
+            esvmEnsemble ensemble = buildDummyEnsemble(testDir, nPositives, configs[c]);
+            size_t nRejected = 0;
+            for (size_t probe = 0; probe < nProbes; ++probe) {
+                std::vector<double> scores = ensemble.predict(probes[probe]);
+                std::vector<double> sortedScores(scores);
+                std::sort(sortedScores.begin(), sortedScores.end());
+                std::vector<double> thresholds{ -DBL_MAX, sortedScores[nPositives / 2], DBL_MAX };
+                for (size_t t = 0; t < thresholds.size(); ++t) {
+                    std::vector<bool> rejected;
+                    std::vector<double> cascadeScores = ensemble.predictCascade(probes[probe], thresholds[t], &rejected);
+                    ASSERT_LOG(cascadeScores.size() == nPositives && rejected.size() == nPositives,
+                               "Cascaded prediction should provide a score and rejection flag for each positive");
+                    for (size_t pos = 0; pos < nPositives; ++pos) {
+                        std::string context = " (config: " + std::to_string(c) + ", probe: " + std::to_string(probe) +
+                                              ", threshold: " + std::to_string(t) + ", positive: " + std::to_string(pos) + ")";
+                        if (!rejected[pos]) {
+                            ASSERT_LOG(doubleAlmostEquals(cascadeScores[pos], scores[pos], 1e-9),
+                                       "Non-rejected positive cascaded score should match its full score" + context);
+                            continue;
+                        }
+                        ++nRejected;
+                        ASSERT_LOG(scores[pos] < thresholds[t], "Rejected positive full score should be below the threshold" + context);
+                        ASSERT_LOG(cascadeScores[pos] < thresholds[t] && cascadeScores[pos] >= scores[pos] - 1e-9,
+                                   "Rejected positive score bound should be below the threshold and above its full score" + context);
+                    }
+                    if (t == 0)
+                        ASSERT_LOG(std::count(rejected.begin(), rejected.end(), true) == 0,
+                                   "No positive should be rejected with the lowest threshold (config: " + std::to_string(c) + ")");
+                    if (t == thresholds.size() - 1 && c != unboundedIndex)
+                        ASSERT_LOG(std::count(rejected.begin(), rejected.end(), true) == (long)nPositives,
+                                   "All positives should be rejected with the highest threshold (config: " + std::to_string(c) + ")");
+                }
+            }
+            if (c == unboundedIndex)
+                ASSERT_LOG(nRejected == 0, "Cascaded prediction with unbounded score terms should not reject any positive");
+            logger << "Rejected positives with cascaded prediction (config: " << c << "): " << nRejected << std::endl;
+        }
+    }
+    catch (std::exception& ex)
+    {
+        logger << "Error: Valid cascaded ensemble prediction should not have generated an exception." << std::endl
+               << "Exception: [" << ex.what() << "]" << std::endl;
+        bfs::remove_all(testDir);
+        return passThroughDisplayTestStatus(__func__, -1);
+    }
+
+    bfs::remove_all(testDir);
+
+    #else/*TEST_ESVM_ENSEMBLE_CASCADE*/
+    return passThroughDisplayTestStatus(__func__, SKIPPED);
+    #endif/*TEST_ESVM_ENSEMBLE_CASCADE*/
+    return passThroughDisplayTestStatus(__func__, PASSED);
+}
+
+// Test best candidates retrieved from the ensemble (with or without cascaded prediction) against a full sort of its predictions
+int test_ESVM_EnsembleTopK(size_t nPositives, size_t nProbes)
+{
+    #if TEST_ESVM_ENSEMBLE_TOP_K
+    logstream logger(LOGGER_FILE);
+    logger << "Running '" << __func__ << "' test..." << std::endl;
+
+    std::string testDir = "test_ensemble-top-k/";
+    bfs::create_directory(testDir);
+
+    std::vector<cv::Mat> probes = generateDummyROIs(nProbes);
+    try
+    {
+        esvmEnsemble ensemble = buildDummyEnsemble(testDir, nPositives, buildDummyEnsembleConfig());
+        for (size_t probe = 0; probe < nProbes; ++probe) {
+            // expected candidates as (score, ID) sorted by decreasing score
+            std::vector<double> scores = ensemble.predict(probes[probe]);
+            std::vector<std::pair<double, std::string> > sortedScores;
+            for (size_t pos = 0; pos < nPositives; ++pos)
+                sortedScores.push_back({ scores[pos], ensemble.getPositiveID((int)pos) });
+            std::sort(sortedScores.rbegin(), sortedScores.rend());
+
+            // (k, threshold) cases: none, best only, more than enrolled positives, and threshold filtering some positives
+            // (threshold between two scores to avoid ties with cascaded scores that can differ by summation order)
+            double medianThreshold = (sortedScores[nPositives / 2 - 1].first + sortedScores[nPositives / 2].first) / 2;
+            std::vector<std::pair<size_t, double> > cases{ { 0, -DBL_MAX }, { 1, -DBL_MAX }, { nPositives + 2, -DBL_MAX },
+                                                           { nPositives, medianThreshold }, { 1, medianThreshold } };
+            for (size_t i = 0; i < cases.size(); ++i) {
+                size_t k = cases[i].first;
+                double threshold = cases[i].second;
+                std::vector<std::pair<double, std::string> > expected;
+                for (size_t s = 0; s < nPositives && expected.size() < k; ++s)
+                    if (sortedScores[s].first >= threshold)
+                        expected.push_back(sortedScores[s]);
+                for (bool useCascade : { false, true }) {
+                    std::string context = " (probe: " + std::to_string(probe) + ", case: " + std::to_string(i) +
+                                          ", cascade: " + std::to_string(useCascade) + ")";
+                    std::vector<std::pair<std::string, double> > candidates = ensemble.predictTopK(probes[probe], k, threshold, useCascade);
+                    ASSERT_LOG(candidates.size() == expected.size(), "Number of retrieved candidates should match expected count" + context);
+                    for (size_t c = 0; c < candidates.size(); ++c) {
+                        ASSERT_LOG(candidates[c].first == expected[c].second, "Candidate ID should match the sorted predictions" + context);
+                        ASSERT_LOG(doubleAlmostEquals(candidates[c].second, expected[c].first, 1e-9),
+                                   "Candidate score should match the sorted predictions" + context);
+                    }
+                }
+            }
+        }
+    }
+    catch (std::exception& ex)
+    {
+        logger << "Error: Valid ensemble top-k retrieval should not have generated an exception." << std::endl
+               << "Exception: [" << ex.what() << "]" << std::endl;
+        bfs::remove_all(testDir);
+        return passThroughDisplayTestStatus(__func__, -1);
+    }
+
+    bfs::remove_all(testDir);
+
+    #else/*TEST_ESVM_ENSEMBLE_TOP_K*/
+    return passThroughDisplayTestStatus(__func__, SKIPPED);
+    #endif/*TEST_ESVM_ENSEMBLE_TOP_K*/
+    return passThroughDisplayTestStatus(__func__, PASSED);
+}
+
+// Test enrollment and removal of positives in the ensemble: scores of other positives are left unchanged, positive IDs stay
+// aligned with their scores, duplicate enrollment is refused and removal of an unknown positive is reported
+int test_ESVM_EnsembleEnrollment(size_t nPositives, size_t nProbes)
+{
+    #if TEST_ESVM_ENSEMBLE_ENROLLMENT
+    logstream logger(LOGGER_FILE);
+    logger << "Running '" << __func__ << "' test..." << std::endl;
+
+    std::string testDir = "test_ensemble-enrollment/";
+    bfs::create_directory(testDir);
+
+    std::vector<esvmConfig> configs{ buildDummyEnsembleConfig(0), buildDummyEnsembleConfig(3) };
+    std::vector<cv::Mat> probes = generateDummyROIs(nProbes);
+    std::vector<cv::Mat> enrolledROIs = generateDummyROIs(2);
+    for (size_t c = 0; c < configs.size(); ++c) {
+        esvmEnsemble ensemble;
+        std::string enrolledID = "ID-ENROLLED";
+        try
+        {
+            ensemble = buildDummyEnsemble(testDir, nPositives, configs[c]);
+            std::vector<std::vector<double> > scores(nProbes);
+            for (size_t probe = 0; probe < nProbes; ++probe)
+                scores[probe] = ensemble.predict(probes[probe]);
+
+            // enrolled positive is appended, existing positives keep their ESVM and scores
+            ensemble.enroll(enrolledID, enrolledROIs);
+            ASSERT_LOG(ensemble.getPositiveCount() == nPositives + 1, "Enrolled positive should be added to the ensemble");
+            ASSERT_LOG(ensemble.getPositiveID((int)nPositives) == enrolledID, "Enrolled positive ID should be appended");
+            std::vector<std::vector<double> > enrolledScores(nProbes);
+            for (size_t probe = 0; probe < nProbes; ++probe) {
+                enrolledScores[probe] = ensemble.predict(probes[probe]);
+                ASSERT_LOG(enrolledScores[probe].size() == nPositives + 1, "Enrolled positive should obtain a score");
+                for (size_t pos = 0; pos < nPositives; ++pos)
+                    ASSERT_LOG(doubleAlmostEquals(enrolledScores[probe][pos], scores[probe][pos], 1e-9),
+                               "Existing positive scores should not change after enrollment (config: " + std::to_string(c) +
+                               ", probe: " + std::to_string(probe) + ", positive: " + std::to_string(pos) + ")");
+            }
+
+            // removed positive column is dropped, following positive IDs and scores are shifted accordingly
+            size_t removedIndex = 1;
+            ASSERT_LOG(!ensemble.remove("ID-UNKNOWN"), "Removal of a positive not enrolled should be reported");
+            ASSERT_LOG(ensemble.getPositiveCount() == nPositives + 1, "Removal of a positive not enrolled should not change the ensemble");
+            ASSERT_LOG(ensemble.remove("ID" + std::to_string(removedIndex)), "Removal of an enrolled positive should succeed");
+            ASSERT_LOG(ensemble.getPositiveCount() == nPositives, "Removed positive should be dropped from the ensemble");
+            for (size_t pos = 0; pos < nPositives; ++pos) {
+                size_t previousIndex = pos < removedIndex ? pos : pos + 1;
+                std::string expectedID = previousIndex < nPositives ? "ID" + std::to_string(previousIndex) : enrolledID;
+                ASSERT_LOG(ensemble.getPositiveID((int)pos) == expectedID, "Positive IDs should remain aligned after removal");
+            }
+            for (size_t probe = 0; probe < nProbes; ++probe) {
+                std::vector<double> removedScores = ensemble.predict(probes[probe]);
+                ASSERT_LOG(removedScores.size() == nPositives, "Removed positive should not obtain a score");
+                for (size_t pos = 0; pos < nPositives; ++pos)
+                    ASSERT_LOG(doubleAlmostEquals(removedScores[pos], enrolledScores[probe][pos < removedIndex ? pos : pos + 1], 1e-9),
+                               "Positive scores should remain aligned with their IDs after removal (config: " + std::to_string(c) +
+                               ", probe: " + std::to_string(probe) + ", positive: " + std::to_string(pos) + ")");
+            }
+        }
+        catch (std::exception& ex)
+        {
+            logger << "Error: Valid ensemble enrollment/removal should not have generated an exception." << std::endl
+                   << "Exception: [" << ex.what() << "]" << std::endl;
+            bfs::remove_all(testDir);
+            return passThroughDisplayTestStatus(__func__, -1);
+        }
+        try
+        {
+            ensemble.enroll(enrolledID, enrolledROIs);
+            logger << "Error: Enrollment of an already enrolled positive ID should have generated an exception." << std::endl;
+            bfs::remove_all(testDir);
+            return passThroughDisplayTestStatus(__func__, -2);
+        }
+        catch (...) {}
+        if (ensemble.getPositiveCount() != nPositives) {
+            logger << "Error: Refused enrollment should not change the ensemble." << std::endl;
+            bfs::remove_all(testDir);
+            return passThroughDisplayTestStatus(__func__, -3);
+        }
+    }
+
+    bfs::remove_all(testDir);
+
+    #else/*TEST_ESVM_ENSEMBLE_ENROLLMENT*/
+    return passThroughDisplayTestStatus(__func__, SKIPPED);
+    #endif/*TEST_ESVM_ENSEMBLE_ENROLLMENT*/
+    return passThroughDisplayTestStatus(__func__, PASSED);
+}
+
+// Test ensemble predictions from concurrent threads while positives are enrolled/removed: predictions must never fail nor observe
+// a partial update (scores of either the previous or the updated positives)
+int test_ESVM_EnsembleConcurrentUpdates(size_t nPositives, size_t nThreads, size_t nUpdates)
+{
+    #if TEST_ESVM_ENSEMBLE_CONCURRENT_UPDATES
+    logstream logger(LOGGER_FILE);
+    logger << "Running '" << __func__ << "' test..." << std::endl;
+
+    std::string testDir = "test_ensemble-concurrent-updates/";
+    bfs::create_directory(testDir);
+
+    std::vector<cv::Mat> probes = generateDummyROIs(nThreads);
+    std::vector<cv::Mat> enrolledROIs = generateDummyROIs(1);
+    std::atomic<bool> isUpdating(true);
+    std::atomic<size_t> nPredictions(0);
+    std::mutex errorMutex;
+    std::vector<std::string> errors;
+    auto addError = [&](const std::string& error) {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        errors.push_back(error);
+    };
+    try
+    {
+        esvmEnsemble ensemble = buildDummyEnsemble(testDir, nPositives, buildDummyEnsembleConfig());
+
+        // predicting threads alternate full and top-k predictions (cascaded or not) until all updates are completed
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < nThreads; ++t)
+            threads.push_back(std::thread([&, t]() {
+                try
+                {
+                    do {
+                        size_t nScores = ensemble.predict(probes[t]).size();
+                        size_t nCandidates = ensemble.predictTopK(probes[t], nPositives + 1, -DBL_MAX, t % 2 == 1).size();
+                        if (nScores != nPositives && nScores != nPositives + 1)
+                            addError("Invalid score count " + std::to_string(nScores) + " (thread: " + std::to_string(t) + ")");
+                        if (nCandidates != nPositives && nCandidates != nPositives + 1)
+                            addError("Invalid candidate count " + std::to_string(nCandidates) + " (thread: " + std::to_string(t) + ")");
+                        ++nPredictions;
+                    } while (isUpdating.load());
+                }
+                catch (std::exception& ex)
+                {
+                    addError("Prediction exception (thread: " + std::to_string(t) + ") [" + std::string(ex.what()) + "]");
+                }
+            }));
+
+        for (size_t u = 0; u < nUpdates; ++u) {
+            try
+            {
+                ensemble.enroll("ID-CONCURRENT", enrolledROIs);
+                if (!ensemble.remove("ID-CONCURRENT"))
+                    addError("Enrolled positive could not be removed (update: " + std::to_string(u) + ")");
+            }
+            catch (std::exception& ex)
+            {
+                addError("Update exception (update: " + std::to_string(u) + ") [" + std::string(ex.what()) + "]");
+            }
+        }
+        isUpdating = false;
+        for (size_t t = 0; t < threads.size(); ++t)
+            threads[t].join();
+        ASSERT_LOG(ensemble.getPositiveCount() == nPositives, "Ensemble should contain initial positives after all updates");
+    }
+    catch (std::exception& ex)
+    {
+        logger << "Error: Valid concurrent ensemble predictions and updates should not have generated an exception." << std::endl
+               << "Exception: [" << ex.what() << "]" << std::endl;
+        bfs::remove_all(testDir);
+        return passThroughDisplayTestStatus(__func__, -1);
+    }
+    logger << "Predictions completed during " << nUpdates << " enrollment/removal updates: " << nPredictions.load() << std::endl;
+    if (!errors.empty()) {
+        for (size_t e = 0; e < errors.size(); ++e)
+            logger << "Error: " << errors[e] << std::endl;
+        bfs::remove_all(testDir);
+        return passThroughDisplayTestStatus(__func__, -2);
+    }
+
+    bfs::remove_all(testDir);
+
+    #else/*TEST_ESVM_ENSEMBLE_CONCURRENT_UPDATES*/
+    return passThroughDisplayTestStatus(__func__, SKIPPED);
+    #endif/*TEST_ESVM_ENSEMBLE_CONCURRENT_UPDATES*/
+    return passThroughDisplayTestStatus(__func__, PASSED);
+}
+
+// Test equivalence of ensemble scoring with packed models (GEMV for a single frame, GEMM otherwise, random subspaces scattered
+// or folded) against scoring with the prediction of each ESVM, with or without random subspaces and for raw values or labels
+int test_ESVM_EnsemblePackedScoring(size_t nPositives, size_t nFrames)
+{
+    #if TEST_ESVM_ENSEMBLE_PACKED_SCORING
+    logstream logger(LOGGER_FILE);
+    logger << "Running '" << __func__ << "' test..." << std::endl;
+
+    std::string testDir = "test_ensemble-packed-scoring/";
+    bfs::create_directory(testDir);
+
+    std::vector<esvmConfig> configs{ buildDummyEnsembleConfig(0, 0), buildDummyEnsembleConfig(0, 1),
+                                     buildDummyEnsembleConfig(3, 0), buildDummyEnsembleConfig(3, 1) };
+    double tolerance = sizeof(esvmScalar) == sizeof(float) ? 1e-4 : 1e-9;
+    std::vector<cv::Mat> frames = generateDummyROIs(nFrames);
+    try
+    {
+        for (size_t c = 0; c < configs.size(); ++c) {
+            esvmEnsemble ensemble = buildDummyEnsemble(testDir, nPositives, configs[c]);
+            ASSERT_LOG(ensemble.getConfig().isFoldedRSM() == (configs[c].useRandomSubspaces() && configs[c].predictMode == 0),
+                       "Random subspaces should only be folded when predicting raw values (config: " + std::to_string(c) + ")");
+
+            // same models without packing are scored by the prediction of each ESVM
+            std::shared_ptr<const esvmEnsemble::Models> models = ensemble.getModels();
+            ASSERT_LOG(!models->packedWeights.empty(), "Trained ensemble models should be packed (config: " + std::to_string(c) + ")");
+            esvmEnsemble::Models unpackedModels(*models);
+            unpackedModels.packedWeights.release();
+            unpackedModels.packedBias.release();
+            unpackedModels.packedBound.release();
+
+            std::vector<std::vector<FeatureVector> > probeSamples(nFrames);
+            for (size_t f = 0; f < nFrames; ++f)
+                probeSamples[f] = ensemble.computeFeatures(frames[f]);
+            std::vector<std::vector<double> > scoresGEMM = ensemble.scoreFeatures(*models, probeSamples);
+            std::vector<std::vector<double> > scoresESVM = ensemble.scoreFeatures(unpackedModels, probeSamples);
+            ASSERT_LOG(scoresGEMM.size() == nFrames && scoresESVM.size() == nFrames, "Scores should be provided for each frame");
+            for (size_t f = 0; f < nFrames; ++f) {
+                std::vector<double> scoresGEMV = ensemble.scoreFeatures(*models, { probeSamples[f] })[0];
+                ASSERT_LOG(scoresGEMV.size() == nPositives && scoresGEMM[f].size() == nPositives && scoresESVM[f].size() == nPositives,
+                           "Scores should be provided for each positive");
+                for (size_t pos = 0; pos < nPositives; ++pos) {
+                    std::string context = " (config: " + std::to_string(c) + ", frame: " + std::to_string(f) +
+                                          ", positive: " + std::to_string(pos) + ")";
+                    ASSERT_LOG(doubleAlmostEquals(scoresGEMM[f][pos], scoresESVM[f][pos], tolerance),
+                               "Packed models score of multiple frames should match the per-ESVM score" + context);
+                    ASSERT_LOG(doubleAlmostEquals(scoresGEMV[pos], scoresESVM[f][pos], tolerance),
+                               "Packed models score of a single frame should match the per-ESVM score" + context);
+                }
+            }
+        }
+    }
+    catch (std::exception& ex)
+    {
+        logger << "Error: Valid packed and per-ESVM ensemble scoring should not have generated an exception." << std::endl
+               << "Exception: [" << ex.what() << "]" << std::endl;
+        bfs::remove_all(testDir);
+        return passThroughDisplayTestStatus(__func__, -1);
+    }
+
+    bfs::remove_all(testDir);
+
+    #else/*TEST_ESVM_ENSEMBLE_PACKED_SCORING*/
+    return passThroughDisplayTestStatus(__func__, SKIPPED);
+    #endif/*TEST_ESVM_ENSEMBLE_PACKED_SCORING*/
+    return passThroughDisplayTestStatus(__func__, PASSED);
+}
+
+// Test track predictions of the ensemble (frames scored as a batch) against predictions of each frame with every fusion method
+int test_ESVM_EnsembleTrackPredict(size_t nPositives, size_t nFrames)
+{
+    #if TEST_ESVM_ENSEMBLE_TRACK_PREDICT
+    logstream logger(LOGGER_FILE);
+    logger << "Running '" << __func__ << "' test..." << std::endl;
+
+    std::string testDir = "test_ensemble-track-predict/";
+    bfs::create_directory(testDir);
+
+    double tolerance = sizeof(esvmScalar) == sizeof(float) ? 1e-4 : 1e-9;
+    std::vector<cv::Mat> frames = generateDummyROIs(nFrames);
+    esvmEnsemble ensemble;
+    try
+    {
+        ensemble = buildDummyEnsemble(testDir, nPositives, buildDummyEnsembleConfig());
+        std::vector<std::vector<double> > scores(nFrames);
+        for (size_t f = 0; f < nFrames; ++f)
+            scores[f] = ensemble.predict(frames[f]);
+
+        for (TrackFusion fusion : { TRACK_FUSION_MEAN, TRACK_FUSION_MAX, TRACK_FUSION_ACCUMULATE }) {
+            std::vector<std::vector<double> > frameScores;
+            std::vector<double> trackScores = ensemble.predictTrack(frames, fusion, &frameScores);
+            ASSERT_LOG(trackScores.size() == nPositives && frameScores.size() == nFrames,
+                       "Track prediction should provide a score for each positive and scores of each frame");
+            for (size_t pos = 0; pos < nPositives; ++pos) {
+                std::string context = " (fusion: " + std::to_string(fusion) + ", positive: " + std::to_string(pos) + ")";
+                double expectedScore = fusion == TRACK_FUSION_MAX ? -DBL_MAX : 0.0;
+                for (size_t f = 0; f < nFrames; ++f) {
+                    ASSERT_LOG(frameScores[f].size() == nPositives && doubleAlmostEquals(frameScores[f][pos], scores[f][pos], tolerance),
+                               "Track frame score should match the frame prediction (frame: " + std::to_string(f) + ")" + context);
+                    expectedScore = fusion == TRACK_FUSION_MAX ? std::max(expectedScore, scores[f][pos]) : expectedScore + scores[f][pos];
+                }
+                if (fusion == TRACK_FUSION_MEAN)
+                    expectedScore /= (double)nFrames;
+                ASSERT_LOG(doubleAlmostEquals(trackScores[pos], expectedScore, tolerance * nFrames),
+                           "Track score should match the fusion of frame predictions" + context);
+            }
+        }
+
+        // single frame track is the frame prediction for any fusion method
+        std::vector<double> singleFrameScores = ensemble.predictTrack({ frames[0] }, TRACK_FUSION_MAX);
+        for (size_t pos = 0; pos < nPositives; ++pos)
+            ASSERT_LOG(doubleAlmostEquals(singleFrameScores[pos], scores[0][pos], tolerance),
+                       "Single frame track score should match the frame prediction (positive: " + std::to_string(pos) + ")");
+    }
+    catch (std::exception& ex)
+    {
+        logger << "Error: Valid ensemble track prediction should not have generated an exception." << std::endl
+               << "Exception: [" << ex.what() << "]" << std::endl;
+        bfs::remove_all(testDir);
+        return passThroughDisplayTestStatus(__func__, -1);
+    }
+    try
+    {
+        ensemble.predictTrack({});
+        logger << "Error: Track prediction without frame should have generated an exception." << std::endl;
+        bfs::remove_all(testDir);
+        return passThroughDisplayTestStatus(__func__, -2);
+    }
+    catch (...) {}
+
+    bfs::remove_all(testDir);
+
+    #else/*TEST_ESVM_ENSEMBLE_TRACK_PREDICT*/
+    return passThroughDisplayTestStatus(__func__, SKIPPED);
+    #endif/*TEST_ESVM_ENSEMBLE_TRACK_PREDICT*/
+    return passThroughDisplayTestStatus(__func__, PASSED);
+}
+
+// Test ensemble prediction pipeline end-to-end: scores of submitted ROIs against direct predictions, delivery in submission
+// order with a single worker per stage, delivery of processing errors, draining of pending ROIs on stop and refused submissions
+int test_ESVM_EnsemblePipeline(size_t nPositives, size_t nROIs)
+{
+    #if TEST_ESVM_ENSEMBLE_PIPELINE
+    logstream logger(LOGGER_FILE);
+    logger << "Running '" << __func__ << "' test..." << std::endl;
+
+    std::string testDir = "test_ensemble-pipeline/";
+    bfs::create_directory(testDir);
+
+    double tolerance = sizeof(esvmScalar) == sizeof(float) ? 1e-4 : 1e-9;
+    std::vector<cv::Mat> rois = generateDummyROIs(nROIs);
+    try
+    {
+        esvmEnsemble ensemble = buildDummyEnsemble(testDir, nPositives, buildDummyEnsembleConfig());
+        std::vector<std::vector<double> > scores(nROIs);
+        for (size_t r = 0; r < nROIs; ++r)
+            scores[r] = ensemble.predict(rois[r]);
+
+        // results obtained from futures (probes possibly scored in batches) match direct predictions
+        {
+            esvmPipeline pipeline(ensemble, 1, 2, 1);
+            std::vector<std::future<std::vector<double> > > results;
+            for (size_t r = 0; r < nROIs; ++r)
+                results.push_back(pipeline.submit(rois[r], (int)(r % 2)));
+            for (size_t r = 0; r < nROIs; ++r) {
+                std::vector<double> pipelineScores = results[r].get();
+                ASSERT_LOG(pipelineScores.size() == nPositives, "Pipeline should provide a score for each positive");
+                for (size_t pos = 0; pos < nPositives; ++pos)
+                    ASSERT_LOG(doubleAlmostEquals(pipelineScores[pos], scores[r][pos], tolerance),
+                               "Pipeline score should match the ensemble prediction (ROI: " + std::to_string(r) +
+                               ", positive: " + std::to_string(pos) + ")");
+            }
+
+            // processing errors are delivered by the future of the failing ROI only
+            std::future<std::vector<double> > failedResult = pipeline.submit(cv::Mat());
+            std::future<std::vector<double> > validResult = pipeline.submit(rois[0]);
+            bool isErrorDelivered = false;
+            try { failedResult.get(); }
+            catch (...) { isErrorDelivered = true; }
+            ASSERT_LOG(isErrorDelivered, "Pipeline should deliver the processing error of an empty ROI to its future");
+            ASSERT_LOG(validResult.get().size() == nPositives, "Pipeline processing error should not affect following ROIs");
+        }
+
+        // callbacks with a single worker per stage are delivered in submission order, with their stream and errors, and all
+        // pending ROIs are delivered once stopped
+        std::mutex deliveryMutex;
+        std::vector<size_t> deliveredOrder;
+        std::vector<bool> isValidDelivery;
+        esvmPipeline pipeline(ensemble, 1, 1, 1);
+        for (size_t r = 0; r <= nROIs; ++r) {
+            bool isFailing = r == nROIs / 2;
+            cv::Mat roi = isFailing ? cv::Mat() : rois[r % nROIs];
+            pipeline.submit(roi, (int)r, [&, r, isFailing](int streamID, const std::vector<double>& scores, std::exception_ptr error) {
+                std::lock_guard<std::mutex> lock(deliveryMutex);
+                deliveredOrder.push_back(r);
+                isValidDelivery.push_back(streamID == (int)r && (isFailing ? error && scores.empty()
+                                                                           : !error && scores.size() == nPositives));
+            });
+        }
+        pipeline.stop();
+        ASSERT_LOG(pipeline.getPendingCount() == 0, "Stopped pipeline should not have pending ROIs");
+        std::lock_guard<std::mutex> lock(deliveryMutex);
+        ASSERT_LOG(deliveredOrder.size() == nROIs + 1, "Stopped pipeline should have delivered all submitted ROIs");
+        for (size_t r = 0; r <= nROIs; ++r) {
+            ASSERT_LOG(deliveredOrder[r] == r, "Pipeline results should be delivered in submission order (ROI: " + std::to_string(r) + ")");
+            ASSERT_LOG(isValidDelivery[r], "Pipeline results should be delivered with their stream and scores or error (ROI: " +
+                       std::to_string(r) + ")");
+        }
+
+        bool isRefused = false;
+        try { pipeline.submit(rois[0]); }
+        catch (...) { isRefused = true; }
+        ASSERT_LOG(isRefused, "Stopped pipeline should refuse new ROIs");
+    }
+    catch (std::exception& ex)
+    {
+        logger << "Error: Valid ensemble pipeline processing should not have generated an exception." << std::endl
+               << "Exception: [" << ex.what() << "]" << std::endl;
+        bfs::remove_all(testDir);
+        return passThroughDisplayTestStatus(__func__, -1);
+    }
+
+    bfs::remove_all(testDir);
+
+    #else/*TEST_ESVM_ENSEMBLE_PIPELINE*/
+    return passThroughDisplayTestStatus(__func__, SKIPPED);
+    #endif/*TEST_ESVM_ENSEMBLE_PIPELINE*/
+    return passThroughDisplayTestStatus(__func__, PASSED);
+}
+
 /* ===============
     PROCEDURES
 =============== */
@@ -48,6 +48,26 @@ int main(int argc, char* argv[])
         RETURN_ERROR(test_ESVM_ModelFromStructSVM());
         RETURN_ERROR(test_ESVM_ModelMemoryOperations());
         RETURN_ERROR(test_ESVM_ModelMemoryParamCheck());
+        RETURN_ERROR(test_ESVM_CompiledModelPredict());
+        RETURN_ERROR(test_ESVM_PredictBatch(2000));
+        RETURN_ERROR(test_ESVM_PrecomputedKernelTraining());
+        RETURN_ERROR(test_ESVM_SharedFeatureNodesTraining());
+        RETURN_ERROR(test_ESVM_ReadSampleFile_mapped(1000, 128));
+        RETURN_ERROR(test_ESVM_Float32Precision(2000, 128));
+        RETURN_ERROR(test_ESVM_DotProductKernels());
+        RETURN_ERROR(test_ESVM_PipelineQueue(4, 4, 10000));
+        RETURN_ERROR(test_ESVM_RuntimeConfig());
+        RETURN_ERROR(test_ESVM_SolverBenchmark(10, 20000, 128));
+        RETURN_ERROR(test_ESVM_WarmStartTraining(2000, 128));
+        RETURN_ERROR(test_ESVM_HardNegativeMining(5000, 128));
+        RETURN_ERROR(test_ESVM_EnsembleArchive(4, 5));
+        RETURN_ERROR(test_ESVM_EnsembleCascade(8, 5));
+        RETURN_ERROR(test_ESVM_EnsembleTopK(8, 5));
+        RETURN_ERROR(test_ESVM_EnsembleEnrollment(4, 3));
+        RETURN_ERROR(test_ESVM_EnsembleConcurrentUpdates(4, 4, 5));
+        RETURN_ERROR(test_ESVM_EnsemblePackedScoring(4, 3));
+        RETURN_ERROR(test_ESVM_EnsembleTrackPredict(4, 5));
+        RETURN_ERROR(test_ESVM_EnsemblePipeline(4, 8));
 
         /* ----------------
           procedure tests